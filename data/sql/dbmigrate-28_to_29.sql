@@ -0,0 +1,55 @@
+-- Script to migate from db version 28 to 29.
+-- Added aggregated playback statistics, maintained by DatabaseCommand_LogPlayback
+
+CREATE INDEX playback_log_playtime ON playback_log(playtime);
+CREATE INDEX playback_log_source_playtime ON playback_log(source, playtime);
+
+CREATE TABLE IF NOT EXISTS playback_stats_track (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0,
+    secs_played INTEGER NOT NULL DEFAULT 0,
+    last_played INTEGER NOT NULL
+);
+CREATE INDEX playback_stats_track_source ON playback_stats_track(source, track);
+CREATE INDEX playback_stats_track_plays ON playback_stats_track(plays);
+
+CREATE TABLE IF NOT EXISTS playback_stats_artist (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0,
+    secs_played INTEGER NOT NULL DEFAULT 0,
+    last_played INTEGER NOT NULL
+);
+CREATE INDEX playback_stats_artist_source ON playback_stats_artist(source, artist);
+CREATE INDEX playback_stats_artist_plays ON playback_stats_artist(plays);
+
+CREATE TABLE IF NOT EXISTS playback_stats_day (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    day INTEGER NOT NULL,
+    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0
+);
+CREATE INDEX playback_stats_day_source ON playback_stats_day(source, day, track);
+CREATE INDEX playback_stats_day_day ON playback_stats_day(day);
+
+INSERT INTO playback_stats_track(source, track, artist, plays, secs_played, last_played)
+    SELECT playback_log.source, playback_log.track, track.artist, count(*), sum(secs_played), max(playtime)
+    FROM playback_log, track
+    WHERE track.id = playback_log.track
+    GROUP BY playback_log.source, playback_log.track;
+
+INSERT INTO playback_stats_artist(source, artist, plays, secs_played, last_played)
+    SELECT source, artist, sum(plays), sum(secs_played), max(last_played)
+    FROM playback_stats_track
+    GROUP BY source, artist;
+
+INSERT INTO playback_stats_day(source, day, track, artist, plays)
+    SELECT playback_log.source, playback_log.playtime / 86400, playback_log.track, track.artist, count(*)
+    FROM playback_log, track
+    WHERE track.id = playback_log.track
+    GROUP BY playback_log.source, playback_log.playtime / 86400, playback_log.track;
+
+UPDATE settings SET v = '29' WHERE k == 'schema_version';
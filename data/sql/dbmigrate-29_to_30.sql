@@ -0,0 +1,7 @@
+-- Script to migate from db version 29 to 30.
+-- Remember which of our ops each peer has fetched, so the oplog can be compacted
+-- up to the oldest op a known peer still needs.
+
+ALTER TABLE source ADD COLUMN peerlastop TEXT NOT NULL DEFAULT "";
+
+UPDATE settings SET v = '30' WHERE k == 'schema_version';
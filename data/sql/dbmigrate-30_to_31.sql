@@ -0,0 +1,7 @@
+-- Script to migate from db version 30 to 31.
+-- Look up files by content hash, so identical files on several peers can be
+-- streamed from all of them at once.
+
+CREATE INDEX IF NOT EXISTS file_md5 ON file(md5);
+
+UPDATE settings SET v = '31' WHERE k == 'schema_version';
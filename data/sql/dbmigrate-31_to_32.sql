@@ -0,0 +1,12 @@
+-- Script to migate from db version 31 to 32.
+-- Trigram index over artist, album and track names for the collection filters.
+-- DatabaseImpl fills it from the existing names after running this script.
+
+CREATE TABLE IF NOT EXISTS name_trigram (
+    trigram TEXT NOT NULL,
+    kind INTEGER NOT NULL,
+    id INTEGER NOT NULL
+);
+CREATE UNIQUE INDEX IF NOT EXISTS name_trigram_uniq ON name_trigram(trigram,kind,id);
+
+UPDATE settings SET v = '32' WHERE k == 'schema_version';
@@ -0,0 +1,8 @@
+-- Script to migate from db version 32 to 33.
+-- Remember when we last heard from each peer, so peers that went away for good
+-- no longer hold back oplog compaction. Existing peers count as seen now.
+
+ALTER TABLE source ADD COLUMN lastseen INTEGER NOT NULL DEFAULT 0;
+UPDATE source SET lastseen = strftime('%s','now');
+
+UPDATE settings SET v = '33' WHERE k == 'schema_version';
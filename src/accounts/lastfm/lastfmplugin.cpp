@@ -29,6 +29,7 @@
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 #include "accounts/lastfm/LastFmAccount.h"
+#include "infosystem/networkscheduler.h"
 
 #include <lastfm/ws.h>
 #include <lastfm/XmlQuery>
@@ -460,7 +461,7 @@ LastFmPlugin::notInCacheSlot( QHash<QString, QString> criteria, Tomahawk::InfoSy
             imgurl.addQueryItem( "api_key", "7a90f6672a04b809ee309af169f34b8b" );
 
             QNetworkRequest req( imgurl );
-            QNetworkReply* reply = TomahawkUtils::nam()->get( req );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( req, requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
             connect( reply, SIGNAL( finished() ), SLOT( coverArtReturned() ) );
@@ -479,7 +480,7 @@ LastFmPlugin::notInCacheSlot( QHash<QString, QString> criteria, Tomahawk::InfoSy
             imgurl.addQueryItem( "api_key", "7a90f6672a04b809ee309af169f34b8b" );
 
             QNetworkRequest req( imgurl );
-            QNetworkReply* reply = TomahawkUtils::nam()->get( req );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( req, requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
             connect( reply, SIGNAL( finished() ), SLOT( artistImagesReturned() ) );
@@ -643,7 +644,7 @@ LastFmPlugin::coverArtReturned()
         }
         // Follow HTTP redirect
         QNetworkRequest req( redir );
-        QNetworkReply* newReply = TomahawkUtils::nam()->get( req );
+        QNetworkReply* newReply = NetworkScheduler::instance()->get( req, reply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
         newReply->setProperty( "requestData", reply->property( "requestData" ) );
         connect( newReply, SIGNAL( finished() ), SLOT( coverArtReturned() ) );
     }
@@ -694,7 +695,7 @@ LastFmPlugin::artistImagesReturned()
         }
         // Follow HTTP redirect
         QNetworkRequest req( redir );
-        QNetworkReply* newReply = TomahawkUtils::nam()->get( req );
+        QNetworkReply* newReply = NetworkScheduler::instance()->get( req, reply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
         newReply->setProperty( "requestData", reply->property( "requestData" ) );
         connect( newReply, SIGNAL( finished() ), SLOT( artistImagesReturned() ) );
     }
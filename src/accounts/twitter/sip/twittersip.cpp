@@ -36,6 +36,7 @@
 #include <tomahawksettings.h>
 #include <database/database.h>
 #include <network/servent.h>
+#include <network/connectscheduler.h>
 
 #include "utils/logger.h"
 #include "accounts/twitter/tomahawkoauthtwitter.h"
@@ -619,11 +620,11 @@ TwitterSipPlugin::makeConnection( const QString &screenName, const QVariantHash
 
     QString friendlyName = QString( '@' + screenName );
     if ( !Servent::instance()->connectedToSession( peerData["node"].toString() ) )
-        Servent::instance()->connectToPeer( peerData["host"].toString(),
-                                            peerData["port"].toString().toInt(),
-                                            peerData["pkey"].toString(),
-                                            friendlyName,
-                                            peerData["node"].toString() );
+        ConnectScheduler::instance()->connectToPeer( peerData["host"].toString(),
+                                                     peerData["port"].toString().toInt(),
+                                                     peerData["pkey"].toString(),
+                                                     friendlyName,
+                                                     peerData["node"].toString() );
 }
 
 void
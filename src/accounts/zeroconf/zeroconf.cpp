@@ -23,6 +23,7 @@
 
 #include <QtCore/QTimer>
 
+#include "network/connectscheduler.h"
 #include "tomahawksettings.h"
 #include "utils/logger.h"
 #include "zeroconfaccount.h"
@@ -83,7 +84,7 @@ ZeroconfPlugin::connectPlugin()
     foreach( const QStringList& nodeSet, m_cachedNodes )
     {
         if ( !Servent::instance()->connectedToSession( nodeSet[3] ) )
-            Servent::instance()->connectToPeer( nodeSet[0], nodeSet[1].toInt(), "whitelist", nodeSet[2], nodeSet[3] );
+            ConnectScheduler::instance()->connectToPeer( nodeSet[0], nodeSet[1].toInt(), "whitelist", nodeSet[2], nodeSet[3] );
     }
     m_cachedNodes.clear();
 
@@ -135,7 +136,7 @@ ZeroconfPlugin::lanHostFound( const QString& host, int port, const QString& name
     }
 
     if ( !Servent::instance()->connectedToSession( nodeid ) )
-        Servent::instance()->connectToPeer( host, port, "whitelist", name, nodeid );
+        ConnectScheduler::instance()->connectToPeer( host, port, "whitelist", name, nodeid );
     else
         qDebug() << "Already connected to" << host;
 }
@@ -0,0 +1,1092 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "benchmark.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+#include <qjson/parser.h>
+#include <qjson/serializer.h>
+
+#include "config.h"
+#include "album.h"
+#include "artist.h"
+#include "pipeline.h"
+#include "query.h"
+#include "result.h"
+#include "source.h"
+#include "sourcelist.h"
+#include "database/database.h"
+#include "database/databasecommand_addfiles.h"
+#include "database/databasecommand_loadops.h"
+#include "database/databasecommand_resolve.h"
+#include "database/databasecommand_updatesearchindex.h"
+#include "database/databaseresolver.h"
+#include "database/localcollection.h"
+#include "network/controlconnection.h"
+#include "network/servent.h"
+#include "utils/metrics.h"
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+
+#ifndef ENABLE_HEADLESS
+    #include "playlist/playlistmodel.h"
+    #include "playlist/trackproxymodel.h"
+#endif
+
+#include "loopbackconnection.h"
+
+using namespace Tomahawk;
+
+#define BENCHMARK_SEED 4711
+// factory calls per thread and query in the intern scenario
+#define INTERN_LOOKUPS_PER_QUERY 100
+// ids the intern scenario uses start here, well clear of anything imported
+#define INTERN_ID_BASE 0x40000000
+// synthetic peers, offers and sources the registry scenario registers
+#define REGISTRY_PEERS 1000
+// passes over all of them when timing lookups, a single one is over too quickly to measure
+#define REGISTRY_LOOKUP_ROUNDS 100
+
+static const char* s_words[] =
+{
+    "black", "white", "red", "blue", "silver", "golden", "broken", "electric",
+    "midnight", "summer", "winter", "river", "city", "ocean", "desert", "forest",
+    "heart", "dream", "fire", "rain", "star", "shadow", "light", "storm",
+    "love", "song", "night", "morning", "road", "home", "ghost", "machine",
+    "dance", "fever", "echo", "paradise", "thunder", "velvet", "crystal", "wild",
+    "lonely", "happy", "lost", "young", "secret", "empty", "little", "last",
+    "angel", "devil", "king", "queen", "child", "stranger", "lover", "soldier",
+    "moon", "sun", "sky", "sea", "stone", "glass", "wire", "garden"
+};
+
+
+SignalWaiter::SignalWaiter( QObject* sender, const char* signal )
+    : QObject()
+    , m_fired( false )
+{
+    m_timer.setSingleShot( true );
+    connect( &m_timer, SIGNAL( timeout() ), &m_loop, SLOT( quit() ) );
+    connect( sender, signal, SLOT( onSignal() ) );
+}
+
+
+bool
+SignalWaiter::wait( int timeout )
+{
+    if ( m_fired )
+        return true;
+
+    m_timer.start( timeout );
+    m_loop.exec();
+    m_timer.stop();
+
+    return m_fired;
+}
+
+
+void
+SignalWaiter::onSignal()
+{
+    m_fired = true;
+    m_loop.quit();
+}
+
+
+/**
+ * Calls the Artist, Album and Result factories in a tight loop, the way a database worker does
+ * while it turns rows into objects. Keeps the last few objects alive, so lookups both hit and miss.
+ */
+class InternWorker : public QThread
+{
+public:
+    InternWorker( int seed, int lookups, int keys )
+        : m_seed( seed )
+        , m_lookups( lookups )
+        , m_keys( keys )
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        qsrand( m_seed );
+
+        QList< artist_ptr > artists;
+        QList< album_ptr > albums;
+        QList< result_ptr > results;
+        for ( int i = 0; i < m_lookups; i++ )
+        {
+            const unsigned int key = qrand() % m_keys;
+            const unsigned int id = INTERN_ID_BASE + key;
+
+            artist_ptr artist = Artist::get( id, QString( "Intern Artist %1" ).arg( key ) );
+            albums << Album::get( id, QString( "Intern Album %1" ).arg( key ), artist );
+            results << Result::get( QString( "bench://intern/%1" ).arg( key ) );
+            artists << artist;
+
+            if ( artists.count() > 64 )
+            {
+                artists.removeFirst();
+                albums.removeFirst();
+                results.removeFirst();
+            }
+
+            // there's no event loop here to run the deleteLater()s of the objects we let go of
+            if ( i % 1000 == 999 )
+                QCoreApplication::sendPostedEvents( 0, QEvent::DeferredDelete );
+        }
+
+        artists.clear();
+        albums.clear();
+        results.clear();
+        QCoreApplication::sendPostedEvents( 0, QEvent::DeferredDelete );
+    }
+
+private:
+    int m_seed;
+    int m_lookups;
+    int m_keys;
+};
+
+
+Benchmark::Options::Options()
+    : artists( 200 )
+    , albumsPerArtist( 5 )
+    , tracksPerAlbum( 10 )
+    , peers( 2 )
+    , queries( 1000 )
+    , transferBytes( 64 * 1024 * 1024 )
+    , connections( 32 )
+    , scenarios( Benchmark::availableScenarios() )
+{
+}
+
+
+Benchmark::Benchmark( const Options& options, QObject* parent )
+    : QObject( parent )
+    , m_options( options )
+    , m_searchHits( 0 )
+    , m_resolveSolved( 0 )
+    , m_peersPending( 0 )
+{
+}
+
+
+Benchmark::~Benchmark()
+{
+    if ( Servent::instance() )
+    {
+        Servent::instance()->stop();
+        delete Servent::instance();
+    }
+}
+
+
+QStringList
+Benchmark::availableScenarios()
+{
+    QStringList scenarios;
+    scenarios << "import" << "index" << "resolve" << "oplog" << "transfer" << "peers" << "intern" << "registry";
+#ifndef ENABLE_HEADLESS
+    scenarios << "proxymodel";
+#endif
+
+    return scenarios;
+}
+
+
+int
+Benchmark::run()
+{
+    if ( !setupEnvironment() )
+    {
+        tLog() << "Failed to set up the benchmark environment";
+        return 1;
+    }
+
+    QVariantMap parameters;
+    parameters[ "artists" ] = m_options.artists;
+    parameters[ "albumsPerArtist" ] = m_options.albumsPerArtist;
+    parameters[ "tracksPerAlbum" ] = m_options.tracksPerAlbum;
+    parameters[ "peers" ] = m_options.peers;
+    parameters[ "queries" ] = m_options.queries;
+    parameters[ "transferBytes" ] = m_options.transferBytes;
+    parameters[ "connections" ] = m_options.connections;
+    parameters[ "seed" ] = BENCHMARK_SEED;
+
+    QVariantMap results;
+    results[ "version" ] = TOMAHAWK_VERSION;
+    results[ "qt" ] = qVersion();
+    results[ "date" ] = QDateTime::currentDateTime().toString( Qt::ISODate );
+    results[ "parameters" ] = parameters;
+
+    // importing and indexing are what everything else works on, so they always run
+    QStringList scenarios = m_options.scenarios;
+    scenarios.removeAll( "import" );
+    scenarios.removeAll( "index" );
+    scenarios.prepend( "index" );
+    scenarios.prepend( "import" );
+
+    QVariantMap scenarioResults;
+    bool ok = true;
+    foreach ( const QString& scenario, scenarios )
+    {
+        tLog() << "Running benchmark scenario:" << scenario;
+        Metrics::instance()->reset();
+
+        QVariantMap r;
+        if ( scenario == "import" )
+            r = runImport();
+        else if ( scenario == "index" )
+            r = runIndex();
+        else if ( scenario == "resolve" )
+            r = runResolve();
+        else if ( scenario == "oplog" )
+            r = runOplog();
+        else if ( scenario == "transfer" )
+            r = runTransfer();
+        else if ( scenario == "peers" )
+            r = runPeers();
+        else if ( scenario == "intern" )
+            r = runIntern();
+        else if ( scenario == "registry" )
+            r = runRegistry();
+#ifndef ENABLE_HEADLESS
+        else if ( scenario == "proxymodel" )
+            r = runProxyModel();
+#endif
+        else
+        {
+            tLog() << "Unknown scenario:" << scenario;
+            continue;
+        }
+
+        if ( r.isEmpty() )
+        {
+            tLog() << "Scenario failed:" << scenario;
+            r[ "failed" ] = true;
+            ok = false;
+        }
+
+        // what the instrumented code paths recorded while this scenario ran
+        r[ "metrics" ] = Metrics::instance()->snapshot().value( "histograms" );
+        scenarioResults[ scenario ] = r;
+    }
+    results[ "scenarios" ] = scenarioResults;
+
+    if ( !writeResults( results ) )
+        ok = false;
+
+    return ok ? 0 : 1;
+}
+
+
+bool
+Benchmark::setupEnvironment()
+{
+    // the search index lives next to the database and would otherwise carry over from the last run
+    const QString dbPath = TomahawkUtils::appDataDir().absoluteFilePath( "tomahawk-bench.db" );
+    QFile::remove( dbPath );
+    TomahawkUtils::removeDirectory( TomahawkUtils::appDataDir().absoluteFilePath( "tomahawk.lucene" ) );
+
+    // connections hand these over between the network threads and ours
+    qRegisterMetaType< msg_ptr >("msg_ptr");
+    qRegisterMetaType< Connection* >("Connection*");
+    qRegisterMetaType< StreamConnection* >("StreamConnection*");
+    qRegisterMetaType< QAbstractSocket::SocketError >("QAbstractSocket::SocketError");
+    qRegisterMetaType< QHostAddress >("QHostAddress");
+    qRegisterMetaType< Tomahawk::source_ptr >("Tomahawk::source_ptr");
+    qRegisterMetaType< QSharedPointer<DatabaseCommand> >("QSharedPointer<DatabaseCommand>");
+    qRegisterMetaType< QList< QSharedPointer<DatabaseCommand> > >("QList<QSharedPointer<DatabaseCommand> >");
+
+    new Pipeline( this );
+    new Servent();
+
+    Database* db = new Database( dbPath, this );
+    {
+        SignalWaiter waiter( db, SIGNAL( indexReady() ) );
+        Pipeline::instance()->databaseReady();
+        if ( !db->indexReady() && !waiter.wait() )
+            return false;
+    }
+    Pipeline::instance()->addResolver( new DatabaseResolver( 100 ) );
+    Pipeline::instance()->start();
+
+    m_local = source_ptr( new Source( 0, "My Collection" ) );
+    m_local->addCollection( collection_ptr( new LocalCollection( m_local ) ) );
+    {
+        SignalWaiter waiter( SourceList::instance(), SIGNAL( ready() ) );
+        SourceList::instance()->setLocal( m_local );
+        SourceList::instance()->loadSources();
+        if ( !waiter.wait() )
+            return false;
+    }
+
+    // fake peers, as if they had connected and we had synced their collection
+    for ( int i = 0; i < m_options.peers; i++ )
+    {
+        source_ptr peer = SourceList::instance()->get( QString( "bench-peer-%1" ).arg( i ), QString( "Peer %1" ).arg( i ) );
+
+        SignalWaiter waiter( peer.data(), SIGNAL( syncedWithDatabase() ) );
+        QMetaObject::invokeMethod( peer.data(), "setOnline", Qt::QueuedConnection );
+        if ( !waiter.wait() )
+            return false;
+
+        m_peers << peer;
+    }
+
+    return true;
+}
+
+
+QVariantMap
+Benchmark::runImport()
+{
+    QVariantMap r;
+
+    const QVariantList files = syntheticFiles( BENCHMARK_SEED, "file:///bench/local" );
+
+    QTime t;
+    t.start();
+    if ( !importFiles( files, m_local ) )
+        return QVariantMap();
+
+    r[ "files" ] = files.count();
+    r[ "ms" ] = t.elapsed();
+    r[ "filesPerSecond" ] = files.count() * 1000.0 / qMax( 1, t.elapsed() );
+
+    // every peer shares a quarter of our tracks and has its own on top of that
+    QVariantList peerTimings;
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        QVariantList peerFiles = syntheticFiles( BENCHMARK_SEED + i + 1, QString( "file:///bench/peer%1" ).arg( i ) );
+        for ( int j = 0; j < files.count(); j += 4 )
+            peerFiles << files.at( j );
+
+        t.start();
+        if ( !importFiles( peerFiles, m_peers.at( i ) ) )
+            return QVariantMap();
+
+        QVariantMap p;
+        p[ "files" ] = peerFiles.count();
+        p[ "ms" ] = t.elapsed();
+        peerTimings << p;
+    }
+    r[ "peers" ] = peerTimings;
+
+    return r;
+}
+
+
+QVariantMap
+Benchmark::runIndex()
+{
+    QVariantMap r;
+
+    QTime t;
+    t.start();
+    if ( !execute( new DatabaseCommand_UpdateSearchIndex() ) )
+        return QVariantMap();
+    r[ "buildMs" ] = t.elapsed();
+
+    // full-text searches, the way the search box queries the collection
+    qsrand( BENCHMARK_SEED );
+    QList< int > timings;
+    m_searchHits = 0;
+    for ( int i = 0; i < m_options.queries; i++ )
+    {
+        query_ptr q = Query::get( randomWords( 1 + i % 2 ), QString() );
+        DatabaseCommand_Resolve* cmd = new DatabaseCommand_Resolve( q );
+        connect( cmd, SIGNAL( results( Tomahawk::QID, QList<Tomahawk::result_ptr> ) ),
+                        SLOT( onSearchResults( Tomahawk::QID, QList<Tomahawk::result_ptr> ) ), Qt::DirectConnection );
+
+        t.start();
+        if ( !execute( cmd ) )
+            return QVariantMap();
+        timings << t.elapsed();
+    }
+    r[ "search" ] = latencies( timings );
+    r[ "searchesWithResults" ] = m_searchHits;
+
+    return r;
+}
+
+
+void
+Benchmark::onSearchResults( const Tomahawk::QID& qid, const QList< Tomahawk::result_ptr >& results )
+{
+    Q_UNUSED( qid );
+
+    if ( !results.isEmpty() )
+        m_searchHits++;
+}
+
+
+QVariantMap
+Benchmark::runResolve()
+{
+    QVariantMap r;
+
+    // a playlist mixing tracks we have with ones nobody has
+    QList< query_ptr > queries = syntheticQueries( m_options.queries, true );
+    m_resolveLatencies.clear();
+    m_resolveSolved = 0;
+
+    foreach ( const query_ptr& q, queries )
+        connect( q.data(), SIGNAL( resolvingFinished( bool ) ), SLOT( onQueryResolved( bool ) ) );
+
+    SignalWaiter waiter( Pipeline::instance(), SIGNAL( idle() ) );
+    m_resolveTimer.start();
+    Pipeline::instance()->resolve( queries );
+    if ( !waiter.wait() )
+        return QVariantMap();
+
+    r[ "ms" ] = m_resolveTimer.elapsed();
+    r[ "queries" ] = queries.count();
+    r[ "solved" ] = m_resolveSolved;
+    r[ "latency" ] = latencies( m_resolveLatencies );
+
+    m_resolved = queries;
+    return r;
+}
+
+
+void
+Benchmark::onQueryResolved( bool hasResults )
+{
+    m_resolveLatencies << m_resolveTimer.elapsed();
+
+    Query* q = qobject_cast< Query* >( sender() );
+    if ( q && hasResults && q->solved() )
+        m_resolveSolved++;
+}
+
+
+QVariantMap
+Benchmark::runOplog()
+{
+    QVariantMap r;
+
+    m_ops.clear();
+    DatabaseCommand_loadOps* load = new DatabaseCommand_loadOps( m_local, QString() );
+    connect( load, SIGNAL( done( QString, QString, QList< dbop_ptr > ) ),
+                     SLOT( onOpsLoaded( QString, QString, QList< dbop_ptr > ) ), Qt::DirectConnection );
+
+    QTime t;
+    t.start();
+    if ( !execute( load ) )
+        return QVariantMap();
+    r[ "loadMs" ] = t.elapsed();
+
+    const QList< dbop_ptr > ops = m_ops;
+    m_ops.clear();
+    r[ "ops" ] = ops.count();
+
+    qint64 bytes = 0;
+    foreach ( const dbop_ptr& op, ops )
+        bytes += op->payload.length();
+    r[ "bytes" ] = bytes;
+
+    // replay everything onto a fresh peer, the same way DBSyncConnection applies a sync
+    source_ptr peer = SourceList::instance()->get( "bench-oplog-peer", "Oplog Peer" );
+    {
+        SignalWaiter waiter( peer.data(), SIGNAL( syncedWithDatabase() ) );
+        QMetaObject::invokeMethod( peer.data(), "setOnline", Qt::QueuedConnection );
+        if ( !waiter.wait() )
+            return QVariantMap();
+    }
+
+    t.start();
+    QJson::Parser parser;
+    QList< QSharedPointer<DatabaseCommand> > cmds;
+    foreach ( const dbop_ptr& op, ops )
+    {
+        const QByteArray payload = op->compressed ? qUncompress( op->payload ) : op->payload;
+
+        bool ok;
+        const QVariant v = parser.parse( payload, &ok );
+        if ( !ok )
+            return QVariantMap();
+
+        DatabaseCommand* cmd = DatabaseCommand::factory( v, peer );
+        if ( cmd )
+            cmds << QSharedPointer< DatabaseCommand >( cmd );
+    }
+    r[ "parseMs" ] = t.elapsed();
+
+    // a whole batch at once, like DBSyncConnection hands it over
+    SignalWaiter waiter( peer.data(), SIGNAL( commandsFinished() ) );
+    QMetaObject::invokeMethod( peer.data(), "addCommands", Qt::DirectConnection,
+                               Q_ARG( QList< QSharedPointer<DatabaseCommand> >, cmds ) );
+    QMetaObject::invokeMethod( peer.data(), "executeCommands", Qt::DirectConnection );
+    if ( !waiter.wait() )
+        return QVariantMap();
+    r[ "applyMs" ] = t.elapsed();
+
+    return r;
+}
+
+
+void
+Benchmark::onOpsLoaded( const QString& sinceguid, const QString& lastguid, const QList< dbop_ptr >& ops )
+{
+    Q_UNUSED( sinceguid );
+    Q_UNUSED( lastguid );
+
+    // runs on the database worker thread, before the command's finished() is emitted
+    m_ops = ops;
+}
+
+
+QVariantMap
+Benchmark::runTransfer()
+{
+    QVariantMap r;
+
+    QTcpServer server;
+    if ( !server.listen( QHostAddress::LocalHost, 0 ) )
+        return QVariantMap();
+
+    QTcpSocket* client;
+    QTcpSocket* incoming;
+    if ( !loopbackSockets( server, client, incoming ) )
+        return QVariantMap();
+
+    LoopbackConnection* receiver = new LoopbackConnection( Servent::instance() );
+    LoopbackConnection* sender = new LoopbackConnection( Servent::instance(), m_options.transferBytes );
+    sender->setOutbound( true );
+
+    QVariantMap firstMsg;
+    firstMsg[ "method" ] = "benchmark";
+    sender->setFirstMessage( firstMsg );
+
+    SignalWaiter waiter( receiver, SIGNAL( transferFinished() ) );
+
+    QTime t;
+    t.start();
+    receiver->start( incoming );
+    sender->start( client );
+    const bool ok = waiter.wait();
+    const int elapsed = t.elapsed();
+
+    r[ "bytes" ] = receiver->payloadReceived();
+    r[ "ms" ] = elapsed;
+    r[ "mbPerSecond" ] = receiver->payloadReceived() / 1024.0 / 1024.0 * 1000.0 / qMax( 1, elapsed );
+    r[ "wireBytes" ] = sender->bytesSent();
+
+    // both live on network threads
+    QMetaObject::invokeMethod( sender, "shutdown", Qt::QueuedConnection );
+    QMetaObject::invokeMethod( receiver, "shutdown", Qt::QueuedConnection );
+
+    if ( !ok || receiver->payloadReceived() != m_options.transferBytes )
+        return QVariantMap();
+
+    return r;
+}
+
+
+QVariantMap
+Benchmark::runPeers()
+{
+    QVariantMap r;
+
+    // the transfer split over many peers at once, spread over the servent's network threads
+    const int count = qMax( 1, m_options.connections );
+    const qint64 bytes = qMax( (qint64)1, m_options.transferBytes / count );
+
+    QTcpServer server;
+    if ( !server.listen( QHostAddress::LocalHost, 0 ) )
+        return QVariantMap();
+
+    QList< LoopbackConnection* > receivers;
+    QList< LoopbackConnection* > senders;
+    QList< QPair< QTcpSocket*, QTcpSocket* > > sockets;
+    QSet< QThread* > threads;
+
+    QTime t;
+    t.start();
+    for ( int i = 0; i < count; i++ )
+    {
+        QTcpSocket* client;
+        QTcpSocket* incoming;
+        if ( !loopbackSockets( server, client, incoming ) )
+            return QVariantMap();
+
+        LoopbackConnection* receiver = new LoopbackConnection( Servent::instance() );
+        LoopbackConnection* sender = new LoopbackConnection( Servent::instance(), bytes );
+        sender->setOutbound( true );
+
+        QVariantMap firstMsg;
+        firstMsg[ "method" ] = "benchmark";
+        sender->setFirstMessage( firstMsg );
+
+        connect( receiver, SIGNAL( transferFinished() ), SLOT( onPeerTransferFinished() ), Qt::QueuedConnection );
+
+        receivers << receiver;
+        senders << sender;
+        sockets << qMakePair( incoming, client );
+        threads << receiver->thread() << sender->thread();
+    }
+    r[ "connectMs" ] = t.elapsed();
+
+    m_peerLatencies.clear();
+    m_peersPending = count;
+
+    SignalWaiter waiter( this, SIGNAL( peersFinished() ) );
+
+    m_peersTimer.start();
+    for ( int i = 0; i < count; i++ )
+    {
+        receivers.at( i )->start( sockets.at( i ).first );
+        senders.at( i )->start( sockets.at( i ).second );
+    }
+    const bool ok = waiter.wait();
+    const int elapsed = m_peersTimer.elapsed();
+
+    qint64 received = 0;
+    bool complete = true;
+    foreach ( LoopbackConnection* receiver, receivers )
+    {
+        received += receiver->payloadReceived();
+        complete = complete && receiver->payloadReceived() == bytes;
+    }
+
+    r[ "connections" ] = count;
+    r[ "threads" ] = threads.count();
+    r[ "bytes" ] = received;
+    r[ "ms" ] = elapsed;
+    r[ "mbPerSecond" ] = received / 1024.0 / 1024.0 * 1000.0 / qMax( 1, elapsed );
+    r[ "finished" ] = latencies( m_peerLatencies );
+
+    foreach ( LoopbackConnection* conn, senders + receivers )
+        QMetaObject::invokeMethod( conn, "shutdown", Qt::QueuedConnection );
+
+    if ( !ok || !complete )
+        return QVariantMap();
+
+    return r;
+}
+
+
+void
+Benchmark::onPeerTransferFinished()
+{
+    m_peerLatencies << m_peersTimer.elapsed();
+
+    if ( --m_peersPending == 0 )
+        emit peersFinished();
+}
+
+
+QVariantMap
+Benchmark::runIntern()
+{
+    QVariantMap r;
+
+    // as many threads as the database has workers, all creating objects at once
+    const int threads = Database::instance()->maxConcurrentThreads() + 1;
+    const int lookups = qMax( 1, m_options.queries ) * INTERN_LOOKUPS_PER_QUERY;
+    const int keys = qMax( 1, m_options.artists * m_options.albumsPerArtist );
+
+    QList< InternWorker* > workers;
+    for ( int i = 0; i < threads; i++ )
+        workers << new InternWorker( BENCHMARK_SEED + i, lookups, keys );
+
+    QTime t;
+    t.start();
+    foreach ( InternWorker* worker, workers )
+        worker->start();
+    foreach ( InternWorker* worker, workers )
+        worker->wait();
+    const int elapsed = t.elapsed();
+
+    qDeleteAll( workers );
+
+    // three factory calls per lookup
+    r[ "threads" ] = threads;
+    r[ "lookups" ] = threads * lookups * 3;
+    r[ "ms" ] = elapsed;
+    r[ "lookupsPerSecond" ] = threads * lookups * 3 * 1000.0 / qMax( 1, elapsed );
+
+    QVariantMap contended;
+    foreach ( const QString& name, QStringList() << "artist" << "album" << "result" )
+        contended[ name ] = Metrics::instance()->counter( "intern." + name + ".contended" );
+    r[ "contended" ] = contended;
+
+    return r;
+}
+
+
+QVariantMap
+Benchmark::runRegistry()
+{
+    QVariantMap r;
+    Servent* servent = Servent::instance();
+    const int count = REGISTRY_PEERS;
+    const int lookups = count * REGISTRY_LOOKUP_ROUNDS;
+    const unsigned int connectedBefore = servent->numConnectedPeers();
+
+    // control connections that never get a socket, so nothing but the registry sees them
+    QList< ControlConnection* > conns;
+    for ( int i = 0; i < count; i++ )
+    {
+        ControlConnection* cc = new ControlConnection( servent, QString() );
+        cc->setName( QString( "registry-peer-%1" ).arg( i ) );
+        cc->setId( QString( "registry-node-%1" ).arg( i ) );
+        conns << cc;
+    }
+
+    QTime t;
+    t.start();
+    foreach ( ControlConnection* cc, conns )
+        servent->registerControlConnection( cc );
+    r[ "registerMs" ] = t.elapsed();
+
+    t.start();
+    for ( int i = 0; i < count; i++ )
+        servent->registerOffer( QString( "registry-offer-%1" ).arg( i ), conns.at( i ) );
+    r[ "offersMs" ] = t.elapsed();
+
+    t.start();
+    for ( int i = 0; i < count; i++ )
+        SourceList::instance()->get( QString( "registry-source-%1" ).arg( i ), QString( "Registry %1" ).arg( i ) );
+    r[ "sourcesMs" ] = t.elapsed();
+
+    bool ok = servent->numConnectedPeers() == connectedBefore + count;
+
+    // the same names every round, built up front so the timings are the lookups alone
+    QStringList names, ids, usernames, friendlyNames;
+    for ( int i = 0; i < count; i++ )
+    {
+        names << conns.at( i )->name();
+        ids << conns.at( i )->id();
+        usernames << QString( "registry-source-%1" ).arg( i );
+        friendlyNames << QString( "Registry %1" ).arg( i );
+    }
+
+    t.start();
+    for ( int round = 0; round < REGISTRY_LOOKUP_ROUNDS; round++ )
+    {
+        for ( int i = 0; i < count; i++ )
+        {
+            ok = ok && servent->lookupControlConnection( names.at( i ) ) == conns.at( i );
+            ok = ok && servent->connectedToSession( ids.at( i ) );
+        }
+    }
+    const int connectionLookupMs = t.elapsed();
+
+    t.start();
+    for ( int round = 0; round < REGISTRY_LOOKUP_ROUNDS; round++ )
+    {
+        for ( int i = 0; i < count; i++ )
+            ok = ok && SourceList::instance()->get( usernames.at( i ), friendlyNames.at( i ) )->userName() == usernames.at( i );
+    }
+    const int sourceLookupMs = t.elapsed();
+
+    QVariantMap lookup;
+    lookup[ "lookups" ] = lookups;
+    lookup[ "connectionsMs" ] = connectionLookupMs;
+    lookup[ "connectionsPerSecond" ] = lookups * 2 * 1000.0 / qMax( 1, connectionLookupMs );
+    lookup[ "sourcesMs" ] = sourceLookupMs;
+    lookup[ "sourcesPerSecond" ] = lookups * 1000.0 / qMax( 1, sourceLookupMs );
+    r[ "lookup" ] = lookup;
+
+    // claiming an offer is what an incoming connection does, each one can be claimed once
+    t.start();
+    for ( int i = 0; i < count; i++ )
+    {
+        Connection* claimed = 0;
+        QMetaObject::invokeMethod( servent, "claimOffer", Qt::DirectConnection,
+                                   Q_RETURN_ARG( Connection*, claimed ),
+                                   Q_ARG( ControlConnection*, 0 ),
+                                   Q_ARG( QString, QString() ),
+                                   Q_ARG( QString, QString( "registry-offer-%1" ).arg( i ) ),
+                                   Q_ARG( QHostAddress, QHostAddress( QHostAddress::Any ) ) );
+        ok = ok && claimed == conns.at( i );
+    }
+    r[ "offerClaimsMs" ] = t.elapsed();
+
+    t.start();
+    foreach ( ControlConnection* cc, conns )
+        servent->unregisterControlConnection( cc );
+    r[ "unregisterMs" ] = t.elapsed();
+
+    ok = ok && servent->numConnectedPeers() == connectedBefore;
+    ok = ok && !servent->lookupControlConnection( names.first() ) && !servent->connectedToSession( ids.last() );
+
+    // they live on the network threads; unregistering again from their destructors is a no-op
+    foreach ( ControlConnection* cc, conns )
+        cc->deleteLater();
+
+    // the SourceList never forgets a source, so there is nothing to tear down for those
+    r[ "peers" ] = count;
+    if ( !ok )
+        return QVariantMap();
+
+    return r;
+}
+
+
+#ifndef ENABLE_HEADLESS
+QVariantMap
+Benchmark::runProxyModel()
+{
+    QVariantMap r;
+
+    // prefer the resolved playlist, that's what views normally sort and filter
+    QList< query_ptr > queries = m_resolved.isEmpty() ? syntheticQueries( m_options.queries, true ) : m_resolved;
+
+    PlaylistModel model;
+    TrackProxyModel proxy;
+
+    QTime t;
+    t.start();
+    model.append( queries );
+    proxy.setSourceTrackModel( &model );
+    r[ "rows" ] = model.rowCount( QModelIndex() );
+    r[ "populateMs" ] = t.elapsed();
+
+    QVariantMap sorting;
+    QMap< QString, int > columns;
+    columns[ "artist" ] = TrackModel::Artist;
+    columns[ "track" ] = TrackModel::Track;
+    columns[ "album" ] = TrackModel::Album;
+    columns[ "duration" ] = TrackModel::Duration;
+    foreach ( const QString& name, columns.keys() )
+    {
+        t.start();
+        proxy.sort( columns.value( name ), Qt::AscendingOrder );
+        sorting[ name ] = t.elapsed();
+    }
+    r[ "sortMs" ] = sorting;
+
+    qsrand( BENCHMARK_SEED );
+    QList< int > timings;
+    for ( int i = 0; i < 20; i++ )
+    {
+        t.start();
+        proxy.setFilterRegExp( randomWords( 1 + i % 2 ) );
+        timings << t.elapsed();
+    }
+    r[ "filter" ] = latencies( timings );
+
+    t.start();
+    proxy.setFilterRegExp( QString() );
+    r[ "clearFilterMs" ] = t.elapsed();
+
+    return r;
+}
+#endif
+
+
+QVariantList
+Benchmark::syntheticFiles( int seed, const QString& urlPrefix )
+{
+    qsrand( seed );
+
+    QVariantList files;
+    const uint mtime = QDateTime( QDate( 2011, 1, 1 ) ).toTime_t();
+
+    for ( int a = 0; a < m_options.artists; a++ )
+    {
+        const QString artist = randomWords( 2 );
+
+        for ( int b = 0; b < m_options.albumsPerArtist; b++ )
+        {
+            const QString album = randomWords( 1 + qrand() % 3 );
+            const int year = 1960 + qrand() % 52;
+
+            for ( int t = 0; t < m_options.tracksPerAlbum; t++ )
+            {
+                const QString track = randomWords( 1 + qrand() % 4 );
+                const uint duration = 120 + qrand() % 300;
+
+                QVariantMap m;
+                m[ "url" ] = QString( "%1/%2/%3/%4.mp3" ).arg( urlPrefix ).arg( a ).arg( b ).arg( t );
+                m[ "mtime" ] = mtime + files.count();
+                m[ "size" ] = duration * 40000;
+                m[ "hash" ] = "";
+                m[ "mimetype" ] = "audio/mpeg";
+                m[ "duration" ] = duration;
+                m[ "bitrate" ] = 320;
+                m[ "artist" ] = artist;
+                m[ "album" ] = album;
+                m[ "track" ] = track;
+                m[ "albumpos" ] = t + 1;
+                m[ "composer" ] = "";
+                m[ "discnumber" ] = 1;
+                m[ "year" ] = year;
+
+                files << m;
+            }
+        }
+    }
+
+    return files;
+}
+
+
+QList< query_ptr >
+Benchmark::syntheticQueries( int count, bool resolvable )
+{
+    qsrand( BENCHMARK_SEED );
+
+    QList< query_ptr > queries;
+    for ( int i = 0; i < count; i++ )
+    {
+        // every fifth entry is something nobody has
+        if ( resolvable && !m_tracks.isEmpty() && i % 5 )
+        {
+            const QVariantMap& m = m_tracks.at( qrand() % m_tracks.count() );
+            queries << Query::get( m.value( "artist" ).toString(), m.value( "track" ).toString(), m.value( "album" ).toString(), uuid(), false );
+        }
+        else
+        {
+            queries << Query::get( randomWords( 2 ), randomWords( 3 ), QString(), uuid(), false );
+        }
+    }
+
+    return queries;
+}
+
+
+bool
+Benchmark::execute( DatabaseCommand* cmd )
+{
+    SignalWaiter waiter( cmd, SIGNAL( finished() ) );
+    Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+
+    return waiter.wait();
+}
+
+
+bool
+Benchmark::loopbackSockets( QTcpServer& server, QTcpSocket*& client, QTcpSocket*& incoming )
+{
+    client = new QTcpSocket();
+    {
+        SignalWaiter waiter( &server, SIGNAL( newConnection() ) );
+        client->connectToHost( QHostAddress::LocalHost, server.serverPort() );
+        if ( !waiter.wait( 10000 ) || !client->waitForConnected( 10000 ) )
+        {
+            delete client;
+            return false;
+        }
+    }
+
+    incoming = server.nextPendingConnection();
+    incoming->setParent( 0 );
+    return true;
+}
+
+
+bool
+Benchmark::importFiles( const QVariantList& files, const source_ptr& source )
+{
+    if ( !execute( new DatabaseCommand_AddFiles( files, source ) ) )
+        return false;
+
+    foreach ( const QVariant& v, files )
+    {
+        const QVariantMap m = v.toMap();
+
+        QVariantMap track;
+        track[ "artist" ] = m.value( "artist" );
+        track[ "album" ] = m.value( "album" );
+        track[ "track" ] = m.value( "track" );
+        m_tracks << track;
+    }
+
+    return true;
+}
+
+
+bool
+Benchmark::writeResults( const QVariantMap& results ) const
+{
+    QJson::Serializer serializer;
+    const QByteArray json = serializer.serialize( results );
+
+    QFile f;
+    if ( m_options.output == "-" )
+    {
+        if ( !f.open( stdout, QIODevice::WriteOnly ) )
+            return false;
+    }
+    else
+    {
+        f.setFileName( m_options.output );
+        if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        {
+            tLog() << "Could not write benchmark results to" << m_options.output;
+            return false;
+        }
+    }
+
+    f.write( json );
+    f.write( "\n" );
+
+    tLog() << "Wrote benchmark results to" << ( m_options.output == "-" ? QString( "stdout" ) : m_options.output );
+    return true;
+}
+
+
+QString
+Benchmark::randomWords( int count )
+{
+    const int words = sizeof( s_words ) / sizeof( s_words[0] );
+
+    QStringList sl;
+    for ( int i = 0; i < count; i++ )
+        sl << QString::fromLatin1( s_words[ qrand() % words ] );
+
+    return sl.join( " " );
+}
+
+
+QVariantMap
+Benchmark::latencies( QList< int > ms )
+{
+    QVariantMap m;
+    m[ "count" ] = ms.count();
+    if ( ms.isEmpty() )
+        return m;
+
+    qSort( ms );
+
+    qint64 sum = 0;
+    foreach ( int i, ms )
+        sum += i;
+
+    m[ "totalMs" ] = sum;
+    m[ "meanMs" ] = (double)sum / ms.count();
+    m[ "minMs" ] = ms.first();
+    m[ "p50Ms" ] = ms.at( ms.count() / 2 );
+    m[ "p95Ms" ] = ms.at( qMin( ms.count() - 1, ms.count() * 95 / 100 ) );
+    m[ "maxMs" ] = ms.last();
+
+    return m;
+}
@@ -0,0 +1,151 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QtCore/QObject>
+#include <QtCore/QEventLoop>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
+#include <QtCore/QVariantMap>
+
+#include "typedefs.h"
+#include "database/op.h"
+
+class DatabaseCommand;
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * Blocks in a local event loop until a signal fires or the timeout expires.
+ * Connect it before triggering the work, so a signal emitted early is not lost.
+ */
+class SignalWaiter : public QObject
+{
+Q_OBJECT
+
+public:
+    SignalWaiter( QObject* sender, const char* signal );
+
+    // returns false on timeout
+    bool wait( int timeout = 10 * 60 * 1000 );
+
+private slots:
+    void onSignal();
+
+private:
+    QEventLoop m_loop;
+    QTimer m_timer;
+    bool m_fired;
+};
+
+
+/**
+ * Drives libtomahawk through reproducible workloads on a synthetic collection
+ * and writes the timings as JSON.
+ *
+ * The collection is generated from a fixed seed, so two runs with the same
+ * parameters work on identical data and their results can be compared.
+ */
+class Benchmark : public QObject
+{
+Q_OBJECT
+
+public:
+    struct Options
+    {
+        Options();
+
+        int artists;
+        int albumsPerArtist;
+        int tracksPerAlbum;
+        int peers;
+        int queries;
+        qint64 transferBytes;
+        int connections;
+        QStringList scenarios;
+        QString output;
+    };
+
+    explicit Benchmark( const Options& options, QObject* parent = 0 );
+    virtual ~Benchmark();
+
+    static QStringList availableScenarios();
+
+    // returns the process exit code
+    int run();
+
+signals:
+    void peersFinished();
+
+private slots:
+    void onSearchResults( const Tomahawk::QID& qid, const QList< Tomahawk::result_ptr >& results );
+    void onQueryResolved( bool hasResults );
+    void onOpsLoaded( const QString& sinceguid, const QString& lastguid, const QList< dbop_ptr >& ops );
+    void onPeerTransferFinished();
+
+private:
+    bool setupEnvironment();
+
+    QVariantMap runImport();
+    QVariantMap runIndex();
+    QVariantMap runResolve();
+    QVariantMap runOplog();
+    QVariantMap runTransfer();
+    QVariantMap runPeers();
+    QVariantMap runIntern();
+    QVariantMap runRegistry();
+    QVariantMap runProxyModel();
+
+    QVariantList syntheticFiles( int seed, const QString& urlPrefix );
+    QList< Tomahawk::query_ptr > syntheticQueries( int count, bool resolvable );
+
+    // enqueues cmd and blocks until it finished
+    bool execute( DatabaseCommand* cmd );
+    bool importFiles( const QVariantList& files, const Tomahawk::source_ptr& source );
+    // both ends of a fresh localhost tcp connection, without parents
+    bool loopbackSockets( QTcpServer& server, QTcpSocket*& client, QTcpSocket*& incoming );
+
+    bool writeResults( const QVariantMap& results ) const;
+
+    static QString randomWords( int count );
+    static QVariantMap latencies( QList< int > ms );
+
+    Options m_options;
+    Tomahawk::source_ptr m_local;
+    QList< Tomahawk::source_ptr > m_peers;
+
+    QList< QVariantMap > m_tracks; // artist, album, track of everything imported
+    QList< Tomahawk::query_ptr > m_resolved;
+    QList< dbop_ptr > m_ops;
+
+    int m_searchHits;
+
+    QTime m_resolveTimer;
+    QList< int > m_resolveLatencies;
+    int m_resolveSolved;
+
+    QTime m_peersTimer;
+    QList< int > m_peerLatencies;
+    int m_peersPending;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,112 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "loopbackconnection.h"
+
+#include "network/servent.h"
+#include "utils/logger.h"
+
+// same as BufferIODevice, which is what StreamConnection reads its blocks from
+#define BLOCKSIZE 4096
+
+// don't let more than this many bytes pile up in the socket's write buffer
+#define MAX_INFLIGHT 1024 * 1024
+
+
+LoopbackConnection::LoopbackConnection( Servent* servent, qint64 bytes )
+    : Connection( servent, servent->connectionThread() )
+    , m_toSend( bytes )
+    , m_sent( 0 )
+    , m_received( 0 )
+{
+    setId( bytes > 0 ? "LoopbackConnection/sender" : "LoopbackConnection/receiver" );
+
+    if ( bytes > 0 )
+    {
+        m_block = QByteArray( "data" );
+        m_block.append( QByteArray( BLOCKSIZE, 'x' ) );
+    }
+}
+
+
+LoopbackConnection::~LoopbackConnection()
+{
+}
+
+
+Connection*
+LoopbackConnection::clone()
+{
+    Q_ASSERT( false );
+    return 0;
+}
+
+
+void
+LoopbackConnection::setup()
+{
+    if ( m_toSend > 0 )
+        QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+}
+
+
+void
+LoopbackConnection::sendSome()
+{
+    if ( m_sent >= m_toSend )
+        return;
+
+    // wait for the socket to drain, like a real peer would be limited by its read speed
+    if ( m_sent - bytesSent() > MAX_INFLIGHT )
+    {
+        QTimer::singleShot( 1, this, SLOT( sendSome() ) );
+        return;
+    }
+
+    const qint64 len = qMin( (qint64)BLOCKSIZE, m_toSend - m_sent );
+    m_sent += len;
+
+    QByteArray ba = len == BLOCKSIZE ? m_block : m_block.left( len + 4 );
+    if ( m_sent >= m_toSend )
+    {
+        sendMsg( Msg::factory( ba, Msg::RAW ) );
+        return;
+    }
+
+    sendMsg( Msg::factory( ba, Msg::RAW | Msg::FRAGMENT ) );
+    QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+}
+
+
+void
+LoopbackConnection::handleMsg( msg_ptr msg )
+{
+    // the sender's first msg, nothing to do with it
+    if ( !msg->is( Msg::RAW ) )
+        return;
+
+    if ( msg->payload().startsWith( "data" ) )
+        m_received += msg->payload().length() - 4;
+
+    if ( !msg->is( Msg::FRAGMENT ) )
+    {
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Received" << m_received << "bytes";
+        emit transferFinished();
+    }
+}
@@ -0,0 +1,65 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LOOPBACKCONNECTION_H
+#define LOOPBACKCONNECTION_H
+
+#include "network/connection.h"
+
+/**
+ * Minimal Connection used to measure the raw throughput of the msg framing
+ * and socket layer over localhost.
+ *
+ * The sending side pushes \a bytes of data as RAW|FRAGMENT msgs, block by
+ * block, the same way StreamConnection feeds audio to a peer; the receiving
+ * side counts the payload and emits transferFinished() on the last block.
+ */
+class LoopbackConnection : public Connection
+{
+Q_OBJECT
+
+public:
+    explicit LoopbackConnection( Servent* servent, qint64 bytes = 0 );
+    virtual ~LoopbackConnection();
+
+    Connection* clone();
+
+    qint64 payloadSent() const { return m_sent; }
+    qint64 payloadReceived() const { return m_received; }
+
+signals:
+    void transferFinished();
+
+protected:
+    virtual void setup();
+
+protected slots:
+    virtual void handleMsg( msg_ptr msg );
+
+private slots:
+    void sendSome();
+
+private:
+    qint64 m_toSend;
+    qint64 m_sent;
+    qint64 m_received;
+    QByteArray m_block;
+};
+
+#endif // LOOPBACKCONNECTION_H
@@ -0,0 +1,119 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifdef ENABLE_HEADLESS
+    #include <QtCore/QCoreApplication>
+    #define BENCH_APPLICATION QCoreApplication
+#else
+    #include <QtGui/QApplication>
+    #define BENCH_APPLICATION QApplication
+#endif
+
+#include <QtCore/QStringList>
+
+#include <iostream>
+
+#include "benchmark.h"
+#include "tomahawksettings.h"
+
+const char* k_usage =
+    "Usage:\n"
+    "  tomahawk-bench [options]\n"
+    "\n"
+    "Options:\n"
+    "  --artists <n>         artists in the synthetic collection (200)\n"
+    "  --albums <n>          albums per artist (5)\n"
+    "  --tracks <n>          tracks per album (10)\n"
+    "  --peers <n>           fake peers sharing part of the collection (2)\n"
+    "  --queries <n>         searches and playlist entries to resolve, hundreds of factory calls per thread in the intern scenario (1000)\n"
+    "  --transfer <MB>       megabytes sent over the loopback connection (64)\n"
+    "  --connections <n>     concurrent loopback connections the transfer is split over in the peers scenario (32)\n"
+    "  --scenarios <a,b,..>  scenarios to run, out of: %1\n"
+    "  --output <file>       where to write the JSON results, - for stdout (tomahawk-bench.json)\n";
+
+
+static bool
+parseArguments( const QStringList& args, Benchmark::Options& options )
+{
+    for ( int i = 1; i < args.count(); i++ )
+    {
+        const QString arg = args.at( i );
+        if ( i + 1 >= args.count() )
+            return false;
+
+        const QString value = args.at( ++i );
+        bool ok = true;
+
+        if ( arg == "--artists" )
+            options.artists = value.toInt( &ok );
+        else if ( arg == "--albums" )
+            options.albumsPerArtist = value.toInt( &ok );
+        else if ( arg == "--tracks" )
+            options.tracksPerAlbum = value.toInt( &ok );
+        else if ( arg == "--peers" )
+            options.peers = value.toInt( &ok );
+        else if ( arg == "--queries" )
+            options.queries = value.toInt( &ok );
+        else if ( arg == "--transfer" )
+            options.transferBytes = value.toLongLong( &ok ) * 1024 * 1024;
+        else if ( arg == "--connections" )
+            options.connections = value.toInt( &ok );
+        else if ( arg == "--scenarios" )
+            options.scenarios = value.split( ",", QString::SkipEmptyParts );
+        else if ( arg == "--output" )
+            options.output = value;
+        else
+            return false;
+
+        if ( !ok )
+            return false;
+    }
+
+    return true;
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    // keep settings, database and search index away from a real Tomahawk installation
+    QCoreApplication::setApplicationName( "tomahawk-bench" );
+    QCoreApplication::setOrganizationName( "Tomahawk-Bench" );
+    QCoreApplication::setOrganizationDomain( "tomahawk-player.org" );
+
+#ifdef ENABLE_HEADLESS
+    BENCH_APPLICATION app( argc, argv );
+#else
+    BENCH_APPLICATION app( argc, argv, false );
+#endif
+
+    Benchmark::Options options;
+    options.output = "tomahawk-bench.json";
+    if ( app.arguments().contains( "--help" ) || !parseArguments( app.arguments(), options ) )
+    {
+        std::cout << QString( k_usage ).arg( Benchmark::availableScenarios().join( ", " ) ).toLocal8Bit().constData();
+        return 1;
+    }
+
+    new TomahawkSettings( &app );
+
+    // the scenarios spin their own event loops while waiting, no need for app.exec()
+    Benchmark benchmark( options );
+    return benchmark.run();
+}
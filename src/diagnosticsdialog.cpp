@@ -31,7 +31,10 @@
 #include <QApplication>
 #include <QClipboard>
 
+#include "database/tomahawksqlquery.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
+#include "utils/stringpool.h"
 
 
 DiagnosticsDialog::DiagnosticsDialog( QWidget *parent )
@@ -89,6 +92,67 @@ void DiagnosticsDialog::updateLogView()
     }
     log.append("\n\n");
 
+    // runtime metrics, also served as JSON on /stats
+    const QVariantMap metrics = Metrics::instance()->snapshot();
+    log.append( "METRICS:\n" );
+
+    log.append( "    Counters:\n" );
+    const QVariantMap counters = metrics.value( "counters" ).toMap();
+    foreach ( const QString& name, counters.keys() )
+        log.append( QString( "      %1: %2\n" ).arg( name ).arg( counters.value( name ).toLongLong() ) );
+
+    log.append( "    Gauges:\n" );
+    const QVariantMap gauges = metrics.value( "gauges" ).toMap();
+    foreach ( const QString& name, gauges.keys() )
+        log.append( QString( "      %1: %2\n" ).arg( name ).arg( gauges.value( name ).toLongLong() ) );
+
+    log.append( "    Latencies (ms):\n" );
+    const QVariantMap histograms = metrics.value( "histograms" ).toMap();
+    foreach ( const QString& name, histograms.keys() )
+    {
+        const QVariantMap h = histograms.value( name ).toMap();
+        log.append(
+            QString( "      %1: count %2, mean %3, p50 %4, p95 %5, max %6\n" )
+                .arg( name )
+                .arg( h.value( "count" ).toLongLong() )
+                .arg( h.value( "mean" ).toLongLong() )
+                .arg( h.value( "p50" ).toLongLong() )
+                .arg( h.value( "p95" ).toLongLong() )
+                .arg( h.value( "max" ).toLongLong() )
+        );
+    }
+
+    log.append( "    Slowest SQL statements (total ms):\n" );
+    const QHash< QString, TomahawkSqlQuery::Statistics > statements = TomahawkSqlQuery::statistics();
+    QMultiMap< quint64, QString > byTime;
+    foreach ( const QString& statement, statements.keys() )
+        byTime.insert( statements.value( statement ).totalTime, statement );
+
+    QMapIterator< quint64, QString > it( byTime );
+    it.toBack();
+    for ( int i = 0; i < 10 && it.hasPrevious(); i++ )
+    {
+        it.previous();
+        const TomahawkSqlQuery::Statistics stats = statements.value( it.value() );
+        log.append(
+            QString( "      %1 ms, %2 runs, %3 slow: %4\n" )
+                .arg( stats.totalTime )
+                .arg( stats.count )
+                .arg( stats.slow )
+                .arg( it.value().simplified() )
+        );
+    }
+
+    // names shared through the string pool, against one copy per holder without it
+    const StringPool::Statistics pool = StringPool::instance()->statistics();
+    log.append(
+        QString( "    String pool: %1 strings, %2 KB pooled, %3 KB without pooling\n" )
+            .arg( pool.strings )
+            .arg( pool.bytes / 1024 )
+            .arg( pool.unpooledBytes / 1024 )
+    );
+    log.append( "\n\n" );
+
 
     // Peers / Accounts, TODO
     log.append("ACCOUNTS:\n");
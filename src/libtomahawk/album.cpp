@@ -24,16 +24,30 @@
 #include "database/databaseimpl.h"
 #include "query.h"
 
+#include "utils/internmap.h"
+#include "utils/stringpool.h"
+#include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
+#ifndef ENABLE_HEADLESS
+    #include "utils/covercache.h"
+#endif
+
 using namespace Tomahawk;
 
+static InternMap< unsigned int, Album > s_albums( "album" );
+
+
+static void
+deleteAlbum( Album* album )
+{
+    s_albums.removeDead( album->id() );
+    album->deleteLater();
+}
+
 
 Album::~Album()
 {
-#ifndef ENABLE_HEADLESS
-    delete m_cover;
-#endif
 }
 
 
@@ -54,18 +68,16 @@ Album::get( const Tomahawk::artist_ptr& artist, const QString& name, bool autoCr
 album_ptr
 Album::get( unsigned int id, const QString& name, const Tomahawk::artist_ptr& artist )
 {
-    static QHash< unsigned int, album_ptr > s_albums;
-    static QMutex s_mutex;
-
-    QMutexLocker lock( &s_mutex );
-    if ( s_albums.contains( id ) )
+    if ( id > 0 )
     {
-        return s_albums.value( id );
+        album_ptr a = s_albums.value( id );
+        if ( !a.isNull() )
+            return a;
     }
 
-    album_ptr a = album_ptr( new Album( id, name, artist ), &QObject::deleteLater );
+    album_ptr a = album_ptr( new Album( id, name, artist ), &deleteAlbum );
     if ( id > 0 )
-        s_albums.insert( id, a );
+        return s_albums.insert( id, a );
 
     return a;
 }
@@ -74,12 +86,9 @@ Album::get( unsigned int id, const QString& name, const Tomahawk::artist_ptr& ar
 Album::Album( unsigned int id, const QString& name, const Tomahawk::artist_ptr& artist )
     : QObject()
     , m_id( id )
-    , m_name( name )
+    , m_name( StringPool::intern( name ) )
     , m_artist( artist )
     , m_infoLoaded( false )
-#ifndef ENABLE_HEADLESS
-    , m_cover( 0 )
-#endif
 {
     connect( Tomahawk::InfoSystem::InfoSystem::instance(),
              SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
@@ -129,33 +138,12 @@ Album::cover( const QSize& size, bool forceLoad ) const
         requestData.type = Tomahawk::InfoSystem::InfoAlbumCoverArt;
         requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( trackInfo );
         requestData.customData = QVariantMap();
+        requestData.priority = Tomahawk::InfoSystem::InfoPriorityBackground;
 
         Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
     }
 
-    if ( !m_cover && !m_coverBuffer.isEmpty() )
-    {
-        m_cover = new QPixmap();
-        m_cover->loadFromData( m_coverBuffer );
-    }
-
-    if ( m_cover && !m_cover->isNull() && !size.isEmpty() )
-    {
-        if ( m_coverCache.contains( size.width() ) )
-        {
-            return m_coverCache.value( size.width() );
-        }
-
-        QPixmap scaledCover;
-        scaledCover = m_cover->scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
-        m_coverCache.insert( size.width(), scaledCover );
-        return scaledCover;
-    }
-
-    if ( m_cover )
-        return *m_cover;
-    else
-        return QPixmap();
+    return CoverCache::instance()->cover( m_coverId, m_coverBuffer, size, const_cast< Album* >( this ) );
 }
 #endif
 
@@ -176,6 +164,7 @@ Album::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVaria
         if ( ba.length() )
         {
             m_coverBuffer = ba;
+            m_coverId = TomahawkUtils::md5( ba );
         }
     }
 }
@@ -194,6 +183,13 @@ Album::infoSystemFinished( QString target )
 }
 
 
+void
+Album::onCoverReady()
+{
+    emit updated();
+}
+
+
 Tomahawk::playlistinterface_ptr
 Album::playlistInterface()
 {
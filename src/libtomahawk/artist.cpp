@@ -24,16 +24,30 @@
 #include "database/databaseimpl.h"
 #include "query.h"
 
+#include "utils/internmap.h"
+#include "utils/stringpool.h"
+#include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
+#ifndef ENABLE_HEADLESS
+    #include "utils/covercache.h"
+#endif
+
 using namespace Tomahawk;
 
+static InternMap< unsigned int, Artist > s_artists( "artist" );
+
+
+static void
+deleteArtist( Artist* artist )
+{
+    s_artists.removeDead( artist->id() );
+    artist->deleteLater();
+}
+
 
 Artist::~Artist()
 {
-#ifndef ENABLE_HEADLESS
-    delete m_cover;
-#endif
 }
 
 
@@ -54,18 +68,16 @@ Artist::get( const QString& name, bool autoCreate )
 artist_ptr
 Artist::get( unsigned int id, const QString& name )
 {
-    static QHash< unsigned int, artist_ptr > s_artists;
-    static QMutex s_mutex;
-
-    QMutexLocker lock( &s_mutex );
-    if ( s_artists.contains( id ) )
+    if ( id > 0 )
     {
-        return s_artists.value( id );
+        artist_ptr a = s_artists.value( id );
+        if ( !a.isNull() )
+            return a;
     }
 
-    artist_ptr a = artist_ptr( new Artist( id, name ), &QObject::deleteLater );
+    artist_ptr a = artist_ptr( new Artist( id, name ), &deleteArtist );
     if ( id > 0 )
-        s_artists.insert( id, a );
+        return s_artists.insert( id, a );
 
     return a;
 }
@@ -74,13 +86,10 @@ Artist::get( unsigned int id, const QString& name )
 Artist::Artist( unsigned int id, const QString& name )
     : QObject()
     , m_id( id )
-    , m_name( name )
+    , m_name( StringPool::intern( name ) )
     , m_infoLoaded( false )
-#ifndef ENABLE_HEADLESS
-    , m_cover( 0 )
-#endif
 {
-    m_sortname = DatabaseImpl::sortname( name, true );
+    m_sortname = StringPool::intern( DatabaseImpl::sortname( name, true ) );
 
     connect( Tomahawk::InfoSystem::InfoSystem::instance(),
              SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
@@ -120,33 +129,12 @@ Artist::cover( const QSize& size, bool forceLoad ) const
         requestData.type = Tomahawk::InfoSystem::InfoArtistImages;
         requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( trackInfo );
         requestData.customData = QVariantMap();
+        requestData.priority = Tomahawk::InfoSystem::InfoPriorityBackground;
 
         Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
     }
 
-    if ( !m_cover && !m_coverBuffer.isEmpty() )
-    {
-        m_cover = new QPixmap();
-        m_cover->loadFromData( m_coverBuffer );
-    }
-
-    if ( m_cover && !m_cover->isNull() && !size.isEmpty() )
-    {
-        if ( m_coverCache.contains( size.width() ) )
-        {
-            return m_coverCache.value( size.width() );
-        }
-
-        QPixmap scaledCover;
-        scaledCover = m_cover->scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
-        m_coverCache.insert( size.width(), scaledCover );
-        return scaledCover;
-    }
-
-    if ( m_cover )
-        return *m_cover;
-    else
-        return QPixmap();
+    return CoverCache::instance()->cover( m_coverId, m_coverBuffer, size, const_cast< Artist* >( this ) );
 }
 #endif
 
@@ -167,6 +155,7 @@ Artist::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVari
         if ( ba.length() )
         {
             m_coverBuffer = ba;
+            m_coverId = TomahawkUtils::md5( ba );
         }
     }
 }
@@ -185,6 +174,13 @@ Artist::infoSystemFinished( QString target )
 }
 
 
+void
+Artist::onCoverReady()
+{
+    emit updated();
+}
+
+
 Tomahawk::playlistinterface_ptr
 Artist::playlistInterface()
 {
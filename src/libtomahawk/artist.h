@@ -65,6 +65,8 @@ private slots:
     void infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
     void infoSystemFinished( QString target );
 
+    void onCoverReady();
+
 private:
     Q_DISABLE_COPY( Artist )
 
@@ -72,14 +74,10 @@ private:
     QString m_name;
     QString m_sortname;
     QByteArray m_coverBuffer;
+    QString m_coverId;
     bool m_infoLoaded;
     mutable QString m_uuid;
 
-#ifndef ENABLE_HEADLESS
-    mutable QPixmap* m_cover;
-    mutable QHash< int, QPixmap > m_coverCache;
-#endif
-
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
 
@@ -406,8 +406,9 @@ AudioEngine::loadTrack( const Tomahawk::result_ptr& result )
 
             if ( !isHttpResult( m_currentTrack->url() ) && !isLocalResult( m_currentTrack->url() ) )
             {
-                if ( QNetworkReply* qnr_io = qobject_cast< QNetworkReply* >( io.data() ) )
-                    m_mediaObject->setCurrentSource( new QNR_IODeviceStream( qnr_io, this ) );
+                // sequential devices, e.g. network replies, may not have any data yet
+                if ( io->isSequential() )
+                    m_mediaObject->setCurrentSource( new QNR_IODeviceStream( io.data(), this ) );
                 else
                     m_mediaObject->setCurrentSource( io.data() );
                 m_mediaObject->currentSource().setAutoDelete( false );
@@ -669,7 +670,7 @@ AudioEngine::setPlaylist( Tomahawk::playlistinterface_ptr playlist )
 {
     if ( !m_playlist.isNull() )
     {
-        if ( m_playlist.data() && m_playlist.data()->retryMode() == PlaylistInterface::Retry )
+        if ( m_playlist.data() )
             disconnect( m_playlist.data(), SIGNAL( nextTrackReady() ) );
         m_playlist.data()->reset();
     }
@@ -683,7 +684,9 @@ AudioEngine::setPlaylist( Tomahawk::playlistinterface_ptr playlist )
 
     m_playlist = playlist;
 
-    if ( !m_playlist.isNull() && m_playlist.data() && m_playlist.data()->retryMode() == PlaylistInterface::Retry )
+    // the retry mode can change while playing, e.g. when the next row is still resolving,
+    // onPlaylistNextTrackReady() only acts if we're actually waiting
+    if ( !m_playlist.isNull() && m_playlist.data() )
         connect( m_playlist.data(), SIGNAL( nextTrackReady() ), SLOT( onPlaylistNextTrackReady() ) );
 
     emit playlistChanged( playlist );
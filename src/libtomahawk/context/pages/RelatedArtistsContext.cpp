@@ -74,6 +74,7 @@ RelatedArtistsContext::setArtist( const Tomahawk::artist_ptr& artist )
     Tomahawk::InfoSystem::InfoRequestData requestData;
     requestData.caller = m_infoId;
     requestData.customData = QVariantMap();
+    requestData.priority = Tomahawk::InfoSystem::InfoPriorityNowPlaying;
     requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
 
     requestData.type = Tomahawk::InfoSystem::InfoArtistSimilars;
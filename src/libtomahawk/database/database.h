@@ -58,6 +58,9 @@ public:
 
     bool isReady() const { return m_ready; }
 
+    // read-only workers, on top of the one for mutating commands
+    int maxConcurrentThreads() const { return m_maxConcurrentThreads; }
+
 signals:
     void indexReady(); // search index
     void ready();
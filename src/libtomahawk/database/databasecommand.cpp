@@ -34,10 +34,15 @@
 #include "databasecommand_setcollectionattributes.h"
 #include "databasecommand_settrackattributes.h"
 
+// rows in the first chunk a command streams, small enough to show up right away
+#define FIRST_CHUNK_SIZE 100
+
 
 DatabaseCommand::DatabaseCommand( QObject* parent )
     : QObject( parent )
     , m_state( PENDING )
+    , m_canceled( 0 )
+    , m_chunkSize( 0 )
 {
     //qDebug() << Q_FUNC_INFO;
 }
@@ -47,12 +52,16 @@ DatabaseCommand::DatabaseCommand( const source_ptr& src, QObject* parent )
     : QObject( parent )
     , m_state( PENDING )
     , m_source( src )
+    , m_canceled( 0 )
+    , m_chunkSize( 0 )
 {
     //qDebug() << Q_FUNC_INFO;
 }
 
 DatabaseCommand::DatabaseCommand( const DatabaseCommand& other )
     : QObject( other.parent() )
+    , m_canceled( 0 )
+    , m_chunkSize( 0 )
 {
 }
 
@@ -66,6 +75,13 @@ void
 DatabaseCommand::_exec( DatabaseImpl* lib )
 {
     //qDebug() << "RUNNING" << thread();
+    if ( isCanceled() && !doesMutates() )
+    {
+        // nobody is waiting for the results anymore
+        m_state = FINISHED;
+        return;
+    }
+
     m_state = RUNNING;
     emit running();
     exec( lib );
@@ -74,6 +90,17 @@ DatabaseCommand::_exec( DatabaseImpl* lib )
 }
 
 
+bool
+DatabaseCommand::chunkFull( int rows, int chunksEmitted ) const
+{
+    if ( m_chunkSize == 0 )
+        return false;
+
+    const int limit = chunksEmitted ? m_chunkSize : qMin( m_chunkSize, (unsigned int)FIRST_CHUNK_SIZE );
+    return rows >= limit;
+}
+
+
 void
 DatabaseCommand::setSource( const Tomahawk::source_ptr& s )
 {
@@ -20,6 +20,7 @@
 #define DATABASECOMMAND_H
 
 #include <QObject>
+#include <QAtomicInt>
 #include <QMetaType>
 #include <QTime>
 #include <QSqlQuery>
@@ -88,6 +89,18 @@ public:
 
     void emitFinished() { emit finished(); }
 
+    // read-only commands skip their query, or stop before their next chunk of results, once canceled; thread-safe
+    void cancel() { m_canceled = 1; }
+    bool isCanceled() const { return m_canceled != 0; }
+
+    // commands listing a collection emit their results in chunks of at most this many rows, 0 emits them all at once
+    void setChunkSize( unsigned int rows ) { m_chunkSize = rows; }
+    unsigned int chunkSize() const { return m_chunkSize; }
+
+    // time spent waiting for a database worker, measured from DatabaseWorker::enqueue()
+    void setQueued() { m_queued.start(); }
+    int queueTime() const { return m_queued.isValid() ? m_queued.elapsed() : 0; }
+
     static DatabaseCommand* factory( const QVariant& op, const Tomahawk::source_ptr& source );
 
 signals:
@@ -95,10 +108,17 @@ signals:
     void finished();
     void committed();
 
+protected:
+    // whether rows collected since the last chunk should be emitted now, the first chunk is kept small so views fill quickly
+    bool chunkFull( int rows, int chunksEmitted ) const;
+
 private:
     State m_state;
     Tomahawk::source_ptr m_source;
     mutable QString m_guid;
+    QTime m_queued;
+    QAtomicInt m_canceled;
+    unsigned int m_chunkSize;
 
     QVariant m_data;
 };
@@ -18,6 +18,7 @@
 
 #include "databasecommand_addsource.h"
 
+#include <QDateTime>
 #include <QSqlQuery>
 
 #include "databaseimpl.h"
@@ -45,18 +46,20 @@ DatabaseCommand_addSource::exec( DatabaseImpl* dbi )
     if ( query.next() )
     {
         unsigned int id = query.value( 0 ).toInt();
-        query.prepare( "UPDATE source SET isonline = 'true', friendlyname = ? WHERE id = ?" );
+        query.prepare( "UPDATE source SET isonline = 'true', friendlyname = ?, lastseen = ? WHERE id = ?" );
         query.addBindValue( m_fname );
+        query.addBindValue( QDateTime::currentDateTimeUtc().toTime_t() );
         query.addBindValue( id );
         query.exec();
         emit done( id, m_fname );
         return;
     }
 
-    query.prepare( "INSERT INTO source(name, friendlyname, isonline) VALUES(?,?,?)" );
+    query.prepare( "INSERT INTO source(name, friendlyname, isonline, lastseen) VALUES(?,?,?,?)" );
     query.addBindValue( m_username );
     query.addBindValue( m_fname );
     query.addBindValue( true );
+    query.addBindValue( QDateTime::currentDateTimeUtc().toTime_t() );
     query.exec();
 
     unsigned int id = query.lastInsertId().toUInt();
@@ -34,6 +34,8 @@ DatabaseCommand_AllAlbums::DatabaseCommand_AllAlbums( const Tomahawk::collection
   , m_amount( 0 )
   , m_sortOrder( DatabaseCommand_AllAlbums::None )
   , m_sortDescending( false )
+  , m_afterId( 0 )
+  , m_keyset( false )
 {}
 
 
@@ -53,7 +55,9 @@ DatabaseCommand_AllAlbums::execForArtist( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query = dbi->newquery();
     QList<Tomahawk::album_ptr> al;
-    QString orderToken, sourceToken, filterToken, tables;
+    int chunks = 0;
+    QString orderToken, sourceToken, filterToken, keysetToken, tables;
+    const QString direction = m_sortDescending ? "DESC" : QString();
 
     switch ( m_sortOrder )
     {
@@ -61,26 +65,26 @@ DatabaseCommand_AllAlbums::execForArtist( DatabaseImpl* dbi )
             break;
 
         case ModificationTime:
-            orderToken = "file.mtime";
+            orderToken = QString( "file.mtime %1" ).arg( direction );
+            break;
+
+        case Name:
+            // sortnames are only unique per album artist, the id breaks ties for paging
+            orderToken = QString( "album.sortname %1, album.id %1" ).arg( direction );
+            break;
     }
 
     if ( !m_collection.isNull() )
         sourceToken = QString( "AND file.source %1 " ).arg( m_collection->source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( m_collection->source()->id() ) );
 
     if ( !m_filter.isEmpty() )
-    {
-        QString filtersql;
-        QStringList sl = m_filter.split( " ", QString::SkipEmptyParts );
-        foreach( QString s, sl )
-        {
-            filtersql += QString( " AND ( artist.name LIKE '%%1%' OR album.name LIKE '%%1%' OR track.name LIKE '%%1%' )" ).arg( TomahawkUtils::sqlEscape( s ) );
-        }
+        filterToken = DatabaseImpl::collectionFilterSql( m_filter );
 
-        filterToken = QString( "AND artist.id = file_join.artist AND file_join.track = track.id %1" ).arg( filtersql );
-        tables = "artist, track, file, file_join";
-    }
-    else
-        tables = "file, file_join";
+    // tracks without an album sort first and only make it onto the first page
+    if ( m_keyset )
+        keysetToken = "AND ( album.sortname > ? OR ( album.sortname = ? AND album.id > ? ) )";
+
+    tables = "file, file_join";
 
     QString sql = QString(
         "SELECT DISTINCT album.id, album.name "
@@ -93,11 +97,17 @@ DatabaseCommand_AllAlbums::execForArtist( DatabaseImpl* dbi )
          .arg( m_artist->id() )
          .arg( sourceToken )
          .arg( filterToken )
+         .arg( keysetToken )
          .arg( m_sortOrder > 0 ? QString( "ORDER BY %1" ).arg( orderToken ) : QString() )
-         .arg( m_sortDescending ? "DESC" : QString() )
          .arg( m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString() );
 
     query.prepare( sql );
+    if ( m_keyset )
+    {
+        query.bindValue( 0, m_after );
+        query.bindValue( 1, m_after );
+        query.bindValue( 2, m_afterId );
+    }
     query.exec();
 
     while( query.next() )
@@ -111,9 +121,20 @@ DatabaseCommand_AllAlbums::execForArtist( DatabaseImpl* dbi )
 
         Tomahawk::album_ptr album = Tomahawk::Album::get( albumId, albumName, m_artist );
         al << album;
+
+        if ( chunkFull( al.count(), chunks ) )
+        {
+            emit albums( al, data() );
+            al.clear();
+            chunks++;
+
+            if ( isCanceled() )
+                break;
+        }
     }
 
-    emit albums( al, data() );
+    if ( !isCanceled() && ( !al.isEmpty() || !chunks ) )
+        emit albums( al, data() );
     emit done();
 }
 
@@ -123,7 +144,9 @@ DatabaseCommand_AllAlbums::execForCollection( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query = dbi->newquery();
     QList<Tomahawk::album_ptr> al;
-    QString orderToken, sourceToken;
+    int chunks = 0;
+    QString orderToken, sourceToken, keysetToken;
+    const QString direction = m_sortDescending ? "DESC" : QString();
 
     switch ( m_sortOrder )
     {
@@ -131,26 +154,41 @@ DatabaseCommand_AllAlbums::execForCollection( DatabaseImpl* dbi )
             break;
 
         case ModificationTime:
-            orderToken = "file.mtime";
+            orderToken = QString( "file.mtime %1" ).arg( direction );
+            break;
+
+        case Name:
+            // sortnames are only unique per album artist, the id breaks ties for paging
+            orderToken = QString( "album.sortname %1, album.id %1" ).arg( direction );
+            break;
     }
 
     if ( !m_collection.isNull() )
         sourceToken = QString( "AND file.source %1 " ).arg( m_collection->source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( m_collection->source()->id() ) );
 
+    if ( m_keyset )
+        keysetToken = "AND ( album.sortname > ? OR ( album.sortname = ? AND album.id > ? ) )";
+
     QString sql = QString(
         "SELECT DISTINCT album.id, album.name, album.artist, artist.name "
         "FROM album, file, file_join "
         "LEFT OUTER JOIN artist ON album.artist = artist.id "
         "WHERE file.id = file_join.file "
         "AND file_join.album = album.id "
-        "%1 "
-        "%2 %3 %4"
+        "%1 %2 "
+        "%3 %4"
         ).arg( sourceToken )
+         .arg( keysetToken )
          .arg( m_sortOrder > 0 ? QString( "ORDER BY %1" ).arg( orderToken ) : QString() )
-         .arg( m_sortDescending ? "DESC" : QString() )
          .arg( m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString() );
 
     query.prepare( sql );
+    if ( m_keyset )
+    {
+        query.bindValue( 0, m_after );
+        query.bindValue( 1, m_after );
+        query.bindValue( 2, m_afterId );
+    }
     query.exec();
 
     while( query.next() )
@@ -159,9 +197,20 @@ DatabaseCommand_AllAlbums::execForCollection( DatabaseImpl* dbi )
         Tomahawk::album_ptr album = Tomahawk::Album::get( query.value( 0 ).toUInt(), query.value( 1 ).toString(), artist );
 
         al << album;
+
+        if ( chunkFull( al.count(), chunks ) )
+        {
+            emit albums( al, data() );
+            al.clear();
+            chunks++;
+
+            if ( isCanceled() )
+                break;
+        }
     }
 
-    emit albums( al, data() );
+    if ( !isCanceled() && ( !al.isEmpty() || !chunks ) )
+        emit albums( al, data() );
     emit done();
 }
 
@@ -36,7 +36,8 @@ Q_OBJECT
 public:
     enum SortOrder {
         None = 0,
-        ModificationTime = 1
+        ModificationTime = 1,
+        Name = 2
     };
 
     explicit DatabaseCommand_AllAlbums( const Tomahawk::collection_ptr& collection = Tomahawk::collection_ptr(), const Tomahawk::artist_ptr& artist = Tomahawk::artist_ptr(), QObject* parent = 0 );
@@ -55,6 +56,8 @@ public:
     void setSortOrder( DatabaseCommand_AllAlbums::SortOrder order ) { m_sortOrder = order; }
     void setSortDescending( bool descending ) { m_sortDescending = descending; }
     void setFilter( const QString& filter ) { m_filter = filter; }
+    /// only albums sorting after ( sortname, id ), sorted by Name; pages through an artist's albums with setLimit()
+    void setAfter( const QString& sortname, unsigned int id ) { m_after = sortname; m_afterId = id; m_keyset = true; m_sortOrder = Name; }
 
 signals:
     void albums( const QList<Tomahawk::album_ptr>&, const QVariant& data );
@@ -68,6 +71,9 @@ private:
     DatabaseCommand_AllAlbums::SortOrder m_sortOrder;
     bool m_sortDescending;
     QString m_filter;
+    QString m_after;
+    unsigned int m_afterId;
+    bool m_keyset;
 };
 
 #endif // DATABASECOMMAND_ALLALBUMS_H
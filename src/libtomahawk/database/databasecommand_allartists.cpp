@@ -32,6 +32,7 @@ DatabaseCommand_AllArtists::DatabaseCommand_AllArtists( const Tomahawk::collecti
     , m_amount( 0 )
     , m_sortOrder( DatabaseCommand_AllArtists::None )
     , m_sortDescending( false )
+    , m_keyset( false )
 {}
 
 DatabaseCommand_AllArtists::~DatabaseCommand_AllArtists()
@@ -43,7 +44,8 @@ DatabaseCommand_AllArtists::exec( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query = dbi->newquery();
     QList<Tomahawk::artist_ptr> al;
-    QString orderToken, sourceToken, filterToken, tables, joins;
+    int chunks = 0;
+    QString orderToken, sourceToken, filterToken, keysetToken, tables, joins;
 
     switch ( m_sortOrder )
     {
@@ -52,26 +54,24 @@ DatabaseCommand_AllArtists::exec( DatabaseImpl* dbi )
 
         case ModificationTime:
             orderToken = "file.mtime";
+            break;
+
+        case Name:
+            orderToken = "artist.sortname";
+            break;
     }
 
     if ( !m_collection.isNull() )
         sourceToken = QString( "AND file.source %1" ).arg( m_collection->source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( m_collection->source()->id() ) );
 
     if ( !m_filter.isEmpty() )
-    {
-        QString filtersql;
-        QStringList sl = m_filter.split( " ", QString::SkipEmptyParts );
-        foreach( QString s, sl )
-        {
-            filtersql += QString( " AND ( artist.name LIKE '%%1%' OR album.name LIKE '%%1%' OR track.name LIKE '%%1%' )" ).arg( TomahawkUtils::sqlEscape( s ) );
-        }
+        filterToken = DatabaseImpl::collectionFilterSql( m_filter );
 
-        filterToken = QString( "AND file_join.track = track.id %1" ).arg( filtersql );
-        joins = "LEFT JOIN album ON album.id = file_join.album";
-        tables = "artist, track, file, file_join";
-    }
-    else
-        tables = "artist, file, file_join";
+    // the unique index on artist.sortname makes this a seek, however deep into the collection we are
+    if ( m_keyset )
+        keysetToken = "AND artist.sortname > ?";
+
+    tables = "artist, file, file_join";
 
     QString sql = QString(
             "SELECT DISTINCT artist.id, artist.name "
@@ -79,16 +79,19 @@ DatabaseCommand_AllArtists::exec( DatabaseImpl* dbi )
             "%2 "
             "WHERE file.id = file_join.file "
             "AND file_join.artist = artist.id "
-            "%3 %4 %5 %6 %7"
+            "%3 %4 %5 %6 %7 %8"
             ).arg( tables )
              .arg( joins )
              .arg( sourceToken )
              .arg( filterToken )
+             .arg( keysetToken )
              .arg( m_sortOrder > 0 ? QString( "ORDER BY %1" ).arg( orderToken ) : QString() )
              .arg( m_sortDescending ? "DESC" : QString() )
              .arg( m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString() );
 
     query.prepare( sql );
+    if ( m_keyset )
+        query.bindValue( 0, m_after );
     query.exec();
 
     while( query.next() )
@@ -96,8 +99,19 @@ DatabaseCommand_AllArtists::exec( DatabaseImpl* dbi )
         Tomahawk::artist_ptr artist = Tomahawk::Artist::get( query.value( 0 ).toUInt(), query.value( 1 ).toString() );
 
         al << artist;
+
+        if ( chunkFull( al.count(), chunks ) )
+        {
+            emit artists( al );
+            al.clear();
+            chunks++;
+
+            if ( isCanceled() )
+                break;
+        }
     }
 
-    emit artists( al );
+    if ( !isCanceled() && ( !al.isEmpty() || !chunks ) )
+        emit artists( al );
     emit done();
 }
@@ -35,7 +35,8 @@ Q_OBJECT
 public:
     enum SortOrder {
         None = 0,
-        ModificationTime = 1
+        ModificationTime = 1,
+        Name = 2
     };
 
     explicit DatabaseCommand_AllArtists( const Tomahawk::collection_ptr& collection = Tomahawk::collection_ptr(), QObject* parent = 0 );
@@ -50,6 +51,8 @@ public:
     void setSortOrder( DatabaseCommand_AllArtists::SortOrder order ) { m_sortOrder = order; }
     void setSortDescending( bool descending ) { m_sortDescending = descending; }
     void setFilter( const QString& filter ) { m_filter = filter; }
+    /// only artists sorting after sortname, sorted by Name; pages through a collection with setLimit()
+    void setAfter( const QString& sortname ) { m_after = sortname; m_keyset = true; m_sortOrder = Name; }
 
 signals:
     void artists( const QList<Tomahawk::artist_ptr>& );
@@ -61,6 +64,8 @@ private:
     DatabaseCommand_AllArtists::SortOrder m_sortOrder;
     bool m_sortDescending;
     QString m_filter;
+    QString m_after;
+    bool m_keyset;
 };
 
 #endif // DATABASECOMMAND_ALLARTISTS_H
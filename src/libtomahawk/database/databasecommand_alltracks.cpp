@@ -30,8 +30,9 @@
 void
 DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
 {
-    TomahawkSqlQuery query = dbi->newquery();
     QList<Tomahawk::query_ptr> ql;
+    int chunks = 0;
+    QVariantList binds;
 
     QString m_orderToken, sourceToken;
     switch ( m_sortOrder )
@@ -53,7 +54,11 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
     }
 
     if ( !m_collection.isNull() )
-        sourceToken = QString( "AND file.source %1" ).arg( m_collection->source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( m_collection->source()->id() ) );
+    {
+        sourceToken = QString( "AND file.source %1" ).arg( m_collection->source()->isLocal() ? "IS NULL" : "= ?" );
+        if ( !m_collection->source()->isLocal() )
+            binds << m_collection->source()->id();
+    }
 
     QString albumToken;
     if ( m_album )
@@ -64,9 +69,16 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
             albumToken = QString( "AND album.id IS NULL" );
         }
         else
-            albumToken = QString( "AND album.id = %1" ).arg( m_album->id() );
+            albumToken = QString( "AND album.id = ?" );
     }
 
+    if ( m_artist )
+        binds << m_artist->id();
+    if ( m_album && m_album->id() != 0 )
+        binds << m_album->id();
+    if ( m_amount > 0 )
+        binds << m_amount;
+
     QString sql = QString(
             "SELECT file.id, artist.name, album.name, track.name, composer.name, file.size, "   //0
                    "file.duration, file.bitrate, file.url, file.source, file.mtime, "           //6
@@ -84,15 +96,19 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
             "%2 %3 "
             "%4 %5 %6"
             ).arg( sourceToken )
-             .arg( !m_artist ? QString() : QString( "AND artist.id = %1" ).arg( m_artist->id() ) )
+             .arg( !m_artist ? QString() : "AND artist.id = ?" )
              .arg( !m_album ? QString() : albumToken )
              .arg( m_sortOrder > 0 ? QString( "ORDER BY %1" ).arg( m_orderToken ) : QString() )
              .arg( m_sortDescending ? "DESC" : QString() )
-             .arg( m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString() );
+             .arg( m_amount > 0 ? "LIMIT 0, ?" : QString() );
 
-    query.prepare( sql );
+    TomahawkSqlQuery query = dbi->preparedQuery( sql );
+    for ( int i = 0; i < binds.count(); i++ )
+        query.bindValue( i, binds.at( i ) );
     query.exec();
 
+    TomahawkSqlQuery attrQuery = dbi->preparedQuery( "SELECT k, v FROM track_attributes WHERE id = ?" );
+
     while( query.next() )
     {
         Tomahawk::source_ptr s;
@@ -126,6 +142,7 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
         Tomahawk::artist_ptr composerptr = Tomahawk::Artist::get( query.value( 17 ).toUInt(), composer );
         Tomahawk::album_ptr albumptr = Tomahawk::Album::get( query.value( 15 ).toUInt(), album, artistptr );
 
+        result->setFileId( query.value( 0 ).toUInt() );
         result->setTrackId( query.value( 16 ).toUInt() );
         result->setArtist( artistptr );
         result->setAlbum( albumptr );
@@ -141,10 +158,7 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
         result->setScore( 1.0 );
         result->setCollection( s->collection() );
 
-        TomahawkSqlQuery attrQuery = dbi->newquery();
         QVariantMap attr;
-
-        attrQuery.prepare( "SELECT k, v FROM track_attributes WHERE id = ?" );
         attrQuery.bindValue( 0, result->trackId() );
         attrQuery.exec();
         while ( attrQuery.next() )
@@ -160,10 +174,22 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
         qry->setResolveFinished( true );
 
         ql << qry;
+
+        if ( chunkFull( ql.count(), chunks ) )
+        {
+            emit tracks( ql, data() );
+            ql.clear();
+            chunks++;
+
+            if ( isCanceled() )
+                break;
+        }
     }
 
-    qDebug() << Q_FUNC_INFO << ql.length();
+    qDebug() << Q_FUNC_INFO << ql.length() << chunks;
 
-    emit tracks( ql, data() );
+    // listeners expect at least one, possibly empty, list
+    if ( !isCanceled() && ( !ql.isEmpty() || !chunks ) )
+        emit tracks( ql, data() );
     emit done( m_collection );
 }
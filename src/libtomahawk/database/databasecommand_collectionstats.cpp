@@ -35,25 +35,21 @@ void
 DatabaseCommand_CollectionStats::exec( DatabaseImpl* dbi )
 {
     Q_ASSERT( source()->isLocal() || source()->id() >= 1 );
-    TomahawkSqlQuery query = dbi->newquery();
-
-    QVariantMap m;
-    if ( source()->isLocal() )
+    TomahawkSqlQuery query = dbi->preparedQuery( source()->isLocal() ?
+                             "SELECT count(*), max(mtime), (SELECT guid FROM oplog WHERE source IS NULL ORDER BY id DESC LIMIT 1) "
+                             "FROM file "
+                             "WHERE source IS NULL" :
+                             "SELECT count(*), max(mtime), (SELECT lastop FROM source WHERE id = ?) "
+                             "FROM file "
+                             "WHERE source = ?" );
+    if ( !source()->isLocal() )
     {
-        query.exec( "SELECT count(*), max(mtime), (SELECT guid FROM oplog WHERE source IS NULL ORDER BY id DESC LIMIT 1) "
-                    "FROM file "
-                    "WHERE source IS NULL" );
-    }
-    else
-    {
-        query.prepare( "SELECT count(*), max(mtime), (SELECT lastop FROM source WHERE id = ?) "
-                       "FROM file "
-                       "WHERE source = ?" );
-        query.addBindValue( source()->id() );
-        query.addBindValue( source()->id() );
-        query.exec();
+        query.bindValue( 0, source()->id() );
+        query.bindValue( 1, source()->id() );
     }
+    query.exec();
 
+    QVariantMap m;
     if ( query.next() )
     {
         m.insert( "numfiles", query.value( 0 ).toInt() );
@@ -0,0 +1,326 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databasecommand_compactoplog.h"
+
+#include <QDateTime>
+#include <QSet>
+
+#include "databaseimpl.h"
+#include "tomahawksqlquery.h"
+#include "utils/logger.h"
+
+#include <qjson/parser.h>
+#include <qjson/serializer.h>
+
+// peers not seen for this many days are left out of the compaction horizon
+#define PEER_EXPIRY_DAYS 90
+
+namespace
+{
+    struct LoggedOp
+    {
+        int id;
+        QString command;
+        QVariantMap json;
+        bool dirty;
+        bool drop;
+    };
+
+    QString
+    playlistOf( const LoggedOp& op )
+    {
+        if ( op.command == "createplaylist" )
+            return op.json.value( "playlist" ).toMap().value( "guid" ).toString();
+
+        return op.json.value( "playlistguid" ).toString();
+    }
+}
+
+
+DatabaseCommand_CompactOplog::DatabaseCommand_CompactOplog( QObject* parent )
+    : DatabaseCommand( parent )
+{
+}
+
+
+void
+DatabaseCommand_CompactOplog::exec( DatabaseImpl* lib )
+{
+    TomahawkSqlQuery query = lib->newquery();
+
+    // Peers we haven't heard from in a while don't hold back compaction. Should they
+    // come back, DatabaseCommand_loadOps resyncs them from scratch.
+    const uint cutoff = QDateTime::currentDateTimeUtc().toTime_t() - PEER_EXPIRY_DAYS * 86400;
+
+    // Work out the horizon: the oldest of our ops a known peer has fetched. Peers we
+    // synced with before their progress was tracked, or whose last fetched op we can't
+    // find, may be anywhere, so leave it alone.
+    query.prepare( "SELECT count(*) FROM source WHERE lastseen >= ? AND lastop != '' AND "
+                   "( peerlastop = '' OR peerlastop NOT IN ( SELECT guid FROM oplog WHERE source IS NULL ) )" );
+    query.addBindValue( cutoff );
+    query.exec();
+    if ( query.next() && query.value( 0 ).toInt() > 0 )
+    {
+        tDebug() << "Not compacting oplog, progress of" << query.value( 0 ).toInt() << "peers unknown";
+        emit done( 0, 0 );
+        return;
+    }
+
+    query.prepare( "SELECT min(oplog.id) FROM source, oplog "
+                   "WHERE source.lastseen >= ? AND oplog.guid = source.peerlastop AND oplog.source IS NULL" );
+    query.addBindValue( cutoff );
+    query.exec();
+    int horizon = 0;
+    if ( query.next() && !query.value( 0 ).isNull() )
+        horizon = query.value( 0 ).toInt();
+    else
+    {
+        query.exec( "SELECT max(id) FROM oplog WHERE source IS NULL" );
+        if ( query.next() )
+            horizon = query.value( 0 ).toInt();
+    }
+
+    // ops up to and including the horizon have been applied by every peer. The horizon
+    // op itself must survive, as peers ask for the ops following it by its guid.
+    query.prepare( "SELECT id, command, json, compressed FROM oplog "
+                   "WHERE source IS NULL AND id < ? AND command IN "
+                   "('addfiles', 'deletefiles', 'createplaylist', 'setplaylistrevision', 'renameplaylist', 'deleteplaylist') "
+                   "ORDER BY id ASC" );
+    query.addBindValue( horizon );
+    query.exec();
+
+    QList< LoggedOp > ops;
+    QJson::Parser parser;
+    while ( query.next() )
+    {
+        QByteArray ba = query.value( 2 ).toByteArray();
+        if ( query.value( 3 ).toBool() )
+            ba = qUncompress( ba );
+
+        bool ok;
+        LoggedOp op;
+        op.id = query.value( 0 ).toInt();
+        op.command = query.value( 1 ).toString();
+        op.json = parser.parse( ba, &ok ).toMap();
+        op.dirty = false;
+        op.drop = false;
+
+        if ( !ok )
+        {
+            tLog() << "Failed to parse oplog entry, not compacting oplog:" << op.id;
+            emit done( 0, 0 );
+            return;
+        }
+
+        ops << op;
+    }
+
+    // Files: walk backwards so we know which ids get deleted later on.
+    bool deleteAllLater = false;
+    QSet< QString > deletedLater, cancelled;
+    for ( int i = ops.count() - 1; i >= 0; i-- )
+    {
+        LoggedOp& op = ops[ i ];
+        if ( op.command == "deletefiles" )
+        {
+            if ( deleteAllLater )
+                op.drop = true;
+            else if ( op.json.value( "deleteAll" ).toBool() )
+                deleteAllLater = true;
+            else
+            {
+                foreach ( const QVariant& id, op.json.value( "ids" ).toList() )
+                    deletedLater << id.toString();
+            }
+        }
+        else if ( op.command == "addfiles" )
+        {
+            if ( deleteAllLater )
+            {
+                op.drop = true;
+                continue;
+            }
+
+            QVariantList files;
+            foreach ( const QVariant& file, op.json.value( "files" ).toList() )
+            {
+                const QString id = file.toMap().value( "url" ).toString();
+                if ( deletedLater.contains( id ) )
+                    cancelled << id;
+                else
+                    files << file;
+            }
+
+            if ( files.isEmpty() )
+                op.drop = true;
+            else if ( files.count() != op.json.value( "files" ).toList().count() )
+            {
+                op.json[ "files" ] = files;
+                op.dirty = true;
+            }
+        }
+    }
+
+    // nobody knows about files we just dropped, so they don't need to be deleted either
+    for ( int i = 0; i < ops.count(); i++ )
+    {
+        LoggedOp& op = ops[ i ];
+        if ( op.drop || op.command != "deletefiles" || op.json.value( "deleteAll" ).toBool() )
+            continue;
+
+        QVariantList ids;
+        foreach ( const QVariant& id, op.json.value( "ids" ).toList() )
+        {
+            if ( !cancelled.contains( id.toString() ) )
+                ids << id;
+        }
+
+        if ( ids.isEmpty() )
+            op.drop = true;
+        else if ( ids.count() != op.json.value( "ids" ).toList().count() )
+        {
+            op.json[ "ids" ] = ids;
+            op.dirty = true;
+        }
+    }
+
+    // Playlists: only touch those created within the range, which rules out dynamic
+    // playlists (they have their own commands) and guarantees we see their full history.
+    QHash< QString, QList< int > > playlists;
+    for ( int i = 0; i < ops.count(); i++ )
+    {
+        const LoggedOp& op = ops.at( i );
+        if ( op.command == "createplaylist" || op.command == "setplaylistrevision" ||
+             op.command == "renameplaylist" || op.command == "deleteplaylist" )
+        {
+            playlists[ playlistOf( op ) ] << i;
+        }
+    }
+
+    foreach ( const QList< int >& indexes, playlists )
+    {
+        if ( ops.at( indexes.first() ).command != "createplaylist" )
+            continue;
+
+        bool deleted = false;
+        QList< int > revisions, renames;
+        foreach ( int i, indexes )
+        {
+            if ( ops.at( i ).command == "deleteplaylist" )
+                deleted = true;
+            else if ( ops.at( i ).command == "setplaylistrevision" )
+                revisions << i;
+            else if ( ops.at( i ).command == "renameplaylist" )
+                renames << i;
+        }
+
+        if ( deleted )
+        {
+            foreach ( int i, indexes )
+                ops[ i ].drop = true;
+            continue;
+        }
+
+        for ( int i = 0; i < renames.count() - 1; i++ )
+            ops[ renames.at( i ) ].drop = true;
+
+        // fold the revisions into the last one, as long as they form a single chain
+        if ( revisions.count() < 2 )
+            continue;
+
+        bool linear = true;
+        for ( int i = 1; i < revisions.count() && linear; i++ )
+        {
+            linear = ops.at( revisions.at( i ) ).json.value( "oldrev" ).toString() ==
+                     ops.at( revisions.at( i - 1 ) ).json.value( "newrev" ).toString();
+        }
+        if ( !linear )
+            continue;
+
+        LoggedOp& last = ops[ revisions.last() ];
+        QSet< QString > ordered;
+        foreach ( const QVariant& guid, last.json.value( "orderedguids" ).toList() )
+            ordered << guid.toString();
+
+        QMap< QString, QVariant > entries;
+        foreach ( int i, revisions )
+        {
+            foreach ( const QVariant& entry, ops.at( i ).json.value( "addedentries" ).toList() )
+            {
+                const QString guid = entry.toMap().value( "guid" ).toString();
+                if ( ordered.contains( guid ) )
+                    entries[ guid ] = entry;
+            }
+
+            if ( i != revisions.last() )
+                ops[ i ].drop = true;
+        }
+
+        last.json[ "oldrev" ] = ops.at( revisions.first() ).json.value( "oldrev" );
+        last.json[ "addedentries" ] = QVariantList( entries.values() );
+        last.dirty = true;
+    }
+
+    int removed = 0, rewritten = 0;
+    QJson::Serializer serializer;
+    QStringList dropped;
+    foreach ( const LoggedOp& op, ops )
+    {
+        if ( op.drop )
+        {
+            dropped << QString::number( op.id );
+            removed++;
+            continue;
+        }
+        if ( !op.dirty )
+            continue;
+
+        QByteArray ba = serializer.serialize( op.json );
+        bool compressed = false;
+        if ( ba.length() >= 512 )
+        {
+            ba = qCompress( ba, 9 );
+            compressed = true;
+        }
+
+        query.prepare( "UPDATE oplog SET json = ?, compressed = ? WHERE id = ?" );
+        query.addBindValue( ba );
+        query.addBindValue( compressed );
+        query.addBindValue( op.id );
+        query.exec();
+        rewritten++;
+    }
+
+    while ( !dropped.isEmpty() )
+    {
+        const QStringList batch = dropped.mid( 0, 500 );
+        dropped = dropped.mid( 500 );
+
+        query.exec( QString( "DELETE FROM oplog WHERE id IN ( %1 )" ).arg( batch.join( ", " ) ) );
+    }
+
+    // peers asking for ops from before the horizon have missed compacted changes
+    query.prepare( "INSERT OR REPLACE INTO settings(k, v) VALUES( 'oplog_horizon', "
+                   "max( ?, coalesce( ( SELECT CAST( v AS INTEGER ) FROM settings WHERE k = 'oplog_horizon' ), 0 ) ) )" );
+    query.addBindValue( horizon );
+    query.exec();
+
+    tLog() << "Compacted oplog up to op" << horizon << "- removed" << removed << "and rewrote" << rewritten << "of" << ops.count() << "ops";
+    emit done( removed, rewritten );
+}
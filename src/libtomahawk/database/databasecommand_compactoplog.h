@@ -0,0 +1,54 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASECOMMAND_COMPACTOPLOG_H
+#define DATABASECOMMAND_COMPACTOPLOG_H
+
+#include "databasecommand.h"
+#include "dllmacro.h"
+
+/**
+ * Rewrites the prefix of our own oplog that every known peer has already
+ * fetched into an equivalent, shorter history:
+ *  - files added and deleted again are dropped from both ops, and everything
+ *    before a "delete all files" op goes away,
+ *  - all ops of deleted playlists are dropped,
+ *  - chains of playlist revisions are folded into one checkpoint revision,
+ *    and only the last rename of a playlist is kept.
+ *
+ * Peers never have to replay compacted ops. A peer that lost track, or one
+ * that was away long enough to be left out of the horizon, is resynced from
+ * scratch by DatabaseCommand_loadOps.
+ */
+class DLLEXPORT DatabaseCommand_CompactOplog : public DatabaseCommand
+{
+Q_OBJECT
+
+public:
+    explicit DatabaseCommand_CompactOplog( QObject* parent = 0 );
+
+    virtual QString commandname() const { return "compactoplog"; }
+
+    bool doesMutates() const { return true; }
+    void exec( DatabaseImpl* lib );
+
+signals:
+    void done( int removed, int rewritten );
+};
+
+#endif // DATABASECOMMAND_COMPACTOPLOG_H
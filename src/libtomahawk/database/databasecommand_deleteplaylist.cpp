@@ -20,6 +20,7 @@
 
 #include <QSqlQuery>
 
+#include "dynamic/DynamicPlaylist.h"
 #include "network/servent.h"
 #include "utils/logger.h"
 
@@ -28,6 +29,7 @@ using namespace Tomahawk;
 
 DatabaseCommand_DeletePlaylist::DatabaseCommand_DeletePlaylist( const source_ptr& source, const QString& playlistguid )
     : DatabaseCommandLoggable( source )
+    , m_deleteAll( false )
 {
     setPlaylistguid( playlistguid );
 }
@@ -39,9 +41,21 @@ DatabaseCommand_DeletePlaylist::exec( DatabaseImpl* lib )
     qDebug() << Q_FUNC_INFO;
 
     TomahawkSqlQuery cre = lib->newquery();
+    const QString sourceToken = source()->isLocal() ? "IS NULL" : QString("= %1").arg( source()->id() );
 
-    QString sql = QString( "DELETE FROM playlist WHERE guid = :id AND source %1" )
-                  .arg( source()->isLocal() ? "IS NULL" : QString("= %1").arg( source()->id() ) );
+    if ( m_deleteAll )
+    {
+        // remember what we drop, so the GUI can be told about every playlist
+        cre.exec( QString( "SELECT guid FROM playlist WHERE source %1" ).arg( sourceToken ) );
+        while ( cre.next() )
+            m_deletedGuids << cre.value( 0 ).toString();
+
+        // revisions, entries and dynamic playlist data go along via ON DELETE CASCADE
+        cre.exec( QString( "DELETE FROM playlist WHERE source %1" ).arg( sourceToken ) );
+        return;
+    }
+
+    QString sql = QString( "DELETE FROM playlist WHERE guid = :id AND source %1" ).arg( sourceToken );
     cre.prepare( sql );
     cre.bindValue( ":id", m_playlistguid );
 
@@ -59,10 +73,31 @@ DatabaseCommand_DeletePlaylist::postCommitHook()
         return;
     }
 
-    playlist_ptr playlist = source()->collection()->playlist( m_playlistguid );
-    Q_ASSERT( !playlist.isNull() );
+    if ( m_deleteAll )
+    {
+        foreach ( const QString& guid, m_deletedGuids )
+        {
+            playlist_ptr playlist = source()->collection()->playlist( guid );
+            if ( !playlist.isNull() )
+            {
+                playlist->reportDeleted( playlist );
+                continue;
+            }
+
+            dynplaylist_ptr dynplaylist = source()->collection()->autoPlaylist( guid );
+            if ( dynplaylist.isNull() )
+                dynplaylist = source()->collection()->station( guid );
+            if ( !dynplaylist.isNull() )
+                dynplaylist->reportDeleted( dynplaylist );
+        }
+    }
+    else
+    {
+        playlist_ptr playlist = source()->collection()->playlist( m_playlistguid );
+        Q_ASSERT( !playlist.isNull() );
 
-    playlist->reportDeleted( playlist );
+        playlist->reportDeleted( playlist );
+    }
 
     if( source()->isLocal() )
         Servent::instance()->triggerDBSync();
@@ -30,10 +30,12 @@ class DLLEXPORT DatabaseCommand_DeletePlaylist : public DatabaseCommandLoggable
 {
 Q_OBJECT
 Q_PROPERTY( QString playlistguid READ playlistguid WRITE setPlaylistguid )
+Q_PROPERTY( bool deleteAll READ deleteAll WRITE setDeleteAll )
 
 public:
     explicit DatabaseCommand_DeletePlaylist( QObject* parent = 0 )
             : DatabaseCommandLoggable( parent )
+            , m_deleteAll( false )
     {}
 
     explicit DatabaseCommand_DeletePlaylist( const Tomahawk::source_ptr& source, const QString& playlistguid );
@@ -47,8 +49,16 @@ public:
     QString playlistguid() const { return m_playlistguid; }
     void setPlaylistguid( const QString& s ) { m_playlistguid = s; }
 
+    // deletes every playlist of the source, used to reset a peer before a full resync
+    bool deleteAll() const { return m_deleteAll; }
+    void setDeleteAll( const bool deleteAll ) { m_deleteAll = deleteAll; }
+
 protected:
     QString m_playlistguid;
+    bool m_deleteAll;
+
+private:
+    QStringList m_deletedGuids;
 };
 
 #endif // DATABASECOMMAND_DELETEPLAYLIST_H
@@ -0,0 +1,52 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "databasecommand_filesbyhash.h"
+
+#include "databaseimpl.h"
+#include "utils/logger.h"
+
+
+DatabaseCommand_FilesByHash::DatabaseCommand_FilesByHash( const QString& hash, unsigned int size, QObject* parent )
+    : DatabaseCommand( parent )
+    , m_hash( hash )
+    , m_size( size )
+{
+}
+
+
+void
+DatabaseCommand_FilesByHash::exec( DatabaseImpl* dbi )
+{
+    QList<Tomahawk::result_ptr> resultList;
+
+    TomahawkSqlQuery query = dbi->preparedQuery( "SELECT id FROM file WHERE md5 = ? AND size = ? AND source IS NOT NULL" );
+    query.bindValue( 0, m_hash );
+    query.bindValue( 1, m_size );
+    query.exec();
+
+    while ( query.next() )
+    {
+        Tomahawk::result_ptr result = dbi->file( query.value( 0 ).toInt() );
+        if ( !result.isNull() )
+            resultList << result;
+    }
+
+    emit results( resultList );
+}
@@ -0,0 +1,52 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATABASECOMMAND_FILESBYHASH_H
+#define DATABASECOMMAND_FILESBYHASH_H
+
+#include <QObject>
+
+#include "databasecommand.h"
+#include "result.h"
+#include "dllmacro.h"
+
+/**
+  Loads all remote files with the given content hash and size, i.e. copies
+  of the same file other sources have.
+  */
+class DLLEXPORT DatabaseCommand_FilesByHash : public DatabaseCommand
+{
+Q_OBJECT
+
+public:
+    explicit DatabaseCommand_FilesByHash( const QString& hash, unsigned int size, QObject* parent = 0 );
+
+    virtual void exec( DatabaseImpl* );
+    virtual bool doesMutates() const { return false; }
+    virtual QString commandname() const { return "filesbyhash"; }
+
+signals:
+    void results( const QList<Tomahawk::result_ptr>& results );
+
+private:
+    QString m_hash;
+    unsigned int m_size;
+};
+
+#endif // DATABASECOMMAND_FILESBYHASH_H
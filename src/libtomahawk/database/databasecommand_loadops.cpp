@@ -23,41 +23,78 @@
 #include "source.h"
 #include "utils/logger.h"
 
+#include <qjson/serializer.h>
+
+
+dbop_ptr
+DatabaseCommand_loadOps::resetOp( const QString& command ) const
+{
+    QVariantMap reset;
+    reset[ "command" ] = command;
+    reset[ "guid" ] = uuid();
+    reset[ "deleteAll" ] = true;
+    if ( command == "deletefiles" )
+        reset[ "ids" ] = QVariantList();
+
+    dbop_ptr op( new DBOp );
+    op->guid = reset[ "guid" ].toString();
+    op->command = command;
+    op->payload = QJson::Serializer().serialize( reset );
+    op->compressed = false;
+    op->singleton = false;
+
+    return op;
+}
+
 
 void
 DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
 {
     QList< dbop_ptr > ops;
+    const QString requested = m_since;
 
     if ( !m_since.isEmpty() )
     {
-        TomahawkSqlQuery query = dbi->newquery();
-        query.prepare( QString( "SELECT id FROM oplog WHERE guid = ?" ) );
-        query.addBindValue( m_since );
+        // ops from before the compaction horizon may have been folded or dropped since
+        // the peer fetched them, so it can't carry on from there either
+        TomahawkSqlQuery query = dbi->preparedQuery(
+            "SELECT id FROM oplog WHERE guid = ? AND ( source IS NOT NULL OR "
+            "id >= coalesce( ( SELECT CAST( v AS INTEGER ) FROM settings WHERE k = 'oplog_horizon' ), 0 ) )" );
+        query.bindValue( 0, m_since );
         query.exec();
 
         if ( !query.next() )
         {
-            tLog() << "Unknown oplog guid, requested, not replying:" << m_since;
-            Q_ASSERT( false );
-            emit done( m_since, m_since, ops );
-            return;
+            // The op has been compacted away (see DatabaseCommand_CompactOplog), or the
+            // peer's state is bogus. Wipe what it has of our collection, playlists and
+            // playback history and replay the whole oplog, which leaves it with the same
+            // files, playlists and plays. Social actions and track/collection attributes
+            // are upserts, so replaying them again is harmless.
+            tLog() << "Unknown oplog guid requested, resending full oplog:" << m_since;
+
+            ops << resetOp( "deletefiles" );
+            ops << resetOp( "deleteplaylist" );
+            ops << resetOp( "logplayback" );
+
+            m_since = QString();
         }
     }
 
-    TomahawkSqlQuery query = dbi->newquery();
-    query.prepare( QString(
+    TomahawkSqlQuery query = dbi->preparedQuery( QString(
                    "SELECT guid, command, json, compressed, singleton "
                    "FROM oplog "
                    "WHERE source %1 "
                    "AND id > coalesce((SELECT id FROM oplog WHERE guid = ?),0) "
                    "ORDER BY id ASC"
-                   ).arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) )
+                   ).arg( source()->isLocal() ? "IS NULL" : "= ?" )
                   );
-    query.addBindValue( m_since );
+    int i = 0;
+    if ( !source()->isLocal() )
+        query.bindValue( i++, source()->id() );
+    query.bindValue( i, m_since );
     query.exec();
 
-    QString lastguid = m_since;
+    QString lastguid = requested;
     while( query.next() )
     {
         dbop_ptr op( new DBOp );
@@ -71,6 +108,10 @@ DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
         ops << op;
     }
 
+    // the reset alone would leave the peer asking for its own unknown guid forever
+    if ( lastguid == requested )
+        ops.clear();
+
 //    qDebug() << "Loaded" << ops.length() << "ops from db";
-    emit done( m_since, lastguid, ops );
+    emit done( requested, lastguid, ops );
 }
@@ -43,6 +43,8 @@ signals:
     void done( QString sinceguid, QString lastguid, QList< dbop_ptr > ops );
 
 private:
+    dbop_ptr resetOp( const QString& command ) const;
+
     QString m_since; // guid to load from
 };
 
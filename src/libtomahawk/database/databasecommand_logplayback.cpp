@@ -36,6 +36,9 @@ using namespace Tomahawk;
 void
 DatabaseCommand_LogPlayback::postCommitHook()
 {
+    if ( m_deleteAll )
+        return;
+
     connect( this, SIGNAL( trackPlaying( Tomahawk::query_ptr, unsigned int ) ),
              source().data(), SLOT( onPlaybackStarted( Tomahawk::query_ptr, unsigned int ) ), Qt::QueuedConnection );
     connect( this, SIGNAL( trackPlayed( Tomahawk::query_ptr ) ),
@@ -75,6 +78,12 @@ DatabaseCommand_LogPlayback::exec( DatabaseImpl* dbi )
 {
     Q_ASSERT( !source().isNull() );
 
+    if ( m_deleteAll )
+    {
+        deleteAllPlays( dbi );
+        return;
+    }
+
     if ( m_action != Finished )
         return;
     if ( m_secsPlayed < FINISHED_THRESHOLD )
@@ -104,12 +113,104 @@ DatabaseCommand_LogPlayback::exec( DatabaseImpl* dbi )
     query.bindValue( 3, m_secsPlayed );
 
     query.exec();
+
+    updateStats( dbi, srcid, artid, trkid );
+}
+
+
+void
+DatabaseCommand_LogPlayback::updateStats( DatabaseImpl* dbi, const QVariant& srcid, int artid, int trkid )
+{
+    // runs in the same transaction as the playback_log insert, so the aggregates never drift from the log
+    TomahawkSqlQuery query = dbi->newquery();
+    query.prepare( "UPDATE playback_stats_track "
+                   "SET plays = plays + 1, secs_played = secs_played + ?, last_played = max( last_played, ? ) "
+                   "WHERE source IS ? AND track = ?" );
+    query.addBindValue( m_secsPlayed );
+    query.addBindValue( m_playtime );
+    query.addBindValue( srcid );
+    query.addBindValue( trkid );
+    query.exec();
+
+    if ( query.numRowsAffected() < 1 )
+    {
+        query.prepare( "INSERT INTO playback_stats_track(source, track, artist, plays, secs_played, last_played) "
+                       "VALUES (?, ?, ?, 1, ?, ?)" );
+        query.addBindValue( srcid );
+        query.addBindValue( trkid );
+        query.addBindValue( artid );
+        query.addBindValue( m_secsPlayed );
+        query.addBindValue( m_playtime );
+        query.exec();
+    }
+
+    query.prepare( "UPDATE playback_stats_artist "
+                   "SET plays = plays + 1, secs_played = secs_played + ?, last_played = max( last_played, ? ) "
+                   "WHERE source IS ? AND artist = ?" );
+    query.addBindValue( m_secsPlayed );
+    query.addBindValue( m_playtime );
+    query.addBindValue( srcid );
+    query.addBindValue( artid );
+    query.exec();
+
+    if ( query.numRowsAffected() < 1 )
+    {
+        query.prepare( "INSERT INTO playback_stats_artist(source, artist, plays, secs_played, last_played) "
+                       "VALUES (?, ?, 1, ?, ?)" );
+        query.addBindValue( srcid );
+        query.addBindValue( artid );
+        query.addBindValue( m_secsPlayed );
+        query.addBindValue( m_playtime );
+        query.exec();
+    }
+
+    const unsigned int day = m_playtime / 86400;
+    query.prepare( "UPDATE playback_stats_day SET plays = plays + 1 "
+                   "WHERE source IS ? AND day = ? AND track = ?" );
+    query.addBindValue( srcid );
+    query.addBindValue( day );
+    query.addBindValue( trkid );
+    query.exec();
+
+    if ( query.numRowsAffected() < 1 )
+    {
+        query.prepare( "INSERT INTO playback_stats_day(source, day, track, artist, plays) "
+                       "VALUES (?, ?, ?, ?, 1)" );
+        query.addBindValue( srcid );
+        query.addBindValue( day );
+        query.addBindValue( trkid );
+        query.addBindValue( artid );
+        query.exec();
+    }
+}
+
+
+void
+DatabaseCommand_LogPlayback::deleteAllPlays( DatabaseImpl* dbi )
+{
+    // the replayed logplayback ops rebuild all of these, so they'd be counted twice otherwise
+    const QStringList tables = QStringList() << "playback_log" << "playback_stats_track"
+                                             << "playback_stats_artist" << "playback_stats_day";
+
+    QVariant srcid = source()->isLocal() ? QVariant( QVariant::Int ) : source()->id();
+    tDebug() << "Deleting playback history of source" << srcid;
+
+    TomahawkSqlQuery query = dbi->newquery();
+    foreach ( const QString& table, tables )
+    {
+        query.prepare( QString( "DELETE FROM %1 WHERE source IS ?" ).arg( table ) );
+        query.addBindValue( srcid );
+        query.exec();
+    }
 }
 
 
 bool
 DatabaseCommand_LogPlayback::localOnly() const
 {
+    if ( m_deleteAll )
+        return false;
+
     if ( m_action == Finished )
         return m_secsPlayed < SUBMISSION_THRESHOLD;
 
@@ -39,6 +39,7 @@ Q_PROPERTY( unsigned int playtime READ playtime WRITE setPlaytime )
 Q_PROPERTY( unsigned int secsPlayed READ secsPlayed WRITE setSecsPlayed )
 Q_PROPERTY( unsigned int trackDuration READ trackDuration WRITE setTrackDuration )
 Q_PROPERTY( int action READ action WRITE setAction )
+Q_PROPERTY( bool deleteAll READ deleteAll WRITE setDeleteAll )
 
 public:
     enum Action
@@ -48,11 +49,11 @@ public:
     };
 
     explicit DatabaseCommand_LogPlayback( QObject* parent = 0 )
-        : DatabaseCommandLoggable( parent ), m_playtime( 0 ), m_secsPlayed( 0 ), m_trackDuration( 0 )
+        : DatabaseCommandLoggable( parent ), m_playtime( 0 ), m_secsPlayed( 0 ), m_trackDuration( 0 ), m_action( Finished ), m_deleteAll( false )
     {}
 
     explicit DatabaseCommand_LogPlayback( const Tomahawk::result_ptr& result, Action action, unsigned int secsPlayed = 0, QObject* parent = 0 )
-        : DatabaseCommandLoggable( parent ), m_result( result ), m_secsPlayed( secsPlayed ), m_action( action )
+        : DatabaseCommandLoggable( parent ), m_result( result ), m_secsPlayed( secsPlayed ), m_action( action ), m_deleteAll( false )
     {
         m_playtime = QDateTime::currentDateTimeUtc().toTime_t();
         m_trackDuration = result->duration();
@@ -90,11 +91,18 @@ public:
     int action() const { return m_action; }
     void setAction( int a ) { m_action = (Action)a; }
 
+    // wipes the source's playback log and stats instead of logging a play, sent ahead of a full oplog replay
+    bool deleteAll() const { return m_deleteAll; }
+    void setDeleteAll( const bool deleteAll ) { m_deleteAll = deleteAll; }
+
 signals:
     void trackPlaying( const Tomahawk::query_ptr& query, unsigned int duration );
     void trackPlayed( const Tomahawk::query_ptr& query );
 
 private:
+    void updateStats( DatabaseImpl* dbi, const QVariant& srcid, int artid, int trkid );
+    void deleteAllPlays( DatabaseImpl* dbi );
+
     Tomahawk::result_ptr m_result;
 
     QString m_artist;
@@ -103,6 +111,7 @@ private:
     unsigned int m_secsPlayed;
     unsigned int m_trackDuration;
     Action m_action;
+    bool m_deleteAll;
 };
 
 #endif // DATABASECOMMAND_LOGPLAYBACK_H
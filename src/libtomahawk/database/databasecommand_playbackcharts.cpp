@@ -0,0 +1,113 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databasecommand_playbackcharts.h"
+
+#include <QDateTime>
+#include <QSqlQuery>
+
+#include "artist.h"
+#include "databaseimpl.h"
+#include "sourcelist.h"
+
+#include "utils/logger.h"
+
+
+void
+DatabaseCommand_PlaybackCharts::exec( DatabaseImpl* dbi )
+{
+    TomahawkSqlQuery query = dbi->newquery();
+    QList<Tomahawk::query_ptr> ql;
+    QList<Tomahawk::artist_ptr> al;
+
+    // all-time charts come straight from the per track / artist totals, periods from the daily buckets
+    QString whereToken = "1";
+    QString trackTable = "playback_stats_track";
+    QString artistTable = "playback_stats_artist";
+    if ( m_days > 0 )
+    {
+        const unsigned int firstDay = QDateTime::currentDateTimeUtc().toTime_t() / 86400 - m_days + 1;
+        whereToken = QString( "stats.day >= %1" ).arg( firstDay );
+        trackTable = artistTable = "playback_stats_day";
+    }
+
+    if ( !source().isNull() )
+    {
+        whereToken += QString( " AND stats.source %1" ).arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) );
+    }
+
+    const QString limitToken = m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString();
+
+    // foreign charts rank by how many peers played it, not by how often a single one did
+    const QString counterToken = m_foreignOnly ? "count( DISTINCT stats.source )" : "sum( stats.plays )";
+
+    // only run the queries somebody is listening for
+    if ( receivers( SIGNAL( tracks( QList<Tomahawk::query_ptr> ) ) ) > 0 )
+    {
+        QString trackWhere = whereToken;
+        if ( m_foreignOnly )
+            trackWhere += " AND stats.source IS NOT NULL "
+                          "AND stats.track NOT IN ( SELECT track FROM playback_stats_track WHERE source IS NULL )";
+
+        QString sql = QString(
+                "SELECT track.name, artist.name, %4 AS counter "
+                "FROM %1 stats, track, artist "
+                "WHERE %2 "
+                "AND track.id = stats.track "
+                "AND artist.id = stats.artist "
+                "GROUP BY stats.track "
+                "ORDER BY counter DESC "
+                "%3" ).arg( trackTable ).arg( trackWhere ).arg( limitToken ).arg( counterToken );
+
+        query.prepare( sql );
+        query.exec();
+
+        while ( query.next() )
+        {
+            ql << Tomahawk::Query::get( query.value( 1 ).toString(), query.value( 0 ).toString(), QString() );
+        }
+    }
+
+    if ( receivers( SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ) ) > 0 )
+    {
+        QString artistWhere = whereToken;
+        if ( m_foreignOnly )
+            artistWhere += " AND stats.source IS NOT NULL "
+                           "AND stats.artist NOT IN ( SELECT artist FROM playback_stats_artist WHERE source IS NULL )";
+
+        QString sql = QString(
+                "SELECT artist.id, artist.name, %4 AS counter "
+                "FROM %1 stats, artist "
+                "WHERE %2 "
+                "AND artist.id = stats.artist "
+                "GROUP BY stats.artist "
+                "ORDER BY counter DESC "
+                "%3" ).arg( artistTable ).arg( artistWhere ).arg( limitToken ).arg( counterToken );
+
+        query.prepare( sql );
+        query.exec();
+
+        while ( query.next() )
+        {
+            al << Tomahawk::Artist::get( query.value( 0 ).toUInt(), query.value( 1 ).toString() );
+        }
+    }
+
+    emit tracks( ql );
+    emit artists( al );
+}
@@ -0,0 +1,68 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASECOMMAND_PLAYBACKCHARTS_H
+#define DATABASECOMMAND_PLAYBACKCHARTS_H
+
+#include <QObject>
+#include <QVariantMap>
+
+#include "databasecommand.h"
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+/**
+ * Most played tracks, read from the aggregated playback_stats_* tables.
+ * A null source means all sources, a period of 0 days means all-time.
+ * Foreign-only charts skip everything the local source has played itself, and rank
+ * by the number of peers that played a track or artist rather than by plays.
+ */
+class DLLEXPORT DatabaseCommand_PlaybackCharts : public DatabaseCommand
+{
+Q_OBJECT
+public:
+    explicit DatabaseCommand_PlaybackCharts( const Tomahawk::source_ptr& source, QObject* parent = 0 )
+        : DatabaseCommand( parent )
+        , m_amount( 50 )
+        , m_days( 0 )
+        , m_foreignOnly( false )
+    {
+        setSource( source );
+    }
+
+    virtual void exec( DatabaseImpl* );
+
+    virtual bool doesMutates() const { return false; }
+    virtual QString commandname() const { return "playbackcharts"; }
+
+    void setLimit( unsigned int amount ) { m_amount = amount; }
+    void setPeriod( unsigned int days ) { m_days = days; }
+    void setForeignOnly( bool foreignOnly ) { m_foreignOnly = foreignOnly; }
+
+signals:
+    void tracks( const QList<Tomahawk::query_ptr>& queries );
+    void artists( const QList<Tomahawk::artist_ptr>& artists );
+
+private:
+    unsigned int m_amount;
+    unsigned int m_days;
+    bool m_foreignOnly;
+};
+
+#endif // DATABASECOMMAND_PLAYBACKCHARTS_H
@@ -158,6 +158,7 @@ DatabaseCommand_Resolve::resolve( DatabaseImpl* lib )
 
         result->setModificationTime( files_query.value( 1 ).toUInt() );
         result->setSize( files_query.value( 2 ).toUInt() );
+        result->setHash( files_query.value( 3 ).toString() );
         result->setMimetype( files_query.value( 4 ).toString() );
         result->setDuration( files_query.value( 5 ).toUInt() );
         result->setBitrate( files_query.value( 6 ).toUInt() );
@@ -170,10 +171,9 @@ DatabaseCommand_Resolve::resolve( DatabaseImpl* lib )
         result->setAlbumPos( files_query.value( 17 ).toUInt() );
         result->setTrackId( files_query.value( 9 ).toUInt() );
 
-        TomahawkSqlQuery attrQuery = lib->newquery();
+        TomahawkSqlQuery attrQuery = lib->preparedQuery( "SELECT k, v FROM track_attributes WHERE id = ?" );
         QVariantMap attr;
 
-        attrQuery.prepare( "SELECT k, v FROM track_attributes WHERE id = ?" );
         attrQuery.bindValue( 0, result->trackId() );
         attrQuery.exec();
         while ( attrQuery.next() )
@@ -203,10 +203,8 @@ DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib )
 
     foreach ( const scorepair_t& albumPair, albumPairs )
     {
-        TomahawkSqlQuery query = lib->newquery();
-
-        QString sql = QString( "SELECT album.name, artist.id, artist.name FROM album, artist WHERE artist.id = album.artist AND album.id = %1" ).arg( albumPair.first );
-        query.prepare( sql );
+        TomahawkSqlQuery query = lib->preparedQuery( "SELECT album.name, artist.id, artist.name FROM album, artist WHERE artist.id = album.artist AND album.id = ?" );
+        query.bindValue( 0, albumPair.first );
         query.exec();
 
         QList<Tomahawk::album_ptr> albumList;
@@ -297,6 +295,7 @@ DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib )
 
         result->setModificationTime( files_query.value( 1 ).toUInt() );
         result->setSize( files_query.value( 2 ).toUInt() );
+        result->setHash( files_query.value( 3 ).toString() );
         result->setMimetype( files_query.value( 4 ).toString() );
         result->setDuration( files_query.value( 5 ).toUInt() );
         result->setBitrate( files_query.value( 6 ).toUInt() );
@@ -318,10 +317,9 @@ DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib )
             }
         }
 
-        TomahawkSqlQuery attrQuery = lib->newquery();
+        TomahawkSqlQuery attrQuery = lib->preparedQuery( "SELECT k, v FROM track_attributes WHERE id = ?" );
         QVariantMap attr;
 
-        attrQuery.prepare( "SELECT k, v FROM track_attributes WHERE id = ?" );
         attrQuery.bindValue( 0, result->trackId() );
         attrQuery.exec();
         while ( attrQuery.next() )
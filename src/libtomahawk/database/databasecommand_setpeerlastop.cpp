@@ -0,0 +1,45 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databasecommand_setpeerlastop.h"
+
+#include <QDateTime>
+
+#include "databaseimpl.h"
+#include "tomahawksqlquery.h"
+#include "utils/logger.h"
+
+
+DatabaseCommand_SetPeerLastOp::DatabaseCommand_SetPeerLastOp( int sourceId, const QString& lastop )
+    : DatabaseCommand()
+    , m_id( sourceId )
+    , m_lastop( lastop )
+{
+}
+
+
+void
+DatabaseCommand_SetPeerLastOp::exec( DatabaseImpl* lib )
+{
+    TomahawkSqlQuery q = lib->newquery();
+    q.prepare( "UPDATE source SET peerlastop = ?, lastseen = ? WHERE id = ?" );
+    q.addBindValue( m_lastop );
+    q.addBindValue( QDateTime::currentDateTimeUtc().toTime_t() );
+    q.addBindValue( m_id );
+    q.exec();
+}
@@ -0,0 +1,89 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "databasecommandgroup.h"
+
+#include "database.h"
+#include "databasecommand.h"
+
+
+DatabaseCommandGroup::DatabaseCommandGroup( QObject* parent )
+    : QObject( parent )
+{
+}
+
+
+DatabaseCommandGroup::~DatabaseCommandGroup()
+{
+    cancel();
+}
+
+
+void
+DatabaseCommandGroup::enqueue( DatabaseCommand* cmd )
+{
+    QSharedPointer<DatabaseCommand> ptr( cmd );
+    m_running << ptr;
+
+    connect( cmd, SIGNAL( finished() ), SLOT( onFinished() ), Qt::QueuedConnection );
+    Database::instance()->enqueue( ptr );
+}
+
+
+void
+DatabaseCommandGroup::cancel()
+{
+    foreach ( const QSharedPointer<DatabaseCommand>& cmd, m_running )
+        cmd->cancel();
+
+    m_canceled << m_running;
+    m_running.clear();
+}
+
+
+bool
+DatabaseCommandGroup::isStale( QObject* sender ) const
+{
+    // only compares addresses, sender may be gone already if it wasn't one of ours
+    foreach ( const QSharedPointer<DatabaseCommand>& cmd, m_canceled )
+    {
+        if ( cmd.data() == sender )
+            return true;
+    }
+
+    return false;
+}
+
+
+void
+DatabaseCommandGroup::onFinished()
+{
+    // queued after all the results the command emitted, so none of them can arrive later
+    QObject* cmd = sender();
+    for ( int i = m_running.count() - 1; i >= 0; i-- )
+    {
+        if ( m_running.at( i ).data() == cmd )
+            m_running.removeAt( i );
+    }
+    for ( int i = m_canceled.count() - 1; i >= 0; i-- )
+    {
+        if ( m_canceled.at( i ).data() == cmd )
+            m_canceled.removeAt( i );
+    }
+}
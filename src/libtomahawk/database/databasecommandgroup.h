@@ -0,0 +1,63 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATABASECOMMANDGROUP_H
+#define DATABASECOMMANDGROUP_H
+
+#include <QObject>
+#include <QList>
+#include <QSharedPointer>
+
+#include "dllmacro.h"
+
+class DatabaseCommand;
+
+/**
+ * The read-only commands a model is currently loading from.
+ *
+ * Models enqueue their commands through a group, and cancel it when they
+ * are cleared or go away. Results of canceled commands may still be queued
+ * up in the event loop, so slots check isStale( sender() ) and drop those.
+ * The group keeps every command alive until it finished, which makes sure
+ * a stale sender's address can't be taken by a newer command meanwhile.
+ */
+class DLLEXPORT DatabaseCommandGroup : public QObject
+{
+Q_OBJECT
+
+public:
+    explicit DatabaseCommandGroup( QObject* parent = 0 );
+    virtual ~DatabaseCommandGroup();
+
+    void enqueue( DatabaseCommand* cmd );
+    /// stops all running commands, results they still deliver are stale
+    void cancel();
+
+    bool isLoading() const { return !m_running.isEmpty(); }
+    bool isStale( QObject* sender ) const;
+
+private slots:
+    void onFinished();
+
+private:
+    QList< QSharedPointer<DatabaseCommand> > m_running;
+    QList< QSharedPointer<DatabaseCommand> > m_canceled;
+};
+
+#endif // DATABASECOMMANDGROUP_H
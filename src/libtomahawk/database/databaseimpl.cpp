@@ -21,9 +21,11 @@
 
 #include <QCoreApplication>
 #include <QRegExp>
+#include <QSet>
 #include <QStringList>
 #include <QtAlgorithms>
 #include <QFile>
+#include <QTime>
 
 #include "database/database.h"
 #include "databasecommand_updatesearchindex.h"
@@ -40,7 +42,8 @@
 */
 #include "schema.sql.h"
 
-#define CURRENT_SCHEMA_VERSION 28
+#define CURRENT_SCHEMA_VERSION 33
+#define STATEMENT_CACHE_SIZE 100
 
 
 DatabaseImpl::DatabaseImpl( const QString& dbname, Database* parent )
@@ -94,10 +97,42 @@ DatabaseImpl::DatabaseImpl( const QString& dbname, Database* parent )
 
 DatabaseImpl::~DatabaseImpl()
 {
+    m_statements.clear();
     delete m_fuzzyIndex;
 }
 
 
+TomahawkSqlQuery
+DatabaseImpl::preparedQuery( const QString& sql )
+{
+    QMutexLocker lock( &m_statementsMutex );
+    QHash< QString, TomahawkSqlQuery >& statements = m_statements[ QThread::currentThread() ];
+
+    QHash< QString, TomahawkSqlQuery >::iterator it = statements.find( sql );
+    if ( it != statements.end() )
+    {
+        m_statementCacheHits.ref();
+
+        // drop whatever is left of the previous result set
+        it.value().finish();
+        return it.value();
+    }
+
+    m_statementCacheMisses.ref();
+    if ( statements.count() >= STATEMENT_CACHE_SIZE )
+    {
+        tDebug() << "Prepared statement cache full, flushing";
+        statements.clear();
+    }
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( sql );
+    statements.insert( sql, query );
+
+    return query;
+}
+
+
 void
 DatabaseImpl::dumpDatabase()
 {
@@ -188,6 +223,10 @@ DatabaseImpl::updateSchema( int oldVersion )
                 q.exec( clean );
             }
         }
+        // splitting the existing names into trigrams is beyond what the sql scripts can do
+        if ( oldVersion < 32 )
+            rebuildNameIndex();
+
         m_db.commit();
         tLog() << "DB Upgrade successful!";
         return true;
@@ -209,17 +248,17 @@ Tomahawk::result_ptr
 DatabaseImpl::file( int fid )
 {
     Tomahawk::result_ptr r;
-    TomahawkSqlQuery query = newquery();
-    query.exec( QString( "SELECT url, mtime, size, md5, mimetype, duration, bitrate, "
-                         "file_join.artist, file_join.album, file_join.track, file_join.composer, "
-                         "(select name from artist where id = file_join.artist) as artname, "
-                         "(select name from album  where id = file_join.album)  as albname, "
-                         "(select name from track  where id = file_join.track)  as trkname, "
-                         "(select name from artist where id = file_join.composer) as cmpname, "
-                         "source "
-                         "FROM file, file_join "
-                         "WHERE file.id = file_join.file AND file.id = %1" )
-                .arg( fid ) );
+    TomahawkSqlQuery query = preparedQuery( "SELECT url, mtime, size, md5, mimetype, duration, bitrate, "
+                                            "file_join.artist, file_join.album, file_join.track, file_join.composer, "
+                                            "(select name from artist where id = file_join.artist) as artname, "
+                                            "(select name from album  where id = file_join.album)  as albname, "
+                                            "(select name from track  where id = file_join.track)  as trkname, "
+                                            "(select name from artist where id = file_join.composer) as cmpname, "
+                                            "source "
+                                            "FROM file, file_join "
+                                            "WHERE file.id = file_join.file AND file.id = ?" );
+    query.bindValue( 0, fid );
+    query.exec();
 
     if ( query.next() )
     {
@@ -248,6 +287,7 @@ DatabaseImpl::file( int fid )
 
         r->setModificationTime( query.value( 1 ).toUInt() );
         r->setSize( query.value( 2 ).toUInt() );
+        r->setHash( query.value( 3 ).toString() );
         r->setMimetype( query.value( 4 ).toString() );
         r->setDuration( query.value( 5 ).toUInt() );
         r->setBitrate( query.value( 6 ).toUInt() );
@@ -274,9 +314,8 @@ DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
     int id = 0;
     QString sortname = DatabaseImpl::sortname( name_orig );
 
-    TomahawkSqlQuery query = newquery();
-    query.prepare( "SELECT id FROM artist WHERE sortname = ?" );
-    query.addBindValue( sortname );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id FROM artist WHERE sortname = ?" );
+    query.bindValue( 0, sortname );
     query.exec();
     if ( query.next() )
     {
@@ -292,9 +331,9 @@ DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
     if ( autoCreate )
     {
         // not found, insert it.
-        query.prepare( "INSERT INTO artist(id,name,sortname) VALUES(NULL,?,?)" );
-        query.addBindValue( name_orig );
-        query.addBindValue( sortname );
+        query = preparedQuery( "INSERT INTO artist(id,name,sortname) VALUES(NULL,?,?)" );
+        query.bindValue( 0, name_orig );
+        query.bindValue( 1, sortname );
         if ( !query.exec() )
         {
             tDebug() << "Failed to insert artist:" << name_orig;
@@ -304,6 +343,7 @@ DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
         id = query.lastInsertId().toInt();
         m_lastart = name_orig;
         m_lastartid = id;
+        indexName( ArtistName, id, sortname );
     }
 
     return id;
@@ -317,10 +357,9 @@ DatabaseImpl::trackId( int artistid, const QString& name_orig, bool autoCreate )
     QString sortname = DatabaseImpl::sortname( name_orig );
     //if( ( id = m_artistcache[sortname] ) ) return id;
 
-    TomahawkSqlQuery query = newquery();
-    query.prepare( "SELECT id FROM track WHERE artist = ? AND sortname = ?" );
-    query.addBindValue( artistid );
-    query.addBindValue( sortname );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id FROM track WHERE artist = ? AND sortname = ?" );
+    query.bindValue( 0, artistid );
+    query.bindValue( 1, sortname );
     query.exec();
 
     if ( query.next() )
@@ -336,10 +375,10 @@ DatabaseImpl::trackId( int artistid, const QString& name_orig, bool autoCreate )
     if ( autoCreate )
     {
         // not found, insert it.
-        query.prepare( "INSERT INTO track(id,artist,name,sortname) VALUES(NULL,?,?,?)" );
-        query.addBindValue( artistid );
-        query.addBindValue( name_orig );
-        query.addBindValue( sortname );
+        query = preparedQuery( "INSERT INTO track(id,artist,name,sortname) VALUES(NULL,?,?,?)" );
+        query.bindValue( 0, artistid );
+        query.bindValue( 1, name_orig );
+        query.bindValue( 2, sortname );
         if ( !query.exec() )
         {
             tDebug() << "Failed to insert track:" << name_orig;
@@ -347,6 +386,7 @@ DatabaseImpl::trackId( int artistid, const QString& name_orig, bool autoCreate )
         }
 
         id = query.lastInsertId().toInt();
+        indexName( TrackName, id, sortname );
     }
 
     return id;
@@ -369,10 +409,9 @@ DatabaseImpl::albumId( int artistid, const QString& name_orig, bool autoCreate )
     QString sortname = DatabaseImpl::sortname( name_orig );
     //if( ( id = m_albumcache[sortname] ) ) return id;
 
-    TomahawkSqlQuery query = newquery();
-    query.prepare( "SELECT id FROM album WHERE artist = ? AND sortname = ?" );
-    query.addBindValue( artistid );
-    query.addBindValue( sortname );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id FROM album WHERE artist = ? AND sortname = ?" );
+    query.bindValue( 0, artistid );
+    query.bindValue( 1, sortname );
     query.exec();
     if ( query.next() )
     {
@@ -388,10 +427,10 @@ DatabaseImpl::albumId( int artistid, const QString& name_orig, bool autoCreate )
     if ( autoCreate )
     {
         // not found, insert it.
-        query.prepare( "INSERT INTO album(id,artist,name,sortname) VALUES(NULL,?,?,?)" );
-        query.addBindValue( artistid );
-        query.addBindValue( name_orig );
-        query.addBindValue( sortname );
+        query = preparedQuery( "INSERT INTO album(id,artist,name,sortname) VALUES(NULL,?,?,?)" );
+        query.bindValue( 0, artistid );
+        query.bindValue( 1, name_orig );
+        query.bindValue( 2, sortname );
         if( !query.exec() )
         {
             tDebug() << "Failed to insert album:" << name_orig;
@@ -401,6 +440,7 @@ DatabaseImpl::albumId( int artistid, const QString& name_orig, bool autoCreate )
         id = query.lastInsertId().toInt();
         m_lastalb = name_orig;
         m_lastalbid = id;
+        indexName( AlbumName, id, sortname );
     }
 
     return id;
@@ -462,10 +502,10 @@ DatabaseImpl::getTrackFids( int tid )
 {
     QList< int > ret;
 
-    TomahawkSqlQuery query = newquery();
-    query.exec( QString( "SELECT file.id FROM file, file_join "
-                         "WHERE file_join.file=file.id "
-                         "AND file_join.track = %1 ").arg( tid ) );
+    TomahawkSqlQuery query = preparedQuery( "SELECT file.id FROM file, file_join "
+                                            "WHERE file_join.file=file.id "
+                                            "AND file_join.track = ?" );
+    query.bindValue( 0, tid );
     query.exec();
 
     while( query.next() )
@@ -489,11 +529,115 @@ DatabaseImpl::sortname( const QString& str, bool replaceArticle )
 }
 
 
+QStringList
+DatabaseImpl::trigrams( const QString& sortname )
+{
+    // filter words never contain spaces, so neither do the trigrams worth storing
+    QSet< QString > grams;
+    foreach ( const QString& word, sortname.split( " ", QString::SkipEmptyParts ) )
+    {
+        for ( int i = 0; i + 3 <= word.length(); i++ )
+            grams << word.mid( i, 3 );
+    }
+
+    QStringList sl = grams.toList();
+    sl.sort();
+    return sl;
+}
+
+
+void
+DatabaseImpl::indexName( NameKind kind, int id, const QString& sortname )
+{
+    TomahawkSqlQuery query = preparedQuery( "INSERT OR IGNORE INTO name_trigram(trigram,kind,id) VALUES(?,?,?)" );
+    foreach ( const QString& gram, trigrams( sortname ) )
+    {
+        query.bindValue( 0, gram );
+        query.bindValue( 1, (int)kind );
+        query.bindValue( 2, id );
+        query.exec();
+    }
+}
+
+
+void
+DatabaseImpl::rebuildNameIndex()
+{
+    tLog() << "Building name index...";
+    QTime t;
+    t.start();
+
+    TomahawkSqlQuery query = newquery();
+    query.exec( "DELETE FROM name_trigram" );
+
+    QList< QPair< NameKind, QString > > tables;
+    tables << qMakePair( ArtistName, QString( "artist" ) )
+           << qMakePair( AlbumName, QString( "album" ) )
+           << qMakePair( TrackName, QString( "track" ) );
+
+    for ( int i = 0; i < tables.count(); i++ )
+    {
+        query.exec( QString( "SELECT id, sortname FROM %1" ).arg( tables.at( i ).second ) );
+        while ( query.next() )
+            indexName( tables.at( i ).first, query.value( 0 ).toInt(), query.value( 1 ).toString() );
+    }
+
+    tLog() << "Built name index in" << t.elapsed() << "ms";
+}
+
+
+QString
+DatabaseImpl::nameMatchSql( NameKind kind, const QString& word )
+{
+    static const char* tables[] = { 0, "artist", "album", "track" };
+    const QString table = tables[ kind ];
+    const QString like = QString( "%1.sortname LIKE '%%2%'" ).arg( table ).arg( TomahawkUtils::sqlEscape( word ) );
+
+    // too short for a trigram, only a scan of the (much smaller than file_join) name table helps
+    const QStringList grams = trigrams( word );
+    if ( grams.isEmpty() )
+        return QString( "SELECT id FROM %1 WHERE %2" ).arg( table ).arg( like );
+
+    // names that have all of word's trigrams are candidates, LIKE weeds out the ones that have them elsewhere
+    QStringList quoted;
+    foreach ( const QString& gram, grams )
+        quoted << QString( "'%1'" ).arg( TomahawkUtils::sqlEscape( gram ) );
+
+    return QString( "SELECT %1.id FROM %1 WHERE %1.id IN ( "
+                        "SELECT id FROM name_trigram WHERE kind = %2 AND trigram IN ( %3 ) "
+                        "GROUP BY id HAVING COUNT(*) = %4 ) "
+                    "AND %5" )
+              .arg( table )
+              .arg( (int)kind )
+              .arg( quoted.join( "," ) )
+              .arg( grams.count() )
+              .arg( like );
+}
+
+
+QString
+DatabaseImpl::collectionFilterSql( const QString& filter )
+{
+    // same words, same substring matching as the LIKE '%word%' filters this replaces
+    QString sql;
+    foreach ( const QString& word, sortname( filter ).split( " ", QString::SkipEmptyParts ) )
+    {
+        sql += QString( " AND ( file_join.artist IN ( %1 ) OR file_join.album IN ( %2 ) OR file_join.track IN ( %3 ) )" )
+                  .arg( nameMatchSql( ArtistName, word ) )
+                  .arg( nameMatchSql( AlbumName, word ) )
+                  .arg( nameMatchSql( TrackName, word ) );
+    }
+
+    return sql;
+}
+
+
 QVariantMap
 DatabaseImpl::artist( int id )
 {
-    TomahawkSqlQuery query = newquery();
-    query.exec( QString( "SELECT id, name, sortname FROM artist WHERE id = %1" ).arg( id ) );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id, name, sortname FROM artist WHERE id = ?" );
+    query.bindValue( 0, id );
+    query.exec();
 
     QVariantMap m;
     if( !query.next() )
@@ -509,8 +653,9 @@ DatabaseImpl::artist( int id )
 QVariantMap
 DatabaseImpl::track( int id )
 {
-    TomahawkSqlQuery query = newquery();
-    query.exec( QString( "SELECT id, artist, name, sortname FROM track WHERE id = %1" ).arg( id ) );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id, artist, name, sortname FROM track WHERE id = ?" );
+    query.bindValue( 0, id );
+    query.exec();
 
     QVariantMap m;
     if( !query.next() )
@@ -527,8 +672,9 @@ DatabaseImpl::track( int id )
 QVariantMap
 DatabaseImpl::album( int id )
 {
-    TomahawkSqlQuery query = newquery();
-    query.exec( QString( "SELECT id, artist, name, sortname FROM album WHERE id = %1" ).arg( id ) );
+    TomahawkSqlQuery query = preparedQuery( "SELECT id, artist, name, sortname FROM album WHERE id = ?" );
+    query.bindValue( 0, id );
+    query.exec();
 
     QVariantMap m;
     if( !query.next() )
@@ -546,7 +692,6 @@ Tomahawk::result_ptr
 DatabaseImpl::resultFromHint( const Tomahawk::query_ptr& origquery )
 {
     QString url = origquery->resultHint();
-    TomahawkSqlQuery query = newquery();
     Tomahawk::source_ptr s;
     Tomahawk::result_ptr res;
     QString fileUrl;
@@ -610,10 +755,13 @@ DatabaseImpl::resultFromHint( const Tomahawk::query_ptr& origquery )
                             "file_join.file = file.id AND "
                             "file.id = track_attributes.id AND "
                             "file.url = ?"
-        ).arg( searchlocal ? "IS NULL" : QString( "= %1" ).arg( s->id() ) );
+        ).arg( searchlocal ? "IS NULL" : "= ?" );
 
-    query.prepare( sql );
-    query.bindValue( 0, fileUrl );
+    TomahawkSqlQuery query = preparedQuery( sql );
+    int i = 0;
+    if ( !searchlocal )
+        query.bindValue( i++, s->id() );
+    query.bindValue( i, fileUrl );
     query.exec();
 
     if( query.next() )
@@ -643,6 +791,7 @@ DatabaseImpl::resultFromHint( const Tomahawk::query_ptr& origquery )
 
         res->setModificationTime( query.value( 1 ).toUInt() );
         res->setSize( query.value( 2 ).toUInt() );
+        res->setHash( query.value( 3 ).toString() );
         res->setMimetype( query.value( 4 ).toString() );
         res->setDuration( query.value( 5 ).toInt() );
         res->setBitrate( query.value( 6 ).toInt() );
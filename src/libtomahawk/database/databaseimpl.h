@@ -28,6 +28,7 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QHash>
+#include <QMutex>
 #include <QThread>
 
 #include "tomahawksqlquery.h"
@@ -50,6 +51,13 @@ public:
     bool openDatabase( const QString& dbname );
 
     TomahawkSqlQuery newquery() { return TomahawkSqlQuery( m_db ); }
+
+    // Returns sql prepared once per calling thread and reused on subsequent calls.
+    // Bind all values again before exec(), and don't hold on to the query while
+    // asking for the same statement again, as both share the same handle.
+    TomahawkSqlQuery preparedQuery( const QString& sql );
+    int statementCacheHits() const { return m_statementCacheHits; }
+    int statementCacheMisses() const { return m_statementCacheMisses; }
     QSqlDatabase& database() { return m_db; }
 
     int artistId( const QString& name_orig, bool autoCreate ); //also for composers!
@@ -62,6 +70,17 @@ public:
 
     static QString sortname( const QString& str, bool replaceArticle = false );
 
+    /*
+        Trigram index over the sortnames of all artists, albums and tracks, so the
+        collection filters don't have to LIKE-scan the whole file_join on every keystroke.
+        Names are indexed as they are created; they are never deleted, so neither are their trigrams.
+     */
+    enum NameKind { ArtistName = 1, AlbumName = 2, TrackName = 3 };
+    void indexName( NameKind kind, int id, const QString& sortname );
+    void rebuildNameIndex();
+    // " AND ..." restricting file_join to rows whose artist, album or track name contains every word of filter
+    static QString collectionFilterSql( const QString& filter );
+
     QVariantMap artist( int id );
     QVariantMap album( int id );
     QVariantMap track( int id );
@@ -84,6 +103,9 @@ private slots:
     void updateIndex();
 
 private:
+    static QStringList trigrams( const QString& sortname );
+    static QString nameMatchSql( NameKind kind, const QString& word );
+
     QString cleanSql( const QString& sql );
     bool updateSchema( int oldVersion );
     void dumpDatabase();
@@ -96,6 +118,12 @@ private:
 
     QString m_dbid;
     FuzzyIndex* m_fuzzyIndex;
+
+    // prepared statements can't be shared between the database worker threads
+    QHash< QThread*, QHash< QString, TomahawkSqlQuery > > m_statements;
+    QMutex m_statementsMutex;
+    QAtomicInt m_statementCacheHits;
+    QAtomicInt m_statementCacheMisses;
 };
 
 #endif // DATABASEIMPL_H
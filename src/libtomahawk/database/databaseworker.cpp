@@ -28,6 +28,7 @@
 #include "databasecommandloggable.h"
 #include "tomahawksqlquery.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 #ifndef QT_NO_DEBUG
     //#define DEBUG_TIMING TRUE
@@ -77,6 +78,8 @@ DatabaseWorker::enqueue( const QList< QSharedPointer<DatabaseCommand> >& cmds )
 {
     QMutexLocker lock( &m_mut );
     m_outstanding += cmds.count();
+    foreach ( const QSharedPointer<DatabaseCommand>& cmd, cmds )
+        cmd->setQueued();
     m_commands << cmds;
 
     if ( m_outstanding == cmds.count() )
@@ -89,6 +92,7 @@ DatabaseWorker::enqueue( const QSharedPointer<DatabaseCommand>& cmd )
 {
     QMutexLocker lock( &m_mut );
     m_outstanding++;
+    cmd->setQueued();
     m_commands << cmd;
 
     if ( m_outstanding == 1 )
@@ -134,7 +138,12 @@ DatabaseWorker::doWork()
             while ( !finished )
             {
                 completed++;
+                Metrics::instance()->addTiming( "database.queue." + cmd->commandname(), cmd->queueTime() );
+
+                QTime execTimer;
+                execTimer.start();
                 cmd->_exec( m_dbimpl ); // runs actual SQL stuff
+                Metrics::instance()->addTiming( "database.exec." + cmd->commandname(), execTimer.elapsed() );
 
                 if ( cmd->loggable() )
                 {
@@ -219,6 +228,7 @@ DatabaseWorker::doWork()
                  << m_dbimpl->database().lastError().databaseText()
                  << m_dbimpl->database().lastError().driverText()
                  << endl;
+        Metrics::instance()->increment( "database.errors" );
 
         if ( cmd->doesMutates() )
             m_dbimpl->database().rollback();
@@ -238,6 +248,10 @@ DatabaseWorker::doWork()
     foreach ( QSharedPointer<DatabaseCommand> c, cmdGroup )
         c->emitFinished();
 
+    Metrics::instance()->increment( "database.commands", completed );
+    Metrics::instance()->setGauge( "database.statementcache.hits", m_dbimpl->statementCacheHits() );
+    Metrics::instance()->setGauge( "database.statementcache.misses", m_dbimpl->statementCacheMisses() );
+
     QMutexLocker lock( &m_mut );
     m_outstanding -= completed;
     if ( m_outstanding > 0 )
@@ -42,6 +42,17 @@ CREATE TABLE IF NOT EXISTS album (
 CREATE UNIQUE INDEX album_artist_sortname ON album(artist,sortname);
 
 
+-- Trigrams of artist (kind 1), album (kind 2) and track (kind 3) sortnames,
+-- used to filter collections without scanning every name.
+
+CREATE TABLE IF NOT EXISTS name_trigram (
+    trigram TEXT NOT NULL,
+    kind INTEGER NOT NULL,
+    id INTEGER NOT NULL
+);
+CREATE UNIQUE INDEX name_trigram_uniq ON name_trigram(trigram,kind,id);
+
+
 
 -- Source, typically a remote peer.
 
@@ -50,6 +61,8 @@ CREATE TABLE IF NOT EXISTS source (
     name TEXT NOT NULL,
     friendlyname TEXT,
     lastop TEXT NOT NULL DEFAULT "",       -- guid of last op we've successfully applied
+    peerlastop TEXT NOT NULL DEFAULT "",   -- guid of our last op the peer has fetched
+    lastseen INTEGER NOT NULL DEFAULT 0,   -- unix time we last heard from the peer
     isonline BOOLEAN NOT NULL DEFAULT false
 );
 CREATE UNIQUE INDEX source_name ON source(name);
@@ -163,6 +176,7 @@ CREATE TABLE IF NOT EXISTS file (
 CREATE UNIQUE INDEX file_url_src_uniq ON file(source, url);
 CREATE INDEX file_source ON file(source);
 CREATE INDEX file_mtime ON file(mtime);
+CREATE INDEX file_md5 ON file(md5);
 
 -- mtime of dir when last scanned.
 -- load into memory when rescanning, skip stuff that's unchanged
@@ -272,6 +286,44 @@ CREATE TABLE IF NOT EXISTS playback_log (
 
 CREATE INDEX playback_log_source ON playback_log(source);
 CREATE INDEX playback_log_track ON playback_log(track);
+CREATE INDEX playback_log_playtime ON playback_log(playtime);
+CREATE INDEX playback_log_source_playtime ON playback_log(source, playtime);
+
+
+-- aggregated playback statistics, kept up to date by DatabaseCommand_LogPlayback
+-- so charts don't have to scan playback_log. source=null means local again.
+
+CREATE TABLE IF NOT EXISTS playback_stats_track (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0,
+    secs_played INTEGER NOT NULL DEFAULT 0,
+    last_played INTEGER NOT NULL
+);
+CREATE INDEX playback_stats_track_source ON playback_stats_track(source, track);
+CREATE INDEX playback_stats_track_plays ON playback_stats_track(plays);
+
+CREATE TABLE IF NOT EXISTS playback_stats_artist (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0,
+    secs_played INTEGER NOT NULL DEFAULT 0,
+    last_played INTEGER NOT NULL
+);
+CREATE INDEX playback_stats_artist_source ON playback_stats_artist(source, artist);
+CREATE INDEX playback_stats_artist_plays ON playback_stats_artist(plays);
+
+-- plays per track and day (playtime / 86400)
+CREATE TABLE IF NOT EXISTS playback_stats_day (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    day INTEGER NOT NULL,
+    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    plays INTEGER NOT NULL DEFAULT 0
+);
+CREATE INDEX playback_stats_day_source ON playback_stats_day(source, day, track);
+CREATE INDEX playback_stats_day_day ON playback_stats_day(day);
 
 
 
@@ -295,4 +347,4 @@ CREATE TABLE IF NOT EXISTS settings (
     v TEXT NOT NULL DEFAULT ''
 );
 
-INSERT INTO settings(k,v) VALUES('schema_version', '28');
+INSERT INTO settings(k,v) VALUES('schema_version', '33');
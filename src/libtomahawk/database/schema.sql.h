@@ -1,5 +1,5 @@
 /*
-    This file was automatically generated from ./schema.sql on Fri Nov 18 14:00:37 CET 2011.
+    This file was automatically generated from ./schema.sql on Sun Oct 18 14:35:26 UTC 2026.
 */
 
 static const char * tomahawk_schema_sql = 
@@ -34,11 +34,19 @@ static const char * tomahawk_schema_sql =
 "    sortname TEXT NOT NULL"
 ");"
 "CREATE UNIQUE INDEX album_artist_sortname ON album(artist,sortname);"
+"CREATE TABLE IF NOT EXISTS name_trigram ("
+"    trigram TEXT NOT NULL,"
+"    kind INTEGER NOT NULL,"
+"    id INTEGER NOT NULL"
+");"
+"CREATE UNIQUE INDEX name_trigram_uniq ON name_trigram(trigram,kind,id);"
 "CREATE TABLE IF NOT EXISTS source ("
 "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
 "    name TEXT NOT NULL,"
 "    friendlyname TEXT,"
 "    lastop TEXT NOT NULL DEFAULT \"\",       "
+"    peerlastop TEXT NOT NULL DEFAULT \"\",   "
+"    lastseen INTEGER NOT NULL DEFAULT 0,   "
 "    isonline BOOLEAN NOT NULL DEFAULT false"
 ");"
 "CREATE UNIQUE INDEX source_name ON source(name);"
@@ -107,6 +115,8 @@ static const char * tomahawk_schema_sql =
 ");"
 "CREATE UNIQUE INDEX file_url_src_uniq ON file(source, url);"
 "CREATE INDEX file_source ON file(source);"
+"CREATE INDEX file_mtime ON file(mtime);"
+"CREATE INDEX file_md5 ON file(md5);"
 "CREATE TABLE IF NOT EXISTS dirs_scanned ("
 "    name TEXT PRIMARY KEY,"
 "    mtime INTEGER NOT NULL"
@@ -179,6 +189,36 @@ static const char * tomahawk_schema_sql =
 ");"
 "CREATE INDEX playback_log_source ON playback_log(source);"
 "CREATE INDEX playback_log_track ON playback_log(track);"
+"CREATE INDEX playback_log_playtime ON playback_log(playtime);"
+"CREATE INDEX playback_log_source_playtime ON playback_log(source, playtime);"
+"CREATE TABLE IF NOT EXISTS playback_stats_track ("
+"    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    plays INTEGER NOT NULL DEFAULT 0,"
+"    secs_played INTEGER NOT NULL DEFAULT 0,"
+"    last_played INTEGER NOT NULL"
+");"
+"CREATE INDEX playback_stats_track_source ON playback_stats_track(source, track);"
+"CREATE INDEX playback_stats_track_plays ON playback_stats_track(plays);"
+"CREATE TABLE IF NOT EXISTS playback_stats_artist ("
+"    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    plays INTEGER NOT NULL DEFAULT 0,"
+"    secs_played INTEGER NOT NULL DEFAULT 0,"
+"    last_played INTEGER NOT NULL"
+");"
+"CREATE INDEX playback_stats_artist_source ON playback_stats_artist(source, artist);"
+"CREATE INDEX playback_stats_artist_plays ON playback_stats_artist(plays);"
+"CREATE TABLE IF NOT EXISTS playback_stats_day ("
+"    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    day INTEGER NOT NULL,"
+"    track INTEGER NOT NULL REFERENCES track(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    artist INTEGER NOT NULL REFERENCES artist(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    plays INTEGER NOT NULL DEFAULT 0"
+");"
+"CREATE INDEX playback_stats_day_source ON playback_stats_day(source, day, track);"
+"CREATE INDEX playback_stats_day_day ON playback_stats_day(day);"
 "CREATE TABLE IF NOT EXISTS http_client_auth ("
 "    token TEXT NOT NULL PRIMARY KEY,"
 "    website TEXT NOT NULL,"
@@ -191,7 +231,7 @@ static const char * tomahawk_schema_sql =
 "    k TEXT NOT NULL PRIMARY KEY,"
 "    v TEXT NOT NULL DEFAULT ''"
 ");"
-"INSERT INTO settings(k,v) VALUES('schema_version', '28');"
+"INSERT INTO settings(k,v) VALUES('schema_version', '33');"
     ;
 
 const char * get_tomahawk_sql()
@@ -0,0 +1,81 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tomahawksqlquery.h"
+
+#include <QMutex>
+#include <QRegExp>
+
+static QMutex s_statisticsMutex;
+static QHash< QString, TomahawkSqlQuery::Statistics > s_statistics;
+
+
+QHash< QString, TomahawkSqlQuery::Statistics >
+TomahawkSqlQuery::statistics()
+{
+    QMutexLocker lock( &s_statisticsMutex );
+    return s_statistics;
+}
+
+
+QString
+TomahawkSqlQuery::normalized( const QString& sql )
+{
+    // statements built with QString::arg() differ only in their literals, count them as one
+    QString key = sql;
+    key.replace( QRegExp( "'([^']|'')*'" ), "?" );
+    key.replace( QRegExp( "\"[^\"]*\"" ), "?" );
+    key.replace( QRegExp( "\\b\\d+(\\.\\d+)?\\b" ), "?" );
+    key.replace( QRegExp( "\\(\\s*\\?(\\s*,\\s*\\?)*\\s*\\)" ), "( ? )" );
+
+    return key;
+}
+
+
+void
+TomahawkSqlQuery::recordTiming( const QString& sql, int elapsed )
+{
+    const QString key = normalized( sql );
+
+    QMutexLocker lock( &s_statisticsMutex );
+
+    QHash< QString, Statistics >::iterator it = s_statistics.find( key );
+    if ( it == s_statistics.end() )
+    {
+        if ( s_statistics.count() >= TOMAHAWK_QUERY_STATISTICS_SIZE )
+        {
+            // make room by dropping the statement that ran the least
+            QHash< QString, Statistics >::iterator least = s_statistics.begin();
+            for ( QHash< QString, Statistics >::iterator i = s_statistics.begin(); i != s_statistics.end(); ++i )
+            {
+                if ( i.value().count < least.value().count )
+                    least = i;
+            }
+            s_statistics.erase( least );
+        }
+
+        it = s_statistics.insert( key, Statistics() );
+    }
+
+    Statistics& stats = it.value();
+    stats.count++;
+    stats.totalTime += elapsed;
+    stats.maxTime = qMax( stats.maxTime, elapsed );
+    if ( elapsed >= TOMAHAWK_QUERY_THRESHOLD )
+        stats.slow++;
+}
@@ -22,16 +22,28 @@
 
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QHash>
 #include <QTime>
 
 #include "utils/logger.h"
+#include "dllmacro.h"
 
 #define TOMAHAWK_QUERY_THRESHOLD 60
+#define TOMAHAWK_QUERY_STATISTICS_SIZE 250
 
-class TomahawkSqlQuery : public QSqlQuery
+class DLLEXPORT TomahawkSqlQuery : public QSqlQuery
 {
 
 public:
+    struct Statistics
+    {
+        Statistics() : count( 0 ), slow( 0 ), totalTime( 0 ), maxTime( 0 ) {}
+
+        quint64 count;
+        quint64 slow; // took longer than TOMAHAWK_QUERY_THRESHOLD
+        quint64 totalTime;
+        int maxTime;
+    };
 
     TomahawkSqlQuery()
         : QSqlQuery()
@@ -58,13 +70,21 @@ public:
             showError();
 
         int e = t.elapsed();
+        recordTiming( lastQuery(), e );
         if ( e >= TOMAHAWK_QUERY_THRESHOLD )
-            tLog( LOGVERBOSE ) << "TomahawkSqlQuery (" << lastQuery() << ") finished in" << t.elapsed() << "ms";
+            tLog( LOGVERBOSE ) << "TomahawkSqlQuery (" << lastQuery() << ") finished in" << e << "ms";
 
         return ret;
     }
 
+    /// execution counts and timings, keyed by statement with its literals replaced by '?'.
+    /// Up to TOMAHAWK_QUERY_STATISTICS_SIZE statements are tracked, the least run one makes room for a new one.
+    static QHash< QString, Statistics > statistics();
+
 private:
+    static void recordTiming( const QString& sql, int elapsed );
+    static QString normalized( const QString& sql );
+
     void showError()
     {
         tLog() << "\n" << "*** DATABASE ERROR ***" << "\n"
@@ -18,6 +18,7 @@
 
 #include "RoviPlugin.h"
 
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 
 #include <QDateTime>
@@ -80,7 +81,7 @@ RoviPlugin::notInCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria, Tomah
             baseUrl.addQueryItem( "entitytype", "album" );
             baseUrl.addQueryItem( "include", "album:tracks" );
 
-            QNetworkReply* reply = makeRequest( baseUrl );
+            QNetworkReply* reply = makeRequest( baseUrl, requestData );
 
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
             connect( reply, SIGNAL( finished() ), this, SLOT( albumLookupFinished() ) );
@@ -171,13 +172,13 @@ RoviPlugin::albumLookupFinished()
 
 
 QNetworkReply*
-RoviPlugin::makeRequest( QUrl url )
+RoviPlugin::makeRequest( QUrl url, const Tomahawk::InfoSystem::InfoRequestData& requestData )
 {
     url.addQueryItem( "apikey", m_apiKey );
     url.addEncodedQueryItem( "sig", generateSig() );
 
     qDebug() << "Rovi request url:" << url.toString();
-    return TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    return NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
 }
 
 
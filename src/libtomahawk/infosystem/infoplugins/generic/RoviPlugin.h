@@ -50,7 +50,7 @@ private slots:
     void albumLookupFinished();
     void albumLookupError( QNetworkReply::NetworkError );
 private:
-    QNetworkReply* makeRequest( QUrl url );
+    QNetworkReply* makeRequest( QUrl url, const Tomahawk::InfoSystem::InfoRequestData& requestData );
     QByteArray generateSig() const;
 
     QByteArray m_apiKey;
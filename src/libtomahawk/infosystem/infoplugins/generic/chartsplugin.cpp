@@ -30,6 +30,7 @@
 #include "audio/audioengine.h"
 #include "tomahawksettings.h"
 #include "utils/tomahawkutils.h"
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 
 #define CHART_URL "http://charts.tomahawk-player.org/"
@@ -172,7 +173,7 @@ ChartsPlugin::notInCacheSlot( QHash<QString, QString> criteria, Tomahawk::InfoSy
             QUrl url = QUrl( QString( CHART_URL "source/%1/chart/%2" ).arg( criteria["chart_source"] ).arg( criteria["chart_id"] ) );
             tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Getting chart url" << url;
 
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
             connect( reply, SIGNAL( finished() ), SLOT( chartReturned() ) );
@@ -196,7 +197,7 @@ ChartsPlugin::notInCacheSlot( QHash<QString, QString> criteria, Tomahawk::InfoSy
                 foreach ( QString resource, m_chartResources )
                 {
                     QUrl url = QUrl( QString( CHART_URL "source/%1" ).arg( resource ) );
-                    QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+                    QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
                     reply->setProperty( "chart_resource", resource);
 
                     tDebug() << "fetching:" << url;
@@ -28,6 +28,7 @@
 #include "typedefs.h"
 #include "tomahawksettings.h"
 #include "utils/tomahawkutils.h"
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 
 #define HYPEM_URL "http://hypem.com/playlist/"
@@ -191,7 +192,7 @@ hypemPlugin::notInCacheSlot( QHash<QString, QString> criteria, Tomahawk::InfoSys
             QUrl url = QUrl( QString( HYPEM_URL "%1/%2" ).arg( criteria["chart_id"].toLower() ).arg(HYPEM_END_URL) );
             qDebug() << Q_FUNC_INFO << "Getting chart url" << url;
 
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
             connect( reply, SIGNAL( finished() ), SLOT( chartReturned() ) );
             return;
@@ -22,6 +22,7 @@
 #include <QDomDocument>
 
 #include "utils/tomahawkutils.h"
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk::InfoSystem;
@@ -98,7 +99,7 @@ MusicBrainzPlugin::notInCacheSlot( InfoStringHash criteria, InfoRequestData requ
             QString requestString( "http://musicbrainz.org/ws/2/artist" );
             QUrl url( requestString );
             url.addQueryItem( "query", criteria["artist"] );
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
             connect( reply, SIGNAL( finished() ), SLOT( artistSearchSlot() ) );
@@ -110,7 +111,7 @@ MusicBrainzPlugin::notInCacheSlot( InfoStringHash criteria, InfoRequestData requ
             QString requestString( "http://musicbrainz.org/ws/2/artist" );
             QUrl url( requestString );
             url.addQueryItem( "query", criteria["artist"] );
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
             connect( reply, SIGNAL( finished() ), SLOT( albumSearchSlot() ) );
@@ -174,7 +175,7 @@ MusicBrainzPlugin::artistSearchSlot()
     QUrl url( requestString );
     url.addQueryItem( "artist", artist_id );
 
-    QNetworkReply* newReply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    QNetworkReply* newReply = NetworkScheduler::instance()->get( QNetworkRequest( url ), oldReply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
     newReply->setProperty( "requestData", oldReply->property( "requestData" ) );
     connect( newReply, SIGNAL( finished() ), SLOT( albumFoundSlot() ) );
 }
@@ -201,7 +202,7 @@ MusicBrainzPlugin::albumSearchSlot()
     QUrl url( requestString );
     url.addQueryItem( "artist", artist_id );
 
-    QNetworkReply* newReply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    QNetworkReply* newReply = NetworkScheduler::instance()->get( QNetworkRequest( url ), oldReply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
     newReply->setProperty( "requestData", oldReply->property( "requestData" ) );
     connect( newReply, SIGNAL( finished() ), SLOT( tracksSearchSlot() ) );
 }
@@ -244,7 +245,7 @@ MusicBrainzPlugin::tracksSearchSlot()
     QString requestString = QString( "http://musicbrainz.org/ws/2/release/%1?inc=recordings" ).arg( release_id );
     QUrl url( requestString );
 
-    QNetworkReply* newReply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    QNetworkReply* newReply = NetworkScheduler::instance()->get( QNetworkRequest( url ), oldReply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
     newReply->setProperty( "requestData", oldReply->property( "requestData" ) );
     connect( newReply, SIGNAL( finished() ), SLOT( tracksFoundSlot() ) );
 }
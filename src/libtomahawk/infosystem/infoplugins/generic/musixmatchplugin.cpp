@@ -22,6 +22,7 @@
 #include <QDomDocument>
 
 #include "utils/tomahawkutils.h"
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk::InfoSystem;
@@ -62,7 +63,7 @@ MusixMatchPlugin::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
     url.addQueryItem( "apikey", m_apiKey );
     url.addQueryItem( "q_artist", artist );
     url.addQueryItem( "q_track", track );
-    QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
     reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
 
     connect( reply, SIGNAL( finished() ), SLOT( trackSearchSlot() ) );
@@ -116,7 +117,7 @@ MusixMatchPlugin::trackSearchSlot()
     QUrl url( requestString );
     url.addQueryItem( "apikey", m_apiKey );
     url.addQueryItem( "track_id", track_id );
-    QNetworkReply* newReply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+    QNetworkReply* newReply = NetworkScheduler::instance()->get( QNetworkRequest( url ), oldReply->property( "requestData" ).value< Tomahawk::InfoSystem::InfoRequestData >() );
     newReply->setProperty( "requestData", oldReply->property( "requestData" ) );
     connect( newReply, SIGNAL( finished() ), SLOT( trackLyricsSlot() ) );
 }
@@ -29,6 +29,7 @@
 #include "audio/audioengine.h"
 #include "tomahawksettings.h"
 #include "utils/tomahawkutils.h"
+#include "infosystem/networkscheduler.h"
 #include "utils/logger.h"
 #include "chartsplugin_data_p.h"
 
@@ -145,7 +146,7 @@ SpotifyPlugin::notInCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria, To
             QUrl url = QUrl( QString( SPOTIFY_API_URL "toplist/%1/" ).arg( criteria["chart_id"] ) );
             qDebug() << Q_FUNC_INFO << "Getting chart url" << url;
 
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             reply->setProperty( "requestData", QVariant::fromValue< Tomahawk::InfoSystem::InfoRequestData >( requestData ) );
             connect( reply, SIGNAL( finished() ), SLOT( chartReturned() ) );
             return;
@@ -162,7 +163,7 @@ SpotifyPlugin::notInCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria, To
             tDebug() << "SpotifyPlugin: InfoChart fetching possible resources";
 
             QUrl url = QUrl( QString( SPOTIFY_API_URL "toplist/charts" )  );
-            QNetworkReply* reply = TomahawkUtils::nam()->get( QNetworkRequest( url ) );
+            QNetworkReply* reply = NetworkScheduler::instance()->get( QNetworkRequest( url ), requestData );
             tDebug() << Q_FUNC_INFO << "fetching:" << url;
             connect( reply, SIGNAL( finished() ), SLOT( chartTypes() ) );
             m_chartsFetchJobs++;
@@ -202,6 +202,16 @@ InfoSystem::pushInfo( const QString &caller, const InfoTypeMap &input )
 }
 
 
+void
+InfoSystem::cancelRequests( const QString &caller )
+{
+    if ( !m_inited || !m_infoSystemWorkerThreadController->worker() )
+        return;
+
+    QMetaObject::invokeMethod( m_infoSystemWorkerThreadController->worker(), "cancelRequests", Qt::QueuedConnection, Q_ARG( QString, caller ) );
+}
+
+
 void
 InfoSystem::addInfoPlugin( InfoPlugin* plugin )
 {
@@ -125,6 +125,13 @@ enum InfoType { // as items are saved in cache, mark them here to not change the
     InfoLastInfo = 101 //WARNING: *ALWAYS* keep this last!
 };
 
+// how urgently a request's outbound fetches are scheduled, lower goes first
+enum InfoPriority {
+    InfoPriorityNowPlaying = 0,
+    InfoPriorityVisible = 1,
+    InfoPriorityBackground = 2
+};
+
 struct InfoRequestData {
     quint64 requestId;
     quint64 internalId; //do not assign to this; it may get overwritten by the InfoSystem
@@ -134,6 +141,7 @@ struct InfoRequestData {
     QVariantMap customData;
     uint timeoutMillis;
     bool allSources;
+    Tomahawk::InfoSystem::InfoPriority priority;
 
     InfoRequestData()
         : requestId( TomahawkUtils::infosystemRequestId() )
@@ -144,6 +152,7 @@ struct InfoRequestData {
         , customData( QVariantMap() )
         , timeoutMillis( 10000 )
         , allSources( false )
+        , priority( InfoPriorityVisible )
         {}
 
     InfoRequestData( const quint64 rId, const QString &callr, const Tomahawk::InfoSystem::InfoType typ, const QVariant &inputvar, const QVariantMap &custom )
@@ -155,6 +164,7 @@ struct InfoRequestData {
         , customData( custom )
         , timeoutMillis( 10000 )
         , allSources( false )
+        , priority( InfoPriorityVisible )
         {}
 };
 
@@ -242,6 +252,9 @@ public:
     bool pushInfo( const QString &caller, const InfoType type, const QVariant &input );
     bool pushInfo( const QString &caller, const InfoTypeMap &input );
 
+    // drops all pending requests of caller, e.g. when the view that asked goes away
+    void cancelRequests( const QString &caller );
+
 public slots:
     // InfoSystem takes ownership of InfoPlugins
     void addInfoPlugin( Tomahawk::InfoSystem::InfoPlugin* plugin );
@@ -29,6 +29,7 @@
 #include "infosystemcache.h"
 #include "tomahawksettings.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 
 namespace Tomahawk
@@ -210,10 +211,12 @@ InfoSystemCache::getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteri
         QVariant output = cachedSettings.value( "data" );
         m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
+        Metrics::instance()->increment( "infosystem.cache.hits.disk" );
         emit info( requestData, output );
     }
     else
     {
+        Metrics::instance()->increment( "infosystem.cache.hits.memory" );
         emit info( requestData, QVariant( *( m_dataCache[ criteriaHashValWithType ] ) ) );
     }
 }
@@ -222,6 +225,7 @@ InfoSystemCache::getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteri
 void
 InfoSystemCache::notInCache( QObject *receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData )
 {
+    Metrics::instance()->increment( "infosystem.cache.misses" );
     QMetaObject::invokeMethod( receiver, "notInCacheSlot", Q_ARG( Tomahawk::InfoSystem::InfoStringHash, criteria ), Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
 }
 
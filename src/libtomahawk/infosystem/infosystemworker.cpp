@@ -24,6 +24,7 @@
 #include "config.h"
 #include "infosystemworker.h"
 #include "infosystemcache.h"
+#include "networkscheduler.h"
 #include "infoplugins/generic/echonestplugin.h"
 #include "infoplugins/generic/musixmatchplugin.h"
 #include "infoplugins/generic/chartsplugin.h"
@@ -32,6 +33,7 @@
 #include "infoplugins/generic/hypemPlugin.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 #ifdef Q_WS_MAC
 #include "infoplugins/mac/adiumplugin.h"
@@ -78,6 +80,7 @@ InfoSystemWorker::init( Tomahawk::InfoSystem::InfoSystemCache* cache )
 {
     tDebug() << Q_FUNC_INFO;
     m_cache = cache;
+    new NetworkScheduler( this );
 #ifndef ENABLE_HEADLESS
     addInfoPlugin( new EchoNestPlugin() );
     addInfoPlugin( new MusixMatchPlugin() );
@@ -156,6 +159,7 @@ void
 InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
 {
     //qDebug() << Q_FUNC_INFO << "type is " << requestData.type << " and allSources = " << (allSources ? "true" : "false" );
+    Metrics::instance()->increment( "infosystem.requests" );
 
     QList< InfoPluginPtr > providers = determineOrderedMatches( requestData.type );
     if ( providers.isEmpty() )
@@ -168,6 +172,17 @@ InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
     if ( !requestData.allSources )
         providers = QList< InfoPluginPtr >( providers.mid( 0, 1 ) );
 
+    const QString key = requestData.allSources ? QString() : requestKey( requestData );
+    if ( !key.isEmpty() && m_inFlightMap.contains( key ) )
+    {
+        // the very same request is already being answered, just wait for that answer
+        requestData.internalId = TomahawkUtils::infosystemRequestId();
+        m_waitingMap[ m_inFlightMap.value( key ) ] << requestData;
+        Metrics::instance()->increment( "infosystem.requests.coalesced" );
+        m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] + 1;
+        return;
+    }
+
     bool foundOne = false;
     foreach ( InfoPluginPtr ptr, providers )
     {
@@ -203,6 +218,9 @@ InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
         data->customData = requestData.customData;
         m_savedRequestMap[ requestId ] = data;
 
+        if ( !key.isEmpty() )
+            m_inFlightMap[ key ] = requestId;
+
         QMetaObject::invokeMethod( ptr.data(), "getInfo", Qt::QueuedConnection, Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
     }
 
@@ -227,6 +245,44 @@ InfoSystemWorker::pushInfo( QString caller, Tomahawk::InfoSystem::InfoType type,
 }
 
 
+void
+InfoSystemWorker::cancelRequests( QString caller )
+{
+    // drop the caller from every coalesced request it was waiting on
+    foreach ( quint64 requestId, m_waitingMap.keys() )
+    {
+        QList< InfoRequestData >& waiting = m_waitingMap[ requestId ];
+        for ( int i = waiting.count() - 1; i >= 0; i-- )
+        {
+            if ( waiting.at( i ).caller == caller )
+                waiting.removeAt( i );
+        }
+    }
+
+    // requests the caller sent to a plugin itself are still answered for others waiting on them
+    foreach ( quint64 requestId, m_savedRequestMap.keys() )
+    {
+        InfoRequestData* data = m_savedRequestMap.value( requestId );
+        if ( data->caller != caller || m_requestSatisfiedMap.value( requestId, true ) )
+            continue;
+
+        if ( !m_waitingMap.value( requestId ).isEmpty() )
+        {
+            m_cancelledRequests << requestId;
+            continue;
+        }
+
+        m_requestSatisfiedMap[ requestId ] = true;
+        m_inFlightMap.remove( requestKey( *data ) );
+        m_waitingMap.remove( requestId );
+        delete data;
+        m_savedRequestMap.remove( requestId );
+    }
+
+    m_dataTracker.remove( caller );
+}
+
+
 void
 InfoSystemWorker::infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
 {
@@ -234,25 +290,76 @@ InfoSystemWorker::infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, Q
 
     quint64 requestId = requestData.internalId;
 
-    if ( m_dataTracker[ requestData.caller ][ requestData.type ] == 0 )
+    if ( !m_requestSatisfiedMap.contains( requestId ) || m_requestSatisfiedMap[ requestId ] )
     {
-//        qDebug() << Q_FUNC_INFO << "Caller was not waiting for that type of data!";
+//        qDebug() << Q_FUNC_INFO << "Request was already taken care of!";
         return;
     }
-    if ( !m_requestSatisfiedMap.contains( requestId ) || m_requestSatisfiedMap[ requestId ] )
+
+    const bool cancelled = m_cancelledRequests.remove( requestId );
+    if ( !cancelled && m_dataTracker[ requestData.caller ][ requestData.type ] == 0 )
     {
-//        qDebug() << Q_FUNC_INFO << "Request was already taken care of!";
+//        qDebug() << Q_FUNC_INFO << "Caller was not waiting for that type of data!";
         return;
     }
 
     m_requestSatisfiedMap[ requestId ] = true;
-    emit info( requestData, output );
+    if ( m_savedRequestMap.contains( requestId ) )
+        m_inFlightMap.remove( requestKey( *m_savedRequestMap[ requestId ] ) );
+
+    if ( !cancelled )
+    {
+        emit info( requestData, output );
+
+        m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] - 1;
+//        qDebug() << "Current count in dataTracker for target" << requestData.caller << "and type" << requestData.type << "is" << m_dataTracker[ requestData.caller ][ requestData.type ];
+    }
 
-    m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] - 1;
-//    qDebug() << "Current count in dataTracker for target" << requestData.caller << "and type" << requestData.type << "is" << m_dataTracker[ requestData.caller ][ requestData.type ];
     delete m_savedRequestMap[ requestId ];
     m_savedRequestMap.remove( requestId );
-    checkFinished( requestData );
+
+    answerWaiting( requestId, output );
+
+    if ( !cancelled )
+        checkFinished( requestData );
+}
+
+
+void
+InfoSystemWorker::answerWaiting( quint64 requestId, const QVariant& output )
+{
+    const QList< InfoRequestData > waiting = m_waitingMap.take( requestId );
+    foreach ( const InfoRequestData& requestData, waiting )
+    {
+        emit info( requestData, output );
+
+        m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] - 1;
+        checkFinished( requestData );
+    }
+}
+
+
+QString
+InfoSystemWorker::requestKey( const Tomahawk::InfoSystem::InfoRequestData& requestData ) const
+{
+    QString key;
+    if ( requestData.input.canConvert< Tomahawk::InfoSystem::InfoStringHash >() )
+    {
+        const InfoStringHash hash = requestData.input.value< Tomahawk::InfoSystem::InfoStringHash >();
+        QStringList keys = hash.keys();
+        keys.sort();
+        foreach ( const QString& k, keys )
+            key += k + '=' + hash.value( k ) + '\t';
+    }
+    else if ( requestData.customData.isEmpty() && requestData.input.canConvert( QVariant::String ) )
+    {
+        // some plugins read customData for plain inputs, only coalesce when there is none
+        key = requestData.input.toString();
+    }
+    else
+        return QString();
+
+    return QString( "%1\t%2" ).arg( requestData.type ).arg( key );
 }
 
 
@@ -294,18 +401,22 @@ InfoSystemWorker::checkTimeoutsTimerFired()
                 //doh, timed out
 //                qDebug() << Q_FUNC_INFO << "Doh, timed out for requestId" << requestId;
                 InfoRequestData *savedData = m_savedRequestMap[ requestId ];
+                const bool cancelled = m_cancelledRequests.remove( requestId );
 
                 InfoRequestData returnData;
                 returnData.caller = savedData->caller;
                 returnData.type = savedData->type;
                 returnData.input = savedData->input;
                 returnData.customData = savedData->customData;
-                emit info( returnData, QVariant() );
+                if ( !cancelled )
+                    emit info( returnData, QVariant() );
 
+                m_inFlightMap.remove( requestKey( *savedData ) );
                 delete savedData;
                 m_savedRequestMap.remove( requestId );
 
-                m_dataTracker[ returnData.caller ][ returnData.type ] = m_dataTracker[ returnData.caller ][ returnData.type ] - 1;
+                if ( !cancelled )
+                    m_dataTracker[ returnData.caller ][ returnData.type ] = m_dataTracker[ returnData.caller ][ returnData.type ] - 1;
 //                qDebug() << "Current count in dataTracker for target" << returnData.caller << "is" << m_dataTracker[ returnData.caller ][ returnData.type ];
 
                 m_requestSatisfiedMap[ requestId ] = true;
@@ -313,7 +424,9 @@ InfoSystemWorker::checkTimeoutsTimerFired()
                 if ( !m_timeRequestMapper.count( time ) )
                     m_timeRequestMapper.remove( time );
 
-                checkFinished( returnData );
+                answerWaiting( requestId, QVariant() );
+                if ( !cancelled )
+                    checkFinished( returnData );
             }
             else
             {
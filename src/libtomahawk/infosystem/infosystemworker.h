@@ -59,6 +59,7 @@ public slots:
     void init( Tomahawk::InfoSystem::InfoSystemCache* cache );
     void getInfo( Tomahawk::InfoSystem::InfoRequestData requestData );
     void pushInfo( QString caller, Tomahawk::InfoSystem::InfoType type, QVariant input );
+    void cancelRequests( QString caller );
 
     void infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
 
@@ -72,11 +73,20 @@ private:
     void checkFinished( const Tomahawk::InfoSystem::InfoRequestData &target );
     QList< InfoPluginPtr > determineOrderedMatches( const InfoType type ) const;
 
+    QString requestKey( const Tomahawk::InfoSystem::InfoRequestData &requestData ) const;
+    void answerWaiting( quint64 requestId, const QVariant &output );
+
     QHash< QString, QHash< InfoType, int > > m_dataTracker;
     QMultiMap< qint64, quint64 > m_timeRequestMapper;
     QHash< uint, bool > m_requestSatisfiedMap;
     QHash< uint, InfoRequestData* > m_savedRequestMap;
 
+    // identical requests in flight get coalesced: key -> internalId of the request sent to the plugin,
+    // internalId -> requests from other callers waiting for the same answer
+    QHash< QString, quint64 > m_inFlightMap;
+    QHash< quint64, QList< InfoRequestData > > m_waitingMap;
+    QSet< quint64 > m_cancelledRequests;
+
     // NOTE Cache object lives in a different thread, do not call methods on it directly
     InfoSystemCache* m_cache;
 
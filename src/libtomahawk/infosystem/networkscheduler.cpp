@@ -0,0 +1,378 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "networkscheduler.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QThread>
+
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+
+#define MAX_RETRIES 3
+#define RETRY_BACKOFF 1000          // ms, doubled with every retry unless the server sends Retry-After
+#define VALIDATOR_CACHE_SIZE 8 * 1024 * 1024
+
+namespace Tomahawk
+{
+
+namespace InfoSystem
+{
+
+ScheduledReply::ScheduledReply( const QNetworkRequest& request, InfoPriority priority, QObject* parent )
+    : QNetworkReply( parent )
+    , m_priority( priority )
+    , m_retries( 0 )
+    , m_pos( 0 )
+{
+    setRequest( request );
+    setUrl( request.url() );
+    setOperation( QNetworkAccessManager::GetOperation );
+    open( QIODevice::ReadOnly | QIODevice::Unbuffered );
+}
+
+
+ScheduledReply::~ScheduledReply()
+{
+    // a request still running is left to finish, the scheduler drops its answer
+}
+
+
+void
+ScheduledReply::abort()
+{
+    if ( isFinished() )
+        return;
+
+    if ( !m_reply.isNull() )
+        m_reply.data()->abort();
+    else
+        fail( QNetworkReply::OperationCanceledError, tr( "Operation canceled" ) );
+}
+
+
+qint64
+ScheduledReply::bytesAvailable() const
+{
+    return m_data.size() - m_pos + QNetworkReply::bytesAvailable();
+}
+
+
+qint64
+ScheduledReply::readData( char* data, qint64 maxSize )
+{
+    if ( m_pos >= m_data.size() )
+        return isFinished() ? -1 : 0;
+
+    const qint64 len = qMin( maxSize, (qint64)m_data.size() - m_pos );
+    memcpy( data, m_data.constData() + m_pos, len );
+    m_pos += len;
+
+    return len;
+}
+
+
+void
+ScheduledReply::complete( QNetworkReply* reply, const QByteArray& body, int statusCode )
+{
+    setUrl( reply->url() );
+    setAttribute( QNetworkRequest::HttpStatusCodeAttribute, statusCode );
+    setAttribute( QNetworkRequest::HttpReasonPhraseAttribute, reply->attribute( QNetworkRequest::HttpReasonPhraseAttribute ) );
+    setAttribute( QNetworkRequest::RedirectionTargetAttribute, reply->attribute( QNetworkRequest::RedirectionTargetAttribute ) );
+
+    foreach ( const QByteArray& header, reply->rawHeaderList() )
+        setRawHeader( header, reply->rawHeader( header ) );
+
+    m_data = body;
+    m_pos = 0;
+
+    emit metaDataChanged();
+    if ( !m_data.isEmpty() )
+        emit readyRead();
+
+    if ( reply->error() != QNetworkReply::NoError && statusCode != 304 )
+    {
+        setError( reply->error(), reply->errorString() );
+        emit error( reply->error() );
+    }
+
+    setFinished( true );
+    emit finished();
+}
+
+
+void
+ScheduledReply::fail( QNetworkReply::NetworkError code, const QString& errorString )
+{
+    setError( code, errorString );
+    emit error( code );
+
+    setFinished( true );
+    emit finished();
+}
+
+
+NetworkScheduler* NetworkScheduler::s_instance = 0;
+
+
+NetworkScheduler*
+NetworkScheduler::instance()
+{
+    return s_instance;
+}
+
+
+NetworkScheduler::NetworkScheduler( QObject* parent )
+    : QObject( parent )
+    , m_validators( VALIDATOR_CACHE_SIZE )
+{
+    s_instance = this;
+
+    m_dispatchTimer.setSingleShot( true );
+    connect( &m_dispatchTimer, SIGNAL( timeout() ), SLOT( dispatch() ) );
+
+    // MusicBrainz allows a single request per second and blocks clients that do more
+    setHostBudget( "musicbrainz.org", 1, 1000 );
+}
+
+
+NetworkScheduler::~NetworkScheduler()
+{
+    s_instance = 0;
+}
+
+
+void
+NetworkScheduler::setHostBudget( const QString& host, int maxConcurrent, int minInterval )
+{
+    Host& h = m_hosts[ host.toLower() ];
+    h.maxConcurrent = qMax( 1, maxConcurrent );
+    h.minInterval = qMax( 0, minInterval );
+}
+
+
+QNetworkReply*
+NetworkScheduler::get( const QNetworkRequest& request, const Tomahawk::InfoSystem::InfoRequestData& requestData )
+{
+    return get( request, requestData.priority );
+}
+
+
+QNetworkReply*
+NetworkScheduler::get( const QNetworkRequest& request, InfoPriority priority )
+{
+    if ( QThread::currentThread() != thread() )
+    {
+        // plugins living outside the info system thread, like the account ones, get a reply
+        // that belongs to our thread. its signals reach them queued
+        ScheduledReply* reply = new ScheduledReply( request, priority );
+        reply->moveToThread( thread() );
+        QMetaObject::invokeMethod( this, "adopt", Qt::QueuedConnection, Q_ARG( QObject*, reply ) );
+        return reply;
+    }
+
+    ScheduledReply* reply = new ScheduledReply( request, priority, this );
+    adopt( reply );
+    return reply;
+}
+
+
+void
+NetworkScheduler::adopt( QObject* object )
+{
+    ScheduledReply* reply = static_cast< ScheduledReply* >( object );
+    reply->setParent( this );
+    connect( reply, SIGNAL( destroyed( QObject* ) ), SLOT( onScheduledReplyDestroyed( QObject* ) ) );
+
+    enqueue( reply );
+}
+
+
+void
+NetworkScheduler::enqueue( ScheduledReply* reply, bool front )
+{
+    if ( front )
+        m_queues[ reply->priority() ].prepend( reply );
+    else
+        m_queues[ reply->priority() ].append( reply );
+
+    if ( !m_dispatchTimer.isActive() || m_dispatchTimer.interval() > 0 )
+        m_dispatchTimer.start( 0 );
+}
+
+
+NetworkScheduler::Host&
+NetworkScheduler::host( const QUrl& url )
+{
+    QString name = url.host().toLower();
+
+    // budgets are per domain, so ws.example.com shares the one of example.com
+    if ( !m_hosts.contains( name ) )
+    {
+        foreach ( const QString& h, m_hosts.keys() )
+        {
+            if ( name.endsWith( "." + h ) )
+                return m_hosts[ h ];
+        }
+    }
+
+    return m_hosts[ name ];
+}
+
+
+void
+NetworkScheduler::dispatch()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 nextCheck = -1;
+
+    for ( int prio = InfoPriorityNowPlaying; prio <= InfoPriorityBackground; prio++ )
+    {
+        QList< ScheduledReply* >& queue = m_queues[ prio ];
+        for ( int i = 0; i < queue.count(); )
+        {
+            ScheduledReply* reply = queue.at( i );
+            Host& h = host( reply->url() );
+
+            qint64 readyAt = qMax( h.blockedUntil, h.lastStarted + h.minInterval );
+            if ( h.active >= h.maxConcurrent )
+            {
+                i++;
+                continue;
+            }
+            if ( readyAt > now )
+            {
+                if ( nextCheck < 0 || readyAt < nextCheck )
+                    nextCheck = readyAt;
+
+                i++;
+                continue;
+            }
+
+            queue.removeAt( i );
+            h.active++;
+            h.lastStarted = now;
+            start( reply );
+        }
+    }
+
+    if ( nextCheck > 0 )
+        m_dispatchTimer.start( nextCheck - now );
+}
+
+
+void
+NetworkScheduler::start( ScheduledReply* reply )
+{
+    QNetworkRequest req = reply->request();
+
+    CachedResponse* cached = m_validators.object( req.url().toString() );
+    if ( cached )
+    {
+        if ( !cached->etag.isEmpty() )
+            req.setRawHeader( "If-None-Match", cached->etag );
+        if ( !cached->lastModified.isEmpty() )
+            req.setRawHeader( "If-Modified-Since", cached->lastModified );
+    }
+
+    QNetworkReply* netReply = TomahawkUtils::nam()->get( req );
+    reply->m_reply = netReply;
+    m_running[ netReply ] = reply;
+
+    connect( netReply, SIGNAL( finished() ), SLOT( onReplyFinished() ) );
+}
+
+
+void
+NetworkScheduler::onReplyFinished()
+{
+    QNetworkReply* netReply = qobject_cast< QNetworkReply* >( sender() );
+    if ( !netReply )
+        return;
+
+    netReply->deleteLater();
+
+    Host& h = host( netReply->request().url() );
+    h.active = qMax( 0, h.active - 1 );
+
+    ScheduledReply* reply = m_running.take( netReply );
+    if ( !reply )
+    {
+        // the caller went away meanwhile
+        dispatch();
+        return;
+    }
+    reply->m_reply.clear();
+
+    const int status = netReply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+    const QString key = netReply->request().url().toString();
+
+    if ( ( status == 429 || status == 503 ) && reply->m_retries < MAX_RETRIES )
+    {
+        int delay = RETRY_BACKOFF << reply->m_retries;
+        bool ok;
+        const int retryAfter = netReply->rawHeader( "Retry-After" ).toInt( &ok );
+        if ( ok && retryAfter > 0 )
+            delay = retryAfter * 1000;
+
+        tLog() << "Server throttled info request, retrying in" << delay << "ms:" << key;
+        reply->m_retries++;
+        h.blockedUntil = QDateTime::currentMSecsSinceEpoch() + delay;
+
+        enqueue( reply, true );
+        return;
+    }
+
+    if ( status == 304 && m_validators.contains( key ) )
+    {
+        reply->complete( netReply, m_validators.object( key )->body, 200 );
+    }
+    else
+    {
+        const QByteArray body = netReply->readAll();
+
+        if ( status == 200 && ( netReply->hasRawHeader( "ETag" ) || netReply->hasRawHeader( "Last-Modified" ) ) )
+        {
+            CachedResponse* cached = new CachedResponse;
+            cached->etag = netReply->rawHeader( "ETag" );
+            cached->lastModified = netReply->rawHeader( "Last-Modified" );
+            cached->contentType = netReply->rawHeader( "Content-Type" );
+            cached->body = body;
+            m_validators.insert( key, cached, qMax( 1, body.size() ) );
+        }
+
+        reply->complete( netReply, body, status );
+    }
+
+    dispatch();
+}
+
+
+void
+NetworkScheduler::onScheduledReplyDestroyed( QObject* reply )
+{
+    for ( int prio = InfoPriorityNowPlaying; prio <= InfoPriorityBackground; prio++ )
+        m_queues[ prio ].removeAll( static_cast< ScheduledReply* >( reply ) );
+
+    foreach ( QNetworkReply* netReply, m_running.keys( static_cast< ScheduledReply* >( reply ) ) )
+        m_running.remove( netReply );
+}
+
+} //namespace InfoSystem
+
+} //namespace Tomahawk
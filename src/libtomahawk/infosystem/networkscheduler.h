@@ -0,0 +1,143 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_NETWORKSCHEDULER_H
+#define TOMAHAWK_NETWORKSCHEDULER_H
+
+#include "infosystem/infosystem.h"
+
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+
+#include "dllmacro.h"
+
+namespace Tomahawk {
+
+namespace InfoSystem {
+
+class NetworkScheduler;
+
+/**
+ * Reply handed out by the NetworkScheduler right away. It stays empty until the
+ * scheduler got around to run the real request (including retries), then it
+ * carries that request's headers, attributes, error and body and emits finished().
+ */
+class DLLEXPORT ScheduledReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    ScheduledReply( const QNetworkRequest& request, InfoPriority priority, QObject* parent = 0 );
+    virtual ~ScheduledReply();
+
+    InfoPriority priority() const { return m_priority; }
+    int retries() const { return m_retries; }
+
+    virtual void abort();
+    virtual qint64 bytesAvailable() const;
+
+protected:
+    virtual qint64 readData( char* data, qint64 maxSize );
+
+private:
+    friend class NetworkScheduler;
+
+    void complete( QNetworkReply* reply, const QByteArray& body, int statusCode );
+    void fail( QNetworkReply::NetworkError code, const QString& errorString );
+
+    InfoPriority m_priority;
+    int m_retries;
+    QPointer< QNetworkReply > m_reply;
+
+    QByteArray m_data;
+    qint64 m_pos;
+};
+
+
+/**
+ * Shared outbound HTTP queue for the info plugins. Lives in the InfoSystemWorker thread,
+ * get() can be called from other threads as well.
+ *
+ * Requests are started by priority within per host budgets (max concurrent requests and
+ * min interval between two requests), 429 / 503 answers are retried with backoff and
+ * responses carrying validators are kept to turn refetches into conditional GETs.
+ */
+class DLLEXPORT NetworkScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static NetworkScheduler* instance();
+
+    explicit NetworkScheduler( QObject* parent = 0 );
+    virtual ~NetworkScheduler();
+
+    QNetworkReply* get( const QNetworkRequest& request, InfoPriority priority = InfoPriorityVisible );
+    QNetworkReply* get( const QNetworkRequest& request, const Tomahawk::InfoSystem::InfoRequestData& requestData );
+
+    void setHostBudget( const QString& host, int maxConcurrent, int minInterval );
+
+private slots:
+    void adopt( QObject* reply );
+    void dispatch();
+    void onReplyFinished();
+    void onScheduledReplyDestroyed( QObject* reply );
+
+private:
+    struct Host
+    {
+        Host() : maxConcurrent( 4 ), minInterval( 0 ), active( 0 ), lastStarted( 0 ), blockedUntil( 0 ) {}
+
+        int maxConcurrent;
+        int minInterval;
+        int active;
+        qint64 lastStarted;
+        qint64 blockedUntil;
+    };
+
+    struct CachedResponse
+    {
+        QByteArray etag;
+        QByteArray lastModified;
+        QByteArray contentType;
+        QByteArray body;
+    };
+
+    void enqueue( ScheduledReply* reply, bool front = false );
+    void start( ScheduledReply* reply );
+    Host& host( const QUrl& url );
+
+    QList< ScheduledReply* > m_queues[ InfoPriorityBackground + 1 ];
+    QHash< QString, Host > m_hosts;
+    QHash< QNetworkReply*, ScheduledReply* > m_running;
+    QCache< QString, CachedResponse > m_validators;
+    QTimer m_dispatchTimer;
+
+    static NetworkScheduler* s_instance;
+};
+
+}
+
+}
+
+#endif // TOMAHAWK_NETWORKSCHEDULER_H
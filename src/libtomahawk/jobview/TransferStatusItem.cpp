@@ -22,6 +22,7 @@
 #include "JobStatusModel.h"
 #include "network/streamconnection.h"
 #include "network/servent.h"
+#include "network/uploadscheduler.h"
 #include "utils/tomahawkutils.h"
 #include "result.h"
 #include "source.h"
@@ -67,6 +68,11 @@ TransferStatusItem::rightColumnText() const
     if ( m_stream.isNull() )
         return QString();
 
+    // show what the stream gets next to its share of the upload limit
+    if ( m_stream.data()->type() == StreamConnection::SENDING && UploadScheduler::instance()->isLimited() )
+        return QString( "%1 / %2 kb/s" ).arg( m_stream.data()->transferRate() / 1024 )
+                                        .arg( UploadScheduler::instance()->fairShare() / 1024 );
+
     return QString( "%1 kb/s" ).arg( m_stream.data()->transferRate() / 1024 );
 }
 
@@ -21,6 +21,7 @@
 #include <QCoreApplication>
 #include <QThread>
 
+#include "streamcache.h"
 #include "utils/logger.h"
 
 // Msgs are framed, this is the size each msg we send containing audio data:
@@ -32,6 +33,7 @@ BufferIODevice::BufferIODevice( unsigned int size, QObject* parent )
     , m_size( size )
     , m_received( 0 )
     , m_pos( 0 )
+    , m_complete( false )
 {
 }
 
@@ -67,7 +69,10 @@ BufferIODevice::seek( qint64 pos )
         return false;
 
     int block = blockForPos( pos );
-    if ( isBlockEmpty( block ) )
+    m_mut.lock();
+    const bool empty = isBlockEmpty( block );
+    m_mut.unlock();
+    if ( empty )
         emit blockRequest( block );
 
     m_pos = pos;
@@ -88,22 +93,35 @@ void
 BufferIODevice::inputComplete( const QString& errmsg )
 {
     qDebug() << Q_FUNC_INFO;
+    // with several peers feeding us, possibly from different threads, only the first one to finish or fail counts
+    {
+        QMutexLocker lock( &m_mut );
+        if ( m_complete )
+            return;
+
+        m_complete = true;
+        m_size = m_received;
+    }
+
     setErrorString( errmsg );
-    m_size = m_received;
     emit readChannelFinished();
 }
 
 
-void
+bool
 BufferIODevice::addData( int block, const QByteArray& ba )
 {
     {
         QMutexLocker lock( &m_mut );
 
+        if ( !isBlockEmpty( block ) )
+            return false;
+
         while ( m_buffer.count() <= block )
             m_buffer << QByteArray();
 
         m_buffer.replace( block, ba );
+        m_received += ba.count();
     }
 
     // If this was the last block of the transfer, check if we need to fill up gaps
@@ -115,9 +133,28 @@ BufferIODevice::addData( int block, const QByteArray& ba )
         }
     }
 
-    m_received += ba.count();
     emit bytesWritten( ba.count() );
     emit readyRead();
+
+    return true;
+}
+
+
+void
+BufferIODevice::setCachedBlocks( const QString& cacheKey, const QList<int>& blocks )
+{
+    QMutexLocker lock( &m_mut );
+
+    m_cacheKey = cacheKey;
+    m_cached = QBitArray( maxBlocks() );
+    foreach ( int block, blocks )
+    {
+        if ( block >= m_cached.size() || !isBlockEmpty( block ) )
+            continue;
+
+        m_cached.setBit( block );
+        m_received += blockLength( block );
+    }
 }
 
 
@@ -214,21 +251,52 @@ BufferIODevice::offsetForPos( qint64 pos ) const
 
 
 int
-BufferIODevice::nextEmptyBlock() const
+BufferIODevice::nextEmptyBlock( int from ) const
 {
-    int i = 0;
-    foreach( const QByteArray& ba, m_buffer )
+    QMutexLocker lock( &m_mut );
+
+    // blocks we have in the stream cache count as received, even before they're read in
+    const int blocks = maxBlocks();
+    for ( int i = from; i < blocks; i++ )
     {
-        if ( ba.isEmpty() )
+        if ( isBlockEmpty( i ) )
             return i;
+    }
 
-        i++;
+    return -1;
+}
+
+
+int
+BufferIODevice::largestGapMiddle() const
+{
+    QMutexLocker lock( &m_mut );
+
+    int bestStart = -1, bestLength = 0;
+    int start = -1;
+
+    const int blocks = maxBlocks();
+    for ( int i = 0; i <= blocks; i++ )
+    {
+        if ( i < blocks && isBlockEmpty( i ) )
+        {
+            if ( start < 0 )
+                start = i;
+            continue;
+        }
+
+        if ( start >= 0 && i - start > bestLength )
+        {
+            bestStart = start;
+            bestLength = i - start;
+        }
+        start = -1;
     }
 
-    if ( i == maxBlocks() )
+    if ( bestStart < 0 )
         return -1;
 
-    return i;
+    return bestStart + bestLength / 2;
 }
 
 
@@ -244,9 +312,22 @@ BufferIODevice::maxBlocks() const
 }
 
 
+int
+BufferIODevice::blockLength( int block ) const
+{
+    if ( block == maxBlocks() - 1 && ( m_size % BLOCKSIZE ) > 0 )
+        return m_size % BLOCKSIZE;
+
+    return BLOCKSIZE;
+}
+
+
 bool
 BufferIODevice::isBlockEmpty( int block ) const
 {
+    if ( block < m_cached.size() && m_cached.testBit( block ) )
+        return false;
+
     if ( block >= m_buffer.count() )
         return true;
 
@@ -261,8 +342,9 @@ BufferIODevice::getData( qint64 pos, qint64 size )
     QByteArray ba;
     int block = blockForPos( pos );
     int offset = offsetForPos( pos );
+    int lost = -1;
 
-    QMutexLocker lock( &m_mut );
+    m_mut.lock();
     while( ba.count() < size )
     {
         if ( block > maxBlocks() )
@@ -271,8 +353,30 @@ BufferIODevice::getData( qint64 pos, qint64 size )
         if ( isBlockEmpty( block ) )
             break;
 
+        if ( block < m_cached.size() && m_cached.testBit( block ) )
+        {
+            // load cached blocks as the player gets to them
+            const QByteArray cached = StreamCache::instance() ? StreamCache::instance()->readBlock( m_cacheKey, block ) : QByteArray();
+            m_cached.clearBit( block );
+            if ( cached.isEmpty() )
+            {
+                // evicted in the meantime, one of our peers has to send it after all
+                m_received -= blockLength( block );
+                lost = block;
+                break;
+            }
+
+            while ( m_buffer.count() <= block )
+                m_buffer << QByteArray();
+            m_buffer.replace( block, cached );
+        }
+
         ba.append( m_buffer.at( block++ ).mid( offset ) );
     }
+    m_mut.unlock();
+
+    if ( lost >= 0 )
+        emit blockRequest( lost );
 
 //    qDebug() << Q_FUNC_INFO << pos << size << 2;
     return ba.left( size );
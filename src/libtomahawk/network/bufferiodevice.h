@@ -20,6 +20,7 @@
 #define BUFFERIODEVICE_H
 
 #include <QIODevice>
+#include <QBitArray>
 #include <QMutexLocker>
 #include <QFile>
 
@@ -41,7 +42,10 @@ public:
     virtual bool atEnd() const;
     virtual qint64 pos() const { return m_pos; }
 
-    void addData( int block, const QByteArray& ba );
+    // returns false if the block was there already, e.g. fetched from another peer
+    bool addData( int block, const QByteArray& ba );
+    // blocks the stream cache holds for this file, read from disk only once they're played
+    void setCachedBlocks( const QString& cacheKey, const QList<int>& blocks );
     void clear();
 
     OpenMode openMode() const { return QIODevice::ReadOnly | QIODevice::Unbuffered; }
@@ -53,8 +57,11 @@ public:
     static unsigned int blockSize();
 
     int maxBlocks() const;
-    int nextEmptyBlock() const;
+    int nextEmptyBlock( int from = 0 ) const;
     bool isBlockEmpty( int block ) const;
+    // middle of the longest run of missing blocks, -1 if there are none
+    int largestGapMiddle() const;
+    bool isComplete() const { return m_complete; }
 
 signals:
     void blockRequest( int block );
@@ -68,11 +75,16 @@ private:
     int offsetForPos( qint64 pos ) const;
     QByteArray getData( qint64 pos, qint64 size );
 
+    int blockLength( int block ) const;
+
     QList<QByteArray> m_buffer;
+    QString m_cacheKey;
+    QBitArray m_cached;
     mutable QMutex m_mut; //const methods need to lock
     unsigned int m_size, m_received;
 
     unsigned int m_pos;
+    bool m_complete;
 };
 
 #endif // BUFFERIODEVICE_H
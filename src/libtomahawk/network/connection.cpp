@@ -23,11 +23,12 @@
 
 #include "network/servent.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 #define PROTOVER "4" // must match remote peer, or we can't talk.
 
 
-Connection::Connection( Servent* parent )
+Connection::Connection( Servent* parent, QThread* thread )
     : QObject()
     , m_sock( 0 )
     , m_peerport( 0 )
@@ -47,8 +48,18 @@ Connection::Connection( Servent* parent )
     , m_rx_bytes_last( 0 )
     , m_tx_bytes_last( 0 )
 {
-    moveToThread( m_servent->thread() );
-    qDebug() << "CTOR Connection (super)" << thread();
+    /*
+        Connections can be created from other thread contexts, such as when AudioEngine
+        calls getIODevice. They stay on the network thread of the connection that spawned
+        them, or are spread over the servent's threads otherwise.
+     */
+    if ( !thread )
+        thread = m_servent->isNetworkThread( QThread::currentThread() ) ? QThread::currentThread() : m_servent->thread();
+
+    moveToThread( thread );
+    m_msgprocessor_in.moveToThread( thread );
+    m_msgprocessor_out.moveToThread( thread );
+    qDebug() << "CTOR Connection (super)" << this->thread();
 
     connect( &m_msgprocessor_out, SIGNAL( ready( msg_ptr ) ),
              SLOT( sendMsg_now( msg_ptr ) ), Qt::QueuedConnection );
@@ -71,6 +82,12 @@ Connection::~Connection()
     }
 
     delete m_statstimer;
+
+    if ( !m_metricsKey.isEmpty() )
+    {
+        Metrics::instance()->removeGauge( m_metricsKey + ".tx" );
+        Metrics::instance()->removeGauge( m_metricsKey + ".rx" );
+    }
 }
 
 
@@ -178,6 +195,9 @@ Connection::start( QTcpSocket* sock )
 
     m_sock = sock;
 
+    // the servent hands over sockets from its own thread
+    m_sock->moveToThread( thread() );
+
     if( m_name.isEmpty() )
     {
         m_name = QString( "peer[%1]" ).arg( m_sock->peerAddress().toString() );
@@ -202,20 +222,7 @@ void
 Connection::doSetup()
 {
     qDebug() << Q_FUNC_INFO << thread();
-    /*
-        New connections can be created from other thread contexts, such as
-        when AudioEngine calls getIODevice.. - we need to ensure that connections
-        and their associated sockets are running in the same thread as the servent.
-
-        HINT: export QT_FATAL_WARNINGS=1 helps to catch these kind of errors.
-     */
-    if( QThread::currentThread() != m_servent->thread() )
-    {
-        // Connections should always be in the same thread as the servent.
-        qDebug() << "Fixing thead affinity...";
-        moveToThread( m_servent->thread() );
-        qDebug() << Q_FUNC_INFO  << thread();
-    }
+    Q_ASSERT( QThread::currentThread() == thread() );
 
     //stats timer calculates BW used by this connection
     m_statstimer = new QTimer;
@@ -225,8 +232,6 @@ Connection::doSetup()
     m_statstimer->start();
     m_statstimer_mark.start();
 
-    m_sock->moveToThread( thread() );
-
     connect( m_sock.data(), SIGNAL( bytesWritten( qint64 ) ),
                               SLOT( bytesWritten( qint64 ) ), Qt::QueuedConnection );
 
@@ -460,6 +465,14 @@ Connection::calcStats()
     m_stats_tx_bytes_per_sec = (float)1000 * ( (m_tx_bytes - m_tx_bytes_last) / (float)elapsed );
     m_stats_rx_bytes_per_sec = (float)1000 * ( (m_rx_bytes - m_rx_bytes_last) / (float)elapsed );
 
+    if ( m_metricsKey.isEmpty() )
+        m_metricsKey = QString( "network.connection.%1 (%2)" ).arg( name() ).arg( id() );
+
+    Metrics::instance()->increment( "network.bytes.tx", m_tx_bytes - m_tx_bytes_last );
+    Metrics::instance()->increment( "network.bytes.rx", m_rx_bytes - m_rx_bytes_last );
+    Metrics::instance()->setGauge( m_metricsKey + ".tx", m_stats_tx_bytes_per_sec );
+    Metrics::instance()->setGauge( m_metricsKey + ".rx", m_stats_rx_bytes_per_sec );
+
     m_rx_bytes_last = m_rx_bytes;
     m_tx_bytes_last = m_tx_bytes;
 
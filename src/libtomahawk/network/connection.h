@@ -41,6 +41,7 @@
 #include "dllmacro.h"
 
 class Servent;
+class QThread;
 
 class DLLEXPORT Connection : public QObject
 {
@@ -48,7 +49,8 @@ Q_OBJECT
 
 public:
 
-    Connection( Servent* parent );
+    // runs on thread, or a network thread picked from the calling context if none is given
+    Connection( Servent* parent, QThread* thread = 0 );
     virtual ~Connection();
     virtual Connection* clone() = 0;
 
@@ -83,6 +85,8 @@ public:
 
     qint64 bytesSent() const { return m_tx_bytes; }
     qint64 bytesReceived() const { return m_rx_bytes; }
+    // bytes sitting in the socket's write buffer
+    qint64 bytesToWrite() const { return m_sock.isNull() ? 0 : m_sock->bytesToWrite(); }
 
     void setMsgProcessorModeOut( quint32 m ) { m_msgprocessor_out.setMode( m ); }
     void setMsgProcessorModeIn( quint32 m ) { m_msgprocessor_in.setMode( m ); }
@@ -143,6 +147,7 @@ private:
     QTimer* m_statstimer;
     QTime m_statstimer_mark;
     qint64 m_stats_tx_bytes_per_sec, m_stats_rx_bytes_per_sec;
+    QString m_metricsKey;
     qint64 m_rx_bytes_last, m_tx_bytes_last;
 
     MsgProcessor m_msgprocessor_in, m_msgprocessor_out;
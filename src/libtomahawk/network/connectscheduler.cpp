@@ -0,0 +1,303 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "connectscheduler.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QThread>
+
+#include "controlconnection.h"
+#include "servent.h"
+#include "tomahawksettings.h"
+#include "utils/metrics.h"
+#include "utils/logger.h"
+
+// connection attempts that may be in flight at the same time
+#define MAX_CONNECT_ATTEMPTS 8
+// an attempt that hasn't succeeded or failed by then no longer holds up the queue
+#define CONNECT_TIMEOUT 30000
+// delay before retrying a peer after its first failed attempt, doubling with each further failure
+#define BACKOFF_MIN 5000
+#define BACKOFF_MAX 1800000
+// peers we streamed from that keep their head start across restarts
+#define MAX_RECENT_PEERS 50
+
+ConnectScheduler* ConnectScheduler::s_instance = 0;
+
+
+ConnectScheduler*
+ConnectScheduler::instance()
+{
+    return s_instance;
+}
+
+
+ConnectScheduler::ConnectScheduler( Servent* parent )
+    : QObject( parent )
+    , m_servent( parent )
+    , m_timer( this )
+{
+    s_instance = this;
+
+    m_recent = TomahawkSettings::instance()->recentStreamPeers();
+
+    m_timer.setSingleShot( true );
+    connect( &m_timer, SIGNAL( timeout() ), SLOT( dispatch() ) );
+}
+
+
+ConnectScheduler::~ConnectScheduler()
+{
+    s_instance = 0;
+}
+
+
+void
+ConnectScheduler::connectToPeer( const QString& host, int port, const QString& key, const QString& name, const QString& nodeid )
+{
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "connectToPeer", Qt::QueuedConnection,
+                                   Q_ARG( QString, host ), Q_ARG( int, port ), Q_ARG( QString, key ),
+                                   Q_ARG( QString, name ), Q_ARG( QString, nodeid ) );
+        return;
+    }
+
+    const QString peer = name.isEmpty() ? nodeid : name;
+
+    Attempt attempt;
+    attempt.failures = 0;
+    attempt.notBefore = 0;
+
+    // fresh details for a peer we're backing off from don't get to skip the wait
+    if ( m_queued.contains( peer ) )
+    {
+        const Attempt old = m_queued.value( peer );
+        attempt.failures = old.failures;
+        attempt.notBefore = old.notBefore;
+    }
+
+    attempt.host = host;
+    attempt.port = port;
+    attempt.key = key;
+    attempt.name = name;
+    attempt.nodeid = nodeid;
+    attempt.started = 0;
+
+    m_queued.insert( peer, attempt );
+    dispatch();
+}
+
+
+void
+ConnectScheduler::cancel( const QString& name )
+{
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "cancel", Qt::QueuedConnection, Q_ARG( QString, name ) );
+        return;
+    }
+
+    if ( m_queued.remove( name ) )
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Dropped queued connection attempt to" << name;
+
+    updateGauges();
+}
+
+
+void
+ConnectScheduler::streamedFrom( const QString& nodeid )
+{
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "streamedFrom", Qt::QueuedConnection, Q_ARG( QString, nodeid ) );
+        return;
+    }
+
+    if ( !m_recent.isEmpty() && m_recent.first() == nodeid )
+        return;
+
+    m_recent.removeAll( nodeid );
+    m_recent.prepend( nodeid );
+    while ( m_recent.count() > MAX_RECENT_PEERS )
+        m_recent.removeLast();
+
+    TomahawkSettings::instance()->setRecentStreamPeers( m_recent );
+}
+
+
+void
+ConnectScheduler::dispatch()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // attempts that hang, e.g. on a firewall silently dropping our packets, give up their slot
+    foreach ( QObject* conn, m_running.keys() )
+    {
+        if ( now - m_running.value( conn ).started >= CONNECT_TIMEOUT )
+        {
+            tDebug() << Q_FUNC_INFO << "Connection attempt timed out:" << m_running.value( conn ).name;
+            finish( conn, false );
+        }
+    }
+
+    while ( m_running.count() < MAX_CONNECT_ATTEMPTS )
+    {
+        // the peer we streamed from most recently goes first, otherwise whoever has waited longest
+        QString next;
+        int nextRank = m_recent.count();
+        qint64 nextTime = 0;
+        foreach ( const QString& peer, m_queued.keys() )
+        {
+            const Attempt& attempt = m_queued[ peer ];
+            if ( attempt.notBefore > now )
+                continue;
+
+            int rank = m_recent.indexOf( attempt.nodeid );
+            if ( rank < 0 )
+                rank = m_recent.count();
+
+            if ( next.isEmpty() || rank < nextRank || ( rank == nextRank && attempt.notBefore < nextTime ) )
+            {
+                next = peer;
+                nextRank = rank;
+                nextTime = attempt.notBefore;
+            }
+        }
+
+        if ( next.isEmpty() )
+            break;
+
+        start( m_queued.take( next ) );
+    }
+
+    // wake up again for the next timeout or the next peer coming out of its backoff
+    qint64 wake = -1;
+    foreach ( const Attempt& attempt, m_running )
+    {
+        if ( wake < 0 || attempt.started + CONNECT_TIMEOUT < wake )
+            wake = attempt.started + CONNECT_TIMEOUT;
+    }
+    if ( m_running.count() < MAX_CONNECT_ATTEMPTS )
+    {
+        foreach ( const Attempt& attempt, m_queued )
+        {
+            if ( wake < 0 || attempt.notBefore < wake )
+                wake = attempt.notBefore;
+        }
+    }
+
+    if ( wake >= 0 )
+        m_timer.start( qMax( (qint64)0, wake - now ) );
+    else
+        m_timer.stop();
+
+    updateGauges();
+}
+
+
+void
+ConnectScheduler::start( Attempt attempt )
+{
+    if ( !attempt.nodeid.isEmpty() && m_servent->connectedToSession( attempt.nodeid ) )
+    {
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Already connected to" << attempt.name;
+        return;
+    }
+
+    ControlConnection* conn = m_servent->connectToPeer( attempt.host, attempt.port, attempt.key, attempt.name, attempt.nodeid );
+    if ( !conn )
+        return;
+
+    attempt.started = QDateTime::currentMSecsSinceEpoch();
+    m_running.insert( conn, attempt );
+
+    // a connection that finishes without getting ready, e.g. a dupe, counts as failed
+    connect( conn, SIGNAL( ready() ), SLOT( onConnectionReady() ) );
+    connect( conn, SIGNAL( failed() ), SLOT( onConnectionFailed() ) );
+    connect( conn, SIGNAL( finished() ), SLOT( onConnectionFailed() ) );
+
+    Metrics::instance()->increment( "network.connect.attempts" );
+}
+
+
+void
+ConnectScheduler::onConnectionReady()
+{
+    finish( sender(), true );
+    dispatch();
+}
+
+
+void
+ConnectScheduler::onConnectionFailed()
+{
+    finish( sender(), false );
+    dispatch();
+}
+
+
+void
+ConnectScheduler::finish( QObject* conn, bool success )
+{
+    // the connection may be gone already, it's only used as a key here
+    if ( !m_running.contains( conn ) )
+        return;
+
+    Attempt attempt = m_running.take( conn );
+    if ( success )
+        return;
+
+    const QString peer = attempt.name.isEmpty() ? attempt.nodeid : attempt.name;
+    if ( m_queued.contains( peer ) )
+    {
+        // the peer sent new details while we were trying the old ones, those get the next go
+        return;
+    }
+
+    attempt.failures++;
+    attempt.started = 0;
+    attempt.notBefore = QDateTime::currentMSecsSinceEpoch() + backoff( attempt.failures );
+    m_queued.insert( peer, attempt );
+
+    tDebug() << Q_FUNC_INFO << "Connecting to" << peer << "failed" << attempt.failures << "times, retrying in"
+             << ( attempt.notBefore - QDateTime::currentMSecsSinceEpoch() ) / 1000 << "secs";
+    Metrics::instance()->increment( "network.connect.failures" );
+}
+
+
+qint64
+ConnectScheduler::backoff( int failures ) const
+{
+    qint64 delay = BACKOFF_MIN;
+    for ( int i = 1; i < failures && delay < BACKOFF_MAX; i++ )
+        delay *= 2;
+    delay = qMin( delay, (qint64)BACKOFF_MAX );
+
+    // +/- 25%, so peers that failed together don't all come back together
+    return delay * 3 / 4 + ( qrand() % ( delay / 2 + 1 ) );
+}
+
+
+void
+ConnectScheduler::updateGauges()
+{
+    Metrics::instance()->setGauge( "network.connect.queued", m_queued.count() );
+    Metrics::instance()->setGauge( "network.connect.running", m_running.count() );
+}
@@ -0,0 +1,96 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONNECTSCHEDULER_H
+#define CONNECTSCHEDULER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
+#include "dllmacro.h"
+
+class Servent;
+
+/**
+ * Paces outgoing peer connections.
+ *
+ * When a SIP account comes online all of its contacts show up at once, and
+ * dialing every one of them at the same time swamps the network threads and
+ * the database with handshakes and syncs. Attempts are queued here instead,
+ * with only a few of them in flight at any time.
+ *
+ * Peers we recently streamed from are dialed first. A peer whose attempt
+ * fails is retried after an exponentially growing, jittered delay, until it
+ * either connects or goes offline.
+ */
+class DLLEXPORT ConnectScheduler : public QObject
+{
+Q_OBJECT
+
+public:
+    static ConnectScheduler* instance();
+
+    explicit ConnectScheduler( Servent* parent );
+    virtual ~ConnectScheduler();
+
+    /// queues a connection attempt, replacing one still queued for the same peer
+    Q_INVOKABLE void connectToPeer( const QString& host, int port, const QString& key, const QString& name, const QString& nodeid );
+    /// drops a queued attempt and the backoff state of the peer with the given name
+    Q_INVOKABLE void cancel( const QString& name );
+    /// remembers nodeid as one we stream from, so it gets connected to first next time
+    Q_INVOKABLE void streamedFrom( const QString& nodeid );
+
+private slots:
+    void dispatch();
+
+    void onConnectionReady();
+    void onConnectionFailed();
+
+private:
+    struct Attempt
+    {
+        QString host;
+        int port;
+        QString key;
+        QString name;
+        QString nodeid;
+
+        int failures;
+        qint64 notBefore; /// msecs since epoch
+        qint64 started;   /// msecs since epoch, 0 while queued
+    };
+
+    void start( Attempt attempt );
+    void finish( QObject* conn, bool success );
+    qint64 backoff( int failures ) const;
+    void updateGauges();
+
+    Servent* m_servent;
+
+    QHash< QString, Attempt > m_queued;   /// by peer name
+    QHash< QObject*, Attempt > m_running; /// by the connection being set up
+    QStringList m_recent;                 /// nodeids we streamed from, most recent first
+
+    QTimer m_timer;
+
+    static ConnectScheduler* s_instance;
+};
+
+#endif // CONNECTSCHEDULER_H
@@ -18,6 +18,8 @@
 
 #include "controlconnection.h"
 
+#include <QtCore/QThread>
+
 #include "streamconnection.h"
 #include "database/database.h"
 #include "database/databasecommand_collectionstats.h"
@@ -30,14 +32,23 @@
 
 #define TCP_TIMEOUT 600
 
+// set in the channel ids of streams the peer opened, so both ends can allocate ids independently
+#define CHANNEL_PEER_BIT 0x80000000
+
+// dbsyncs start up to this many msecs apart per connected peer, so a burst of new peers doesn't sync all at once
+#define DBSYNC_JITTER 250
+#define DBSYNC_JITTER_MAX 30000
+
 using namespace Tomahawk;
 
 
 ControlConnection::ControlConnection( Servent* parent, const QHostAddress &ha )
-    : Connection( parent )
+    : Connection( parent, parent->connectionThread() )
     , m_dbsyncconn( 0 )
     , m_registered( false )
     , m_pingtimer( 0 )
+    , m_streamChannels( false )
+    , m_nextChannel( 1 )
 {
     qDebug() << "CTOR controlconnection";
     setId("ControlConnection()");
@@ -53,10 +64,12 @@ ControlConnection::ControlConnection( Servent* parent, const QHostAddress &ha )
 
 
 ControlConnection::ControlConnection( Servent* parent, const QString &ha )
-    : Connection( parent )
+    : Connection( parent, parent->connectionThread() )
     , m_dbsyncconn( 0 )
     , m_registered( false )
     , m_pingtimer( 0 )
+    , m_streamChannels( false )
+    , m_nextChannel( 1 )
 {
     qDebug() << "CTOR controlconnection";
     setId("ControlConnection()");
@@ -87,9 +100,20 @@ ControlConnection::~ControlConnection()
     qDebug() << "DTOR controlconnection";
 
     if ( !m_source.isNull() )
+    {
+        // setOffline() runs later on the source's thread, don't leave it pointing at us until then
+        m_source->setControlConnection( 0 );
         m_source->setOffline();
+    }
 
     delete m_pingtimer;
+
+    // multiplexed streams can't outlive the connection they run on
+    const QList< StreamConnection* > streams = m_streams.values();
+    m_streams.clear();
+    foreach ( StreamConnection* sc, streams )
+        sc->channelClosed();
+
     m_servent->unregisterControlConnection( this );
     if ( m_dbsyncconn )
         m_dbsyncconn->deleteLater();
@@ -143,6 +167,12 @@ ControlConnection::setup()
     connect( m_pingtimer, SIGNAL( timeout() ), SLOT( onPingTimer() ) );
     m_pingtimer->start();
     m_pingtimer_mark.start();
+
+    // older peers just log this as an unhandled msg and keep using parallel connections
+    QVariantMap m;
+    m.insert( "method", "capabilities" );
+    m.insert( "streamchannels", true );
+    sendMsg( m );
 }
 
 
@@ -156,16 +186,16 @@ ControlConnection::registerSource()
     Q_ASSERT( source == m_source.data() );
 
 #ifndef ENABLE_HEADLESS
-//    qDebug() << Q_FUNC_INFO << "Setting avatar ... " << name() << !SipHandler::instance()->avatar( name() ).isNull();
-    if( !SipHandler::instance()->avatar( name() ).isNull() )
-    {
-        source->setAvatar( SipHandler::instance()->avatar( name() ) );
-    }
+    // pixmaps can only be touched on the gui thread
+    QMetaObject::invokeMethod( SipHandler::instance(), "applyAvatar", Qt::QueuedConnection,
+                               Q_ARG( QString, name() ), Q_ARG( Tomahawk::source_ptr, m_source ) );
 #endif
 
     m_registered = true;
     m_servent->registerControlConnection( this );
-    setupDbSyncConnection();
+
+    const int spread = qMin( (int)m_servent->numConnectedPeers() * DBSYNC_JITTER, DBSYNC_JITTER_MAX );
+    QTimer::singleShot( qrand() % ( spread + 1 ), this, SLOT( setupDbSyncConnection() ) );
 }
 
 
@@ -225,6 +255,14 @@ ControlConnection::dbSyncConnFinished( QObject* c )
 }
 
 
+void
+ControlConnection::triggerDBSync()
+{
+    if ( dbSyncConnection() )
+        dbSyncConnection()->trigger();
+}
+
+
 DBSyncConnection*
 ControlConnection::dbSyncConnection()
 {
@@ -249,6 +287,12 @@ ControlConnection::handleMsg( msg_ptr msg )
         return;
     }
 
+    if ( msg->is( Msg::STREAM ) )
+    {
+        handleStreamMsg( msg );
+        return;
+    }
+
     // if small and not compresed, print it out for debug
     if( msg->length() < 1024 && !msg->is( Msg::COMPRESSED ) )
     {
@@ -278,6 +322,24 @@ ControlConnection::handleMsg( msg_ptr msg )
             m_dbconnkey = m.value( "key" ).toString() ;
             setupDbSyncConnection();
         }
+        else if( m.value( "method" ).toString() == "capabilities" )
+        {
+            m_streamChannels = m.value( "streamchannels" ).toBool();
+        }
+        else if( m.value( "method" ).toString() == "stream-open" )
+        {
+            // the peer wants one of our files, send it on the channel it picked
+            const quint32 channel = m.value( "channel" ).toUInt() | CHANNEL_PEER_BIT;
+            if ( m_streams.contains( channel ) )
+            {
+                tLog() << "Peer opened stream channel twice:" << channel;
+                return;
+            }
+
+            StreamConnection* sc = new StreamConnection( servent(), this, m.value( "fid" ).toString() );
+            m_streams.insert( channel, sc );
+            sc->startChannel( channel, m.value( "window" ).toInt() );
+        }
         else if( m.value( "method" ) == "protovercheckfail" )
         {
             qDebug() << "*** Remote peer protocol version mismatch, connection closed";
@@ -308,3 +370,93 @@ ControlConnection::onPingTimer()
 
     sendMsg( Msg::factory( QByteArray(), Msg::PING ) );
 }
+
+
+void
+ControlConnection::openStream( StreamConnection* sc )
+{
+    // the audio engine asks for iodevices from its own thread
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "openStream", Qt::QueuedConnection, Q_ARG( StreamConnection*, sc ) );
+        return;
+    }
+
+    Q_ASSERT( m_streamChannels );
+
+    quint32 channel;
+    do
+    {
+        channel = m_nextChannel++;
+        if ( m_nextChannel >= CHANNEL_PEER_BIT )
+            m_nextChannel = 1;
+    }
+    while ( m_streams.contains( channel ) );
+
+    m_streams.insert( channel, sc );
+
+    QVariantMap m;
+    m.insert( "method", "stream-open" );
+    m.insert( "channel", channel );
+    m.insert( "fid", sc->fid() );
+    m.insert( "window", STREAM_CHANNEL_WINDOW );
+    sendMsg( m );
+
+    sc->startChannel( channel, 0 );
+}
+
+
+void
+ControlConnection::sendStreamMsg( quint32 channel, const QByteArray& payload, bool fragment )
+{
+    QByteArray ba( sizeof( quint32 ), 0 );
+    qToBigEndian( channel, (uchar*)ba.data() );
+    ba.append( payload );
+
+    char flags = Msg::RAW | Msg::STREAM;
+    if ( fragment )
+        flags |= Msg::FRAGMENT;
+
+    sendMsg( Msg::factory( ba, flags ) );
+}
+
+
+void
+ControlConnection::closeStream( quint32 channel )
+{
+    if ( !m_streams.remove( channel ) )
+        return;
+
+    sendStreamMsg( channel, "close", false );
+}
+
+
+void
+ControlConnection::handleStreamMsg( msg_ptr msg )
+{
+    if ( msg->length() < sizeof( quint32 ) )
+    {
+        markAsFailed();
+        return;
+    }
+
+    // our own channels come back with the peer bit set, the peer's without it
+    const quint32 channel = qFromBigEndian<quint32>( (const uchar*)msg->payload().constData() ) ^ CHANNEL_PEER_BIT;
+    const QByteArray payload = msg->payload().mid( sizeof( quint32 ) );
+
+    StreamConnection* sc = m_streams.value( channel );
+    if ( !sc )
+    {
+        // late msgs for a stream that already went away
+        return;
+    }
+
+    if ( payload == "close" )
+    {
+        m_streams.remove( channel );
+        sc->channelClosed();
+        return;
+    }
+
+    sc->receiveChannelMsg( Msg::factory( payload, msg->flags() & ~Msg::STREAM ) );
+}
@@ -22,6 +22,10 @@
     They arrange connections/reverse connections, inform us
     when the peer goes offline, and own+setup DBSyncConnections.
 
+    If the peer supports it, audio streams are multiplexed over
+    the control connection as channels instead of getting a
+    connection of their own.
+
 */
 #ifndef CONTROLCONNECTION_H
 #define CONTROLCONNECTION_H
@@ -33,6 +37,7 @@
 
 class Servent;
 class DBSyncConnection;
+class StreamConnection;
 
 class DLLEXPORT ControlConnection : public Connection
 {
@@ -48,6 +53,16 @@ public:
 
     Tomahawk::source_ptr source() const;
 
+    bool supportsStreamChannels() const { return m_streamChannels; }
+    void sendStreamMsg( quint32 channel, const QByteArray& payload, bool fragment );
+    void closeStream( quint32 channel );
+
+public slots:
+    // asks the peer to start sending sc's file on a new channel
+    void openStream( StreamConnection* sc );
+    // tells the peer we have new ops for it
+    void triggerDBSync();
+
 protected:
     virtual void setup();
 
@@ -61,6 +76,7 @@ private slots:
 
 private:
     void setupDbSyncConnection( bool ondemand = false );
+    void handleStreamMsg( msg_ptr msg );
 
     Tomahawk::source_ptr m_source;
     DBSyncConnection* m_dbsyncconn;
@@ -70,6 +86,10 @@ private:
 
     QTimer* m_pingtimer;
     QTime m_pingtimer_mark;
+
+    bool m_streamChannels;
+    quint32 m_nextChannel;
+    QHash< quint32, StreamConnection* > m_streams;
 };
 
 #endif // CONTROLCONNECTION_H
@@ -34,6 +34,7 @@
 #include "database/databasecommand.h"
 #include "database/databasecommand_collectionstats.h"
 #include "database/databasecommand_loadops.h"
+#include "database/databasecommand_setpeerlastop.h"
 #include "remotecollection.h"
 #include "source.h"
 #include "sourcelist.h"
@@ -211,12 +212,14 @@ DBSyncConnection::handleMsg( msg_ptr msg )
         if ( cmd )
         {
             QSharedPointer<DatabaseCommand> cmdsp = QSharedPointer<DatabaseCommand>(cmd);
-            m_source->addCommand( cmdsp );
+            m_cmds << cmdsp;
         }
 
         if ( !msg->is( Msg::FRAGMENT ) ) // last msg in this batch
         {
             changeState( SAVING ); // just DB work left to complete
+            m_source->addCommands( m_cmds );
+            m_cmds.clear();
             m_source->executeCommands();
         }
         return;
@@ -225,6 +228,11 @@ DBSyncConnection::handleMsg( msg_ptr msg )
     if ( m.value( "method" ).toString() == "fetchops" )
     {
         m_uscache = m;
+
+        // the peer has everything up to lastop, remember it for oplog compaction
+        DatabaseCommand_SetPeerLastOp* cmd = new DatabaseCommand_SetPeerLastOp( m_source->id(), m.value( "lastop" ).toString() );
+        Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+
         sendOps();
         return;
     }
@@ -81,6 +81,9 @@ private:
     Tomahawk::source_ptr m_source;
     QVariantMap m_uscache;
 
+    // ops of the batch being received, handed to the source in one go
+    QList< QSharedPointer<DatabaseCommand> > m_cmds;
+
     QString m_lastSentOp;
 
     State m_state;
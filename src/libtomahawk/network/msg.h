@@ -55,7 +55,7 @@ public:
         COMPRESSED = 8,
         DBOP = 16,
         PING = 32,
-        RESERVED_1 = 64,
+        STREAM = 64, // payload is prefixed with a 4 byte channel id, see ControlConnection::sendStreamMsg
         SETUP = 128 // used to handshake/auth the connection prior to handing over to Connection subclass
     };
 
@@ -25,7 +25,6 @@
 MsgProcessor::MsgProcessor( quint32 mode, quint32 t ) :
     QObject(), m_mode( mode ), m_threshold( t ), m_totmsgsize( 0 )
 {
-    moveToThread( Servent::instance()->thread() );
 }
 
 
@@ -44,7 +43,8 @@ MsgProcessor::append( msg_ptr msg )
 
     m_totmsgsize += msg->payload().length();
 
-    if( m_mode & NOTHING )
+    // stream channel msgs are opaque audio data, there is nothing to uncompress or parse
+    if( m_mode & NOTHING || msg->is( Msg::STREAM ) )
     {
         //qDebug() << "MsgProcessor::NOTHING";
         handleProcessedMsg( msg );
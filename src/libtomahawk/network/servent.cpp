@@ -34,6 +34,10 @@
 #include "controlconnection.h"
 #include "database/database.h"
 #include "streamconnection.h"
+#include "streamcache.h"
+#include "uploadscheduler.h"
+#include "connectscheduler.h"
+#include "streamswarm.h"
 #include "sourcelist.h"
 
 #include "portfwdthread.h"
@@ -42,6 +46,9 @@
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
+// unclaimed offers are pruned once there are at least this many of them
+#define OFFERS_PRUNE_MIN 64
+
 using namespace Tomahawk;
 
 Servent* Servent::s_instance = 0;
@@ -54,8 +61,11 @@ Servent::instance()
 }
 
 
-Servent::Servent( QObject* parent )
-    : QTcpServer( parent )
+Servent::Servent()
+    : QTcpServer()
+    , m_nextThread( 0 )
+    , m_dbSyncPending( 0 )
+    , m_offersPruneAt( OFFERS_PRUNE_MIN )
     , m_port( 0 )
     , m_externalPort( 0 )
     , m_ready( false )
@@ -63,10 +73,24 @@ Servent::Servent( QObject* parent )
 {
     s_instance = this;
 
+    // one event loop can't keep up with many busy peers, so connections are sharded
+    // over a few threads; the servent itself accepts sockets on the first one
+    const int threads = qBound( 1, QThread::idealThreadCount(), MAX_NETWORK_THREADS );
+    for ( int i = 0; i < threads; i++ )
+    {
+        QThread* thread = new QThread;
+        thread->start();
+        m_threads << thread;
+    }
+
     m_lanHack = qApp->arguments().contains( "--lanhack" );
     ACLRegistry::instance();
     setProxy( QNetworkProxy::NoProxy );
 
+    new StreamCache( this );
+    new UploadScheduler( this );
+    new ConnectScheduler( this );
+
     {
     boost::function<QSharedPointer<QIODevice>(result_ptr)> fac =
         boost::bind( &Servent::localFileIODeviceFactory, this, _1 );
@@ -84,19 +108,77 @@ Servent::Servent( QObject* parent )
         boost::bind( &Servent::httpIODeviceFactory, this, _1 );
     this->registerIODeviceFactory( "http", fac );
     }
+
+    // takes our children along, so they have to be created before this
+    moveToThread( m_threads.first() );
 }
 
 
 Servent::~Servent()
 {
+    Q_ASSERT( m_threads.isEmpty() );
+
     delete ACLRegistry::instance();
     delete m_portfwd;
 }
 
 
+void
+Servent::stop()
+{
+    if ( QThread::currentThread() == thread() )
+    {
+        close();
+
+        // hand ourselves back, so we can be deleted once the network threads are gone
+        moveToThread( QCoreApplication::instance()->thread() );
+        return;
+    }
+
+    if ( m_threads.contains( thread() ) )
+        QMetaObject::invokeMethod( this, "stop", Qt::BlockingQueuedConnection );
+
+    foreach ( QThread* thread, m_threads )
+    {
+        thread->quit();
+        thread->wait();
+    }
+
+    qDeleteAll( m_threads );
+    m_threads.clear();
+}
+
+
+QThread*
+Servent::connectionThread()
+{
+    const uint i = m_nextThread.fetchAndAddRelaxed( 1 );
+    return m_threads.at( i % m_threads.count() );
+}
+
+
+bool
+Servent::isNetworkThread( QThread* thread ) const
+{
+    return m_threads.contains( thread );
+}
+
+
 bool
 Servent::startListening( QHostAddress ha, bool upnp, int port )
 {
+    // the listening socket has to be created on our own thread
+    if ( QThread::currentThread() != thread() )
+    {
+        bool ok = false;
+        QMetaObject::invokeMethod( this, "startListening", Qt::BlockingQueuedConnection,
+                                   Q_RETURN_ARG( bool, ok ),
+                                   Q_ARG( QHostAddress, ha ),
+                                   Q_ARG( bool, upnp ),
+                                   Q_ARG( int, port ) );
+        return ok;
+    }
+
     m_port = port;
     int defPort = TomahawkSettings::instance()->defaultPort();
 
@@ -157,8 +239,6 @@ Servent::startListening( QHostAddress ha, bool upnp, int port )
 QString
 Servent::createConnectionKey( const QString& name, const QString &nodeid, const QString &key, bool onceOnly )
 {
-    Q_ASSERT( this->thread() == QThread::currentThread() );
-
     QString _key = ( key.isEmpty() ? uuid() : key );
     ControlConnection* cc = new ControlConnection( this, name );
     cc->setName( name.isEmpty() ? QString( "KEY(%1)" ).arg( key ) : name );
@@ -244,38 +324,72 @@ Servent::setExternalAddress( QHostAddress ha, unsigned int port )
 void
 Servent::registerOffer( const QString& key, Connection* conn )
 {
+    QMutexLocker lock( &m_mutex );
     m_offers[key] = QWeakPointer<Connection>(conn);
+
+    // offers nobody claims stay around until their connection is gone, drop those every now and then
+    if ( m_offers.count() >= m_offersPruneAt )
+    {
+        QHash< QString, QWeakPointer<Connection> >::iterator it = m_offers.begin();
+        while ( it != m_offers.end() )
+        {
+            if ( it.value().isNull() )
+                it = m_offers.erase( it );
+            else
+                ++it;
+        }
+
+        m_offersPruneAt = qMax( OFFERS_PRUNE_MIN, m_offers.count() * 2 );
+    }
 }
 
 
 void
 Servent::registerControlConnection( ControlConnection* conn )
 {
-    m_controlconnections.append( conn );
+    QMutexLocker lock( &m_mutex );
+    m_controlconnections.insert( conn );
+    m_controlById.insert( conn->id(), conn );
+    m_controlByName.insert( conn->name(), conn );
+
+    if ( conn->socket() )
+    {
+        const QString address = conn->socket()->peerAddress().toString();
+        m_controlAddresses.insert( conn, address );
+        m_authedAddresses[ address ]++;
+    }
 }
 
 
 void
 Servent::unregisterControlConnection( ControlConnection* conn )
 {
-    QList<ControlConnection*> n;
-    foreach( ControlConnection* c, m_controlconnections )
-        if( c!=conn )
-            n.append( c );
+    QMutexLocker lock( &m_mutex );
+
+    m_connectedNodes.remove( conn->id() );
+    if ( !m_controlconnections.remove( conn ) )
+        return;
 
-    m_connectedNodes.removeAll( conn->id() );
-    m_controlconnections = n;
+    // a newer connection may have taken over the id or name already
+    if ( m_controlById.value( conn->id() ) == conn )
+        m_controlById.remove( conn->id() );
+    if ( m_controlByName.value( conn->name() ) == conn )
+        m_controlByName.remove( conn->name() );
+
+    if ( m_controlAddresses.contains( conn ) )
+    {
+        const QString address = m_controlAddresses.take( conn );
+        if ( --m_authedAddresses[ address ] <= 0 )
+            m_authedAddresses.remove( address );
+    }
 }
 
 
 ControlConnection*
 Servent::lookupControlConnection( const QString& name )
 {
-    foreach( ControlConnection* c, m_controlconnections )
-        if( c->name() == name )
-            return c;
-
-    return NULL;
+    QMutexLocker lock( &m_mutex );
+    return m_controlByName.value( name );
 }
 
 
@@ -346,37 +460,19 @@ Servent::readyRead()
 
     tDebug( LOGVERBOSE ) << "Incoming connection details:" << m;
 
+    m_mutex.lock();
     if( !nodeid.isEmpty() ) // only control connections send nodeid
     {
-        bool dupe = false;
-        if ( m_connectedNodes.contains( nodeid ) )
-            dupe = true;
-
-        foreach( ControlConnection* con, m_controlconnections )
-        {
-            tLog( LOGVERBOSE ) << "known connection:" << con->id() << con->source()->friendlyName();
-            if( con->id() == nodeid )
-            {
-                dupe = true;
-                break;
-            }
-        }
-
-        if ( dupe )
+        if ( m_connectedNodes.contains( nodeid ) || m_controlById.contains( nodeid ) )
         {
+            m_mutex.unlock();
             tLog() << "Duplicate control connection detected, dropping:" << nodeid << conntype;
             goto closeconnection;
         }
     }
 
-    foreach( ControlConnection* con, m_controlconnections )
-    {
-        if ( con->id() == controlid )
-        {
-            cc = con;
-            break;
-        }
-    }
+    cc = m_controlById.value( controlid );
+    m_mutex.unlock();
 
     // they connected to us and want something we are offering
     if ( conntype == "accept-offer" || conntype == "push-offer" )
@@ -391,9 +487,13 @@ Servent::readyRead()
         }
         tDebug( LOGVERBOSE ) << "claimOffer OK:" << key << nodeid;
 
-        m_connectedNodes << nodeid;
         if( !nodeid.isEmpty() )
+        {
+            m_mutex.lock();
+            m_connectedNodes.insert( nodeid );
+            m_mutex.unlock();
             conn->setId( nodeid );
+        }
 
         handoverSocket( conn, sock );
         return;
@@ -508,11 +608,9 @@ Servent::socketError( QAbstractSocket::SocketError e )
 }
 
 
-void
+ControlConnection*
 Servent::connectToPeer( const QString& ha, int port, const QString &key, const QString& name, const QString& id )
 {
-    Q_ASSERT( this->thread() == QThread::currentThread() );
-
     ControlConnection* conn = new ControlConnection( this, ha );
     QVariantMap m;
     m["conntype"]  = "accept-offer";
@@ -526,11 +624,17 @@ Servent::connectToPeer( const QString& ha, int port, const QString &key, const Q
     if( id.length() )
         conn->setId( id );
 
-    connectToPeer( ha, port, key, conn );
+    if ( !connectToPeer( ha, port, key, conn ) )
+    {
+        delete conn;
+        return 0;
+    }
+
+    return conn;
 }
 
 
-void
+bool
 Servent::connectToPeer( const QString& ha, int port, const QString &key, Connection* conn )
 {
     tDebug( LOGVERBOSE ) << "Servent::connectToPeer:" << ha << ":" << port
@@ -543,7 +647,7 @@ Servent::connectToPeer( const QString& ha, int port, const QString &key, Connect
          ( port == m_externalPort ) )
     {
         tDebug() << "ERROR: Tomahawk won't try to connect to" << ha << ":" << port << ": identified as ourselves.";
-        return;
+        return false;
     }
 
     if( key.length() && conn->firstMessage().isNull() )
@@ -570,14 +674,14 @@ Servent::connectToPeer( const QString& ha, int port, const QString &key, Connect
     else
         sock->connectToHost( ha, port, QTcpSocket::ReadWrite );
     sock->moveToThread( thread() );
+    return true;
 }
 
 
 void
 Servent::reverseOfferRequest( ControlConnection* orig_conn, const QString& theirdbid, const QString& key, const QString& theirkey )
 {
-    Q_ASSERT( this->thread() == QThread::currentThread() );
-
+    // called by orig_conn from its own thread
     tDebug( LOGVERBOSE ) << "Servent::reverseOfferRequest received for" << key;
     Connection* new_conn = claimOffer( orig_conn, theirdbid, key );
     if ( !new_conn )
@@ -601,6 +705,7 @@ Servent::reverseOfferRequest( ControlConnection* orig_conn, const QString& their
 Connection*
 Servent::claimOffer( ControlConnection* cc, const QString &nodeid, const QString &key, const QHostAddress peer )
 {
+    QMutexLocker lock( &m_mutex );
     bool noauth = qApp->arguments().contains( "--noauth" );
 
     // magic key for stream connections:
@@ -609,16 +714,7 @@ Servent::claimOffer( ControlConnection* cc, const QString &nodeid, const QString
         // check if the source IP matches an existing, authenticated connection
         if ( !noauth && peer != QHostAddress::Any && !isIPWhitelisted( peer ) )
         {
-            bool authed = false;
-            foreach( ControlConnection* cc, m_controlconnections )
-            {
-                if( cc->socket()->peerAddress() == peer )
-                {
-                    authed = true;
-                    break;
-                }
-            }
-            if( !authed )
+            if( !m_authedAddresses.contains( peer.toString() ) )
             {
                 tLog() << "File transfer request rejected, invalid source IP";
                 return NULL;
@@ -632,6 +728,13 @@ Servent::claimOffer( ControlConnection* cc, const QString &nodeid, const QString
 
     if( key == "whitelist" ) // LAN IP address, check source IP
     {
+        // we listen before our sources are loaded, the peer will try again
+        if ( !SourceList::instance()->isReady() )
+        {
+            tDebug() << "Rejecting LAN connection, sources not loaded yet";
+            return NULL;
+        }
+
         if( isIPWhitelisted( peer ) )
         {
             tDebug() << "Connection is from whitelisted IP range (LAN)";
@@ -755,33 +858,86 @@ Servent::checkACL( const Connection* conn, const QString &nodeid, bool showDialo
 }
 
 
+unsigned int
+Servent::numConnectedPeers() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_controlconnections.count();
+}
+
+
+QList< StreamConnection* >
+Servent::streams() const
+{
+    QMutexLocker lock( &m_ftsession_mut );
+    return m_scsessions.toList();
+}
+
+
 QSharedPointer<QIODevice>
 Servent::remoteIODeviceFactory( const result_ptr& result )
 {
     QSharedPointer<QIODevice> sp;
 
+    // without a content hash we can't tell which other copies are identical
+    if ( result->hash().isEmpty() )
+    {
+        StreamConnection* sc = streamFromPeer( result );
+        if ( sc )
+            sp = sc->iodevice();
+
+        return sp;
+    }
+
+    StreamSwarm* swarm = new StreamSwarm( result );
+    if ( !swarm->addPeer( result ) )
+    {
+        swarm->deleteLater();
+        return sp;
+    }
+
+    // other peers join once we know who else has this file
+    QMetaObject::invokeMethod( swarm, "findPeers", Qt::QueuedConnection );
+
+    return swarm->iodevice();
+}
+
+
+StreamConnection*
+Servent::streamFromPeer( const result_ptr& result, StreamSwarm* swarm )
+{
     QStringList parts = result->url().mid( QString( "servent://" ).length() ).split( "\t" );
     const QString sourceName = parts.at( 0 );
     const QString fileId = parts.at( 1 );
     source_ptr s = SourceList::instance()->get( sourceName );
     if ( s.isNull() || !s->controlConnection() )
-        return sp;
+        return 0;
 
     ControlConnection* cc = s->controlConnection();
-    StreamConnection* sc = new StreamConnection( this, cc, fileId, result );
-    createParallelConnection( cc, sc, QString( "FILE_REQUEST_KEY:%1" ).arg( fileId ) );
-    return sc->iodevice();
+    StreamConnection* sc = new StreamConnection( this, cc, fileId, result, swarm );
+
+    // reuse the authed control connection if the peer can multiplex, saves a handshake
+    // and works even when the peer can't connect back to us
+    if ( cc->supportsStreamChannels() )
+        cc->openStream( sc );
+    else
+        createParallelConnection( cc, sc, QString( "FILE_REQUEST_KEY:%1" ).arg( fileId ) );
+
+    // whoever we stream from is worth reconnecting to first
+    ConnectScheduler::instance()->streamedFrom( sourceName );
+
+    return sc;
 }
 
 
 void
 Servent::registerStreamConnection( StreamConnection* sc )
 {
+    QMutexLocker lock( &m_ftsession_mut );
     Q_ASSERT( !m_scsessions.contains( sc ) );
-    tDebug( LOGVERBOSE ) << "Registering Stream" << m_scsessions.length() + 1;
+    tDebug( LOGVERBOSE ) << "Registering Stream" << m_scsessions.count() + 1;
 
-    QMutexLocker lock( &m_ftsession_mut );
-    m_scsessions.append( sc );
+    m_scsessions.insert( sc );
 
     printCurrentTransfers();
     emit streamStarted( sc );
@@ -795,7 +951,7 @@ Servent::onStreamFinished( StreamConnection* sc )
     tDebug( LOGVERBOSE ) << "Stream Finished, unregistering" << sc->id();
 
     QMutexLocker lock( &m_ftsession_mut );
-    m_scsessions.removeAll( sc );
+    m_scsessions.remove( sc );
 
     printCurrentTransfers();
     emit streamFinished( sc );
@@ -843,30 +999,32 @@ Servent::isIPWhitelisted( QHostAddress ip )
 bool
 Servent::connectedToSession( const QString& session )
 {
-    foreach( ControlConnection* cc, m_controlconnections )
-    {
-        if( cc->id() == session )
-            return true;
-    }
-
-    return false;
+    QMutexLocker lock( &m_mutex );
+    return m_controlById.contains( session );
 }
 
 
 void
 Servent::triggerDBSync()
 {
-    // tell peers we have new stuff they should sync
-    QList<source_ptr> sources = SourceList::instance()->sources();
-    foreach( const source_ptr& src, sources )
-    {
-        // skip local source
-        if ( src.isNull() || src->isLocal() )
-            continue;
+    // database commands call this from the db threads, often many times in a row;
+    // one round of notifications covers all changes made until it is sent
+    if ( !m_dbSyncPending.testAndSetOrdered( 0, 1 ) )
+        return;
 
-        if ( src->controlConnection() && src->controlConnection()->dbSyncConnection() ) // source online?
-            src->controlConnection()->dbSyncConnection()->trigger();
-    }
+    QMetaObject::invokeMethod( this, "sendDBSyncTriggers", Qt::QueuedConnection );
+}
+
+
+void
+Servent::sendDBSyncTriggers()
+{
+    m_dbSyncPending = 0;
+
+    // tell peers we have new stuff they should sync, each from its own connection thread
+    QMutexLocker lock( &m_mutex );
+    foreach( ControlConnection* cc, m_controlconnections )
+        QMetaObject::invokeMethod( cc, "triggerDBSync", Qt::QueuedConnection );
 }
 
 
@@ -890,6 +1048,14 @@ Servent::getIODeviceForUrl( const Tomahawk::result_ptr& result )
     if ( !m_iofactories.contains( proto ) )
         return sp;
 
+    // serve remote streams from the local stream cache, if we have a full copy
+    if ( proto != "file" )
+    {
+        sp = StreamCache::instance()->device( StreamCache::keyForResult( result ) );
+        if ( !sp.isNull() )
+            return sp;
+    }
+
     return m_iofactories.value( proto )( result );
 }
 
@@ -911,5 +1077,7 @@ Servent::httpIODeviceFactory( const Tomahawk::result_ptr& result )
 {
     QNetworkRequest req( result->url() );
     QNetworkReply* reply = TomahawkUtils::nam()->get( req );
+    StreamCache::instance()->watchReply( StreamCache::keyForResult( result ), result->size(), reply );
+
     return QSharedPointer<QIODevice>( reply, &QObject::deleteLater );
 }
@@ -22,8 +22,14 @@
 // time before new connection terminates if no auth received
 #define AUTH_TIMEOUT 180000
 
+// upper bound for the threads peer connections are spread over
+#define MAX_NETWORK_THREADS 4
+
 #include <QtCore/QObject>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QMutex>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
@@ -47,9 +53,11 @@ class Connection;
 class Connector;
 class ControlConnection;
 class StreamConnection;
+class StreamSwarm;
 class ProxyConnection;
 class RemoteCollectionConnection;
 class PortFwdThread;
+class QThread;
 
 // this is used to hold a bit of state, so when a connected signal is emitted
 // from a socket, we can associate it with a Connection object etc.
@@ -86,10 +94,17 @@ Q_OBJECT
 public:
     static Servent* instance();
 
-    explicit Servent( QObject* parent = 0 );
+    // the servent lives on its own network thread, so it can't have a parent
+    Servent();
     virtual ~Servent();
 
-    bool startListening( QHostAddress ha, bool upnp, int port );
+    Q_INVOKABLE bool startListening( QHostAddress ha, bool upnp, int port );
+    // stops listening and joins the network threads, call before deleting the servent
+    Q_INVOKABLE void stop();
+
+    // network thread a new connection should run on, spread round robin
+    QThread* connectionThread();
+    bool isNetworkThread( QThread* thread ) const;
 
     int port() const { return m_port; }
 
@@ -102,8 +117,9 @@ public:
     void unregisterControlConnection( ControlConnection* conn );
     ControlConnection* lookupControlConnection( const QString& name );
 
-    void connectToPeer( const QString& ha, int port, const QString &key, const QString& name = "", const QString& id = "" );
-    void connectToPeer( const QString& ha, int port, const QString &key, Connection* conn );
+    // returns the new connection, or 0 if ha:port is ourselves
+    ControlConnection* connectToPeer( const QString& ha, int port, const QString &key, const QString& name = "", const QString& id = "" );
+    bool connectToPeer( const QString& ha, int port, const QString &key, Connection* conn );
     void reverseOfferRequest( ControlConnection* orig_conn, const QString &theirdbid, const QString& key, const QString& theirkey );
 
     bool visibleExternally() const { return !m_externalHostname.isNull() || (m_externalPort > 0 && !m_externalAddress.isNull()); }
@@ -111,12 +127,14 @@ public:
     int externalPort() const { return m_externalPort; }
 
     QSharedPointer<QIODevice> remoteIODeviceFactory( const Tomahawk::result_ptr& );
+    // starts receiving result from its peer, into swarm's buffer if given
+    StreamConnection* streamFromPeer( const Tomahawk::result_ptr& result, StreamSwarm* swarm = 0 );
     static bool isIPWhitelisted( QHostAddress ip );
 
     bool connectedToSession( const QString& session );
-    unsigned int numConnectedPeers() const { return m_controlconnections.length(); }
+    unsigned int numConnectedPeers() const;
 
-    QList< StreamConnection* > streams() const { return m_scsessions; }
+    QList< StreamConnection* > streams() const;
 
     QSharedPointer<QIODevice> getIODeviceForUrl( const Tomahawk::result_ptr& result );
     void registerIODeviceFactory( const QString &proto, boost::function<QSharedPointer<QIODevice>(Tomahawk::result_ptr)> fac );
@@ -148,6 +166,7 @@ public slots:
 
 private slots:
     void readyRead();
+    void sendDBSyncTriggers();
 
     Connection* claimOffer( ControlConnection* cc, const QString &nodeid, const QString &key, const QHostAddress peer = QHostAddress::Any );
 
@@ -158,9 +177,21 @@ private:
     void printCurrentTransfers();
 
     QJson::Parser parser;
-    QList< ControlConnection* > m_controlconnections; // canonical list of authed peers
-    QMap< QString, QWeakPointer<Connection> > m_offers;
-    QStringList m_connectedNodes;
+    // the servent doesn't own any of these, connections delete themselves and unregister first
+    QSet< ControlConnection* > m_controlconnections; // canonical set of authed peers
+    QHash< QString, ControlConnection* > m_controlById;
+    QHash< QString, ControlConnection* > m_controlByName;
+    QHash< ControlConnection*, QString > m_controlAddresses; // peer ip each was registered with
+    QHash< QString, int > m_authedAddresses; // peer ip -> number of authed connections from it
+    QHash< QString, QWeakPointer<Connection> > m_offers;
+    int m_offersPruneAt;
+    QSet< QString > m_connectedNodes;
+    // guards the above, connections register themselves from their own threads
+    mutable QMutex m_mutex;
+
+    QList< QThread* > m_threads;
+    QAtomicInt m_nextThread;
+    QAtomicInt m_dbSyncPending;
 
     int m_port, m_externalPort;
     QHostAddress m_externalAddress;
@@ -169,8 +200,8 @@ private:
     bool m_lanHack;
 
     // currently active file transfers:
-    QList< StreamConnection* > m_scsessions;
-    QMutex m_ftsession_mut;
+    QSet< StreamConnection* > m_scsessions;
+    mutable QMutex m_ftsession_mut;
 
     QMap< QString,boost::function<QSharedPointer<QIODevice>(Tomahawk::result_ptr)> > m_iofactories;
 
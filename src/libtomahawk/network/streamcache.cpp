@@ -0,0 +1,524 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "streamcache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+#include <QtNetwork/QNetworkReply>
+
+#include "result.h"
+#include "bufferiodevice.h"
+#include "tomahawksettings.h"
+#include "utils/logger.h"
+
+#define STREAMCACHE_VERSION 1
+// blocks written to an entry before its index is saved again, so a crash doesn't lose partial entries
+#define INDEX_SAVE_BLOCKS 256
+// data files we keep open for writing at once
+#define MAX_WRITERS 16
+
+StreamCache* StreamCache::s_instance = 0;
+
+
+StreamCache*
+StreamCache::instance()
+{
+    return s_instance;
+}
+
+
+StreamCache::StreamCache( QObject* parent )
+    : QObject( parent )
+    , m_cacheDir( TomahawkSettings::instance()->storageCacheLocation() + "/StreamCache/" )
+    , m_maxSize( TomahawkSettings::instance()->streamCacheSize() )
+    , m_size( 0 )
+{
+    s_instance = this;
+
+    QDir dir( m_cacheDir );
+    if ( !dir.exists() && !dir.mkpath( m_cacheDir ) )
+        tLog() << "Failed to create stream cache dir:" << m_cacheDir;
+
+    loadIndex();
+    tDebug() << "Stream cache holds" << m_entries.count() << "entries," << m_size << "bytes";
+}
+
+
+StreamCache::~StreamCache()
+{
+    QMutexLocker lock( &m_mutex );
+    foreach ( const QString& key, m_writers.keys() )
+        closeWriter( key );
+
+    foreach ( const Entry& entry, m_entries )
+        saveEntry( entry );
+
+    s_instance = 0;
+}
+
+
+QString
+StreamCache::keyForResult( const Tomahawk::result_ptr& result )
+{
+    // a peer re-scanning its files can re-use file ids, so size and mtime are part of the key
+    return QString( "%1\t%2\t%3" ).arg( result->url() ).arg( result->size() ).arg( result->modificationTime() );
+}
+
+
+qint64
+StreamCache::maxSize() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_maxSize;
+}
+
+
+void
+StreamCache::setMaxSize( qint64 bytes )
+{
+    QMutexLocker lock( &m_mutex );
+    m_maxSize = bytes;
+    evict();
+}
+
+
+qint64
+StreamCache::currentSize() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_size;
+}
+
+
+bool
+StreamCache::contains( const QString& key ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_entries.contains( key );
+}
+
+
+bool
+StreamCache::isComplete( const QString& key ) const
+{
+    QMutexLocker lock( &m_mutex );
+    if ( !m_entries.contains( key ) )
+        return false;
+
+    return isEntryComplete( m_entries[ key ] );
+}
+
+
+QSharedPointer<QIODevice>
+StreamCache::device( const QString& key )
+{
+    QMutexLocker lock( &m_mutex );
+
+    QSharedPointer<QIODevice> sp;
+    if ( !m_entries.contains( key ) || !isEntryComplete( m_entries[ key ] ) )
+        return sp;
+
+    Entry& entry = m_entries[ key ];
+    touch( entry );
+
+    QFile* file = new QFile( dataPath( entry ) );
+    if ( !file->open( QIODevice::ReadOnly ) || file->size() < entry.size )
+    {
+        tLog() << "Stream cache entry is damaged, dropping it:" << key;
+        delete file;
+        removeEntry( key );
+        return sp;
+    }
+
+    tDebug( LOGVERBOSE ) << "Serving stream from cache:" << key;
+    return QSharedPointer<QIODevice>( file, &QObject::deleteLater );
+}
+
+
+QList<int>
+StreamCache::cachedBlocks( const QString& key ) const
+{
+    QMutexLocker lock( &m_mutex );
+
+    QList<int> blocks;
+    if ( !m_entries.contains( key ) )
+        return blocks;
+
+    const QBitArray& bits = m_entries[ key ].blocks;
+    for ( int i = 0; i < bits.size(); i++ )
+    {
+        if ( bits.testBit( i ) )
+            blocks << i;
+    }
+
+    return blocks;
+}
+
+
+QByteArray
+StreamCache::readBlock( const QString& key, int block ) const
+{
+    QMutexLocker lock( &m_mutex );
+
+    if ( !m_entries.contains( key ) )
+        return QByteArray();
+
+    const Entry& entry = m_entries[ key ];
+    if ( block >= entry.blocks.size() || !entry.blocks.testBit( block ) )
+        return QByteArray();
+
+    // the entry may still be written to, flush so we read what we've marked as cached
+    QFile* w = m_writers.value( key );
+    if ( w )
+        w->flush();
+
+    QFile file( dataPath( entry ) );
+    if ( !file.open( QIODevice::ReadOnly ) || !file.seek( (qint64)block * BufferIODevice::blockSize() ) )
+        return QByteArray();
+
+    return file.read( BufferIODevice::blockSize() );
+}
+
+
+void
+StreamCache::writeBlock( const QString& key, qint64 size, int block, const QByteArray& data )
+{
+    const qint64 offset = (qint64)block * BufferIODevice::blockSize();
+    writeData( key, size, offset, data, offset );
+}
+
+
+void
+StreamCache::watchReply( const QString& key, qint64 size, QNetworkReply* reply )
+{
+    QMutexLocker lock( &m_mutex );
+
+    // a fresh download always starts at offset 0, so throw away whatever we had
+    if ( m_entries.contains( key ) )
+        removeEntry( key );
+
+    m_replies.insert( reply, qMakePair( key, size ) );
+    m_replyOffsets.insert( reply, 0 );
+
+    // Qt emits downloadProgress right after readyRead. The player pulls data on demand, so the new
+    // data is usually still buffered then; if it got read first, onReplyProgress gives up on the entry
+    connect( reply, SIGNAL( downloadProgress( qint64, qint64 ) ), SLOT( onReplyProgress( qint64, qint64 ) ) );
+    connect( reply, SIGNAL( destroyed( QObject* ) ), SLOT( onReplyDestroyed( QObject* ) ) );
+}
+
+
+void
+StreamCache::remove( const QString& key )
+{
+    QMutexLocker lock( &m_mutex );
+    removeEntry( key );
+}
+
+
+void
+StreamCache::onReplyProgress( qint64 received, qint64 total )
+{
+    QNetworkReply* reply = qobject_cast< QNetworkReply* >( sender() );
+    if ( !reply || !m_replies.contains( reply ) || reply->error() != QNetworkReply::NoError )
+        return;
+
+    const QString key = m_replies[ reply ].first;
+    const qint64 size = m_replies[ reply ].second > 0 ? m_replies[ reply ].second : total;
+    const qint64 written = m_replyOffsets.value( reply );
+    if ( size <= 0 || received <= written )
+        return;
+
+    const QByteArray buffered = reply->peek( reply->bytesAvailable() );
+    const qint64 fresh = received - written;
+    if ( buffered.length() < fresh )
+    {
+        // someone consumed data before we saw it, we can't fill this entry anymore
+        tDebug( LOGVERBOSE ) << "Lost track of http stream, not caching:" << key;
+        onReplyDestroyed( reply );
+        remove( key );
+        return;
+    }
+
+    writeData( key, size, written, buffered.right( fresh ), 0 );
+    m_replyOffsets[ reply ] = received;
+}
+
+
+void
+StreamCache::onReplyDestroyed( QObject* reply )
+{
+    m_replies.remove( reply );
+    m_replyOffsets.remove( reply );
+}
+
+
+void
+StreamCache::writeData( const QString& key, qint64 size, qint64 offset, const QByteArray& data, qint64 coveredFrom )
+{
+    if ( size <= 0 || data.isEmpty() )
+        return;
+
+    QMutexLocker lock( &m_mutex );
+    if ( size > m_maxSize )
+        return;
+
+    const qint64 bs = BufferIODevice::blockSize();
+    const int blockCount = ( size + bs - 1 ) / bs;
+
+    if ( !m_entries.contains( key ) )
+    {
+        Entry entry;
+        entry.key = key;
+        entry.hash = keyHash( key );
+        entry.size = size;
+        entry.stored = 0;
+        entry.blocks = QBitArray( blockCount );
+        entry.unsaved = 0;
+        touch( entry );
+        m_entries.insert( key, entry );
+    }
+
+    Entry& entry = m_entries[ key ];
+    if ( entry.size != size )
+    {
+        tLog() << "Stream cache size mismatch, dropping entry:" << key << entry.size << size;
+        removeEntry( key );
+        return;
+    }
+
+    QFile* file = writer( entry );
+    if ( !file || !file->seek( offset ) || file->write( data ) != data.length() )
+    {
+        tLog() << "Failed writing to stream cache:" << dataPath( entry ) << ( file ? file->errorString() : QString() );
+        closeWriter( key );
+        return;
+    }
+
+    // only mark blocks which are covered entirely by [coveredFrom, offset + length)
+    const qint64 end = offset + data.length();
+    int first = ( coveredFrom + bs - 1 ) / bs;
+    int last = ( end == size ) ? blockCount - 1 : ( end / bs ) - 1;
+    for ( int i = first; i <= last && i < blockCount; i++ )
+    {
+        if ( entry.blocks.testBit( i ) )
+            continue;
+
+        entry.blocks.setBit( i );
+        entry.unsaved++;
+        const qint64 len = ( i == blockCount - 1 ) ? size - (qint64)i * bs : bs;
+        entry.stored += len;
+        m_size += len;
+    }
+
+    touch( entry );
+    if ( isEntryComplete( entry ) )
+    {
+        tDebug( LOGVERBOSE ) << "Stream cache entry complete:" << key;
+        closeWriter( key );
+        saveEntry( entry );
+        entry.unsaved = 0;
+    }
+    else if ( entry.unsaved >= INDEX_SAVE_BLOCKS )
+    {
+        // the index must never claim blocks that are still in QFile's buffer
+        file->flush();
+        saveEntry( entry );
+        entry.unsaved = 0;
+    }
+
+    evict();
+}
+
+
+void
+StreamCache::loadIndex()
+{
+    QDir dir( m_cacheDir );
+    foreach ( const QFileInfo& fi, dir.entryInfoList( QStringList() << "*.index", QDir::Files ) )
+    {
+        QFile file( fi.absoluteFilePath() );
+        if ( !file.open( QIODevice::ReadOnly ) )
+            continue;
+
+        QDataStream stream( &file );
+        quint32 version;
+        Entry entry;
+        entry.unsaved = 0;
+        stream >> version;
+        if ( version == STREAMCACHE_VERSION )
+            stream >> entry.key >> entry.size >> entry.stored >> entry.lastAccess >> entry.blocks;
+        file.close();
+
+        entry.hash = fi.baseName();
+        if ( version != STREAMCACHE_VERSION || stream.status() != QDataStream::Ok ||
+             entry.hash != keyHash( entry.key ) || !QFile::exists( dataPath( entry ) ) )
+        {
+            tDebug() << "Removing invalid stream cache entry:" << fi.baseName();
+            QFile::remove( fi.absoluteFilePath() );
+            QFile::remove( m_cacheDir + fi.baseName() + ".data" );
+            continue;
+        }
+
+        m_entries.insert( entry.key, entry );
+        m_size += entry.stored;
+    }
+
+    // clean up data files whose index never got written, e.g. after a crash
+    foreach ( const QFileInfo& fi, dir.entryInfoList( QStringList() << "*.data", QDir::Files ) )
+    {
+        if ( !QFile::exists( m_cacheDir + fi.baseName() + ".index" ) )
+            QFile::remove( fi.absoluteFilePath() );
+    }
+
+    evict();
+}
+
+
+void
+StreamCache::saveEntry( const Entry& entry ) const
+{
+    QFile file( indexPath( entry ) );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        tLog() << "Failed writing stream cache index:" << file.fileName();
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream << (quint32)STREAMCACHE_VERSION << entry.key << entry.size << entry.stored << entry.lastAccess << entry.blocks;
+}
+
+
+void
+StreamCache::removeEntry( const QString& key )
+{
+    if ( !m_entries.contains( key ) )
+        return;
+
+    closeWriter( key );
+
+    const Entry entry = m_entries.take( key );
+    m_size -= entry.stored;
+
+    QFile::remove( dataPath( entry ) );
+    QFile::remove( indexPath( entry ) );
+}
+
+
+QFile*
+StreamCache::writer( const Entry& entry )
+{
+    QFile* file = m_writers.value( entry.key );
+    if ( file )
+        return file;
+
+    // too many transfers at once, the one we close is re-opened on its next block
+    if ( m_writers.count() >= MAX_WRITERS )
+        closeWriter( m_writers.constBegin().key() );
+
+    file = new QFile( dataPath( entry ) );
+    if ( !file->open( QIODevice::ReadWrite ) )
+    {
+        delete file;
+        return 0;
+    }
+
+    m_writers.insert( entry.key, file );
+    return file;
+}
+
+
+void
+StreamCache::closeWriter( const QString& key )
+{
+    QFile* file = m_writers.take( key );
+    if ( !file )
+        return;
+
+    file->close();
+    delete file;
+
+    // what's on disk now matches the blocks we marked
+    if ( m_entries.contains( key ) && m_entries[ key ].unsaved )
+    {
+        saveEntry( m_entries[ key ] );
+        m_entries[ key ].unsaved = 0;
+    }
+}
+
+
+void
+StreamCache::touch( Entry& entry )
+{
+    entry.lastAccess = QDateTime::currentMSecsSinceEpoch();
+}
+
+
+void
+StreamCache::evict()
+{
+    while ( m_size > m_maxSize && !m_entries.isEmpty() )
+    {
+        QString oldest;
+        qint64 oldestAccess = 0;
+        foreach ( const Entry& entry, m_entries )
+        {
+            if ( oldest.isEmpty() || entry.lastAccess < oldestAccess )
+            {
+                oldest = entry.key;
+                oldestAccess = entry.lastAccess;
+            }
+        }
+
+        tDebug( LOGVERBOSE ) << "Evicting stream cache entry:" << oldest;
+        removeEntry( oldest );
+    }
+}
+
+
+QString
+StreamCache::dataPath( const Entry& entry ) const
+{
+    return m_cacheDir + entry.hash + ".data";
+}
+
+
+QString
+StreamCache::indexPath( const Entry& entry ) const
+{
+    return m_cacheDir + entry.hash + ".index";
+}
+
+
+QString
+StreamCache::keyHash( const QString& key )
+{
+    return QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Md5 ).toHex();
+}
+
+
+bool
+StreamCache::isEntryComplete( const Entry& entry )
+{
+    return entry.blocks.count( true ) == entry.blocks.size();
+}
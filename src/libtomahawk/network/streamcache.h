@@ -0,0 +1,117 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAMCACHE_H
+#define STREAMCACHE_H
+
+#include <QtCore/QObject>
+#include <QtCore/QBitArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QIODevice>
+
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+class QFile;
+class QNetworkReply;
+
+/**
+ * Size-bounded on-disk LRU cache for streamed audio.
+ *
+ * Entries are keyed by the stream url (servent://source\tfileid or http://...)
+ * plus size and mtime of the result, and are stored block-wise, so partially
+ * transferred files can be resumed from the first missing block.
+ */
+class DLLEXPORT StreamCache : public QObject
+{
+Q_OBJECT
+
+public:
+    static StreamCache* instance();
+
+    explicit StreamCache( QObject* parent = 0 );
+    virtual ~StreamCache();
+
+    static QString keyForResult( const Tomahawk::result_ptr& result );
+
+    qint64 maxSize() const;
+    void setMaxSize( qint64 bytes );
+    qint64 currentSize() const;
+
+    bool contains( const QString& key ) const;
+    bool isComplete( const QString& key ) const;
+
+    // returns an opened device on the cached data, or a null pointer if the entry is incomplete
+    QSharedPointer<QIODevice> device( const QString& key );
+
+    QList<int> cachedBlocks( const QString& key ) const;
+    QByteArray readBlock( const QString& key, int block ) const;
+    void writeBlock( const QString& key, qint64 size, int block, const QByteArray& data );
+
+    // tees everything downloaded by reply into the entry for key
+    void watchReply( const QString& key, qint64 size, QNetworkReply* reply );
+
+    void remove( const QString& key );
+
+private slots:
+    void onReplyProgress( qint64 received, qint64 total );
+    void onReplyDestroyed( QObject* reply );
+
+private:
+    struct Entry
+    {
+        QString key;
+        QString hash;
+        qint64 size;
+        qint64 stored;
+        qint64 lastAccess;
+        QBitArray blocks;
+        int unsaved; // blocks written since the index was last saved
+    };
+
+    void loadIndex();
+    void saveEntry( const Entry& entry ) const;
+    void removeEntry( const QString& key );
+    QFile* writer( const Entry& entry );
+    void closeWriter( const QString& key );
+    void writeData( const QString& key, qint64 size, qint64 offset, const QByteArray& data, qint64 coveredFrom );
+    void touch( Entry& entry );
+    void evict();
+
+    QString dataPath( const Entry& entry ) const;
+    QString indexPath( const Entry& entry ) const;
+    static QString keyHash( const QString& key );
+    static bool isEntryComplete( const Entry& entry );
+
+    QString m_cacheDir;
+    qint64 m_maxSize;
+    qint64 m_size;
+
+    QHash< QString, Entry > m_entries;
+    QHash< QString, QFile* > m_writers; // open data files of the entries being written
+    QHash< QObject*, QPair< QString, qint64 > > m_replies; // reply -> ( key, expected size )
+    QHash< QObject*, qint64 > m_replyOffsets; // reply -> bytes written to the cache so far
+    mutable QMutex m_mutex;
+
+    static StreamCache* s_instance;
+};
+
+#endif // STREAMCACHE_H
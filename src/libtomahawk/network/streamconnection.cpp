@@ -23,6 +23,9 @@
 #include "result.h"
 
 #include "bufferiodevice.h"
+#include "streamcache.h"
+#include "uploadscheduler.h"
+#include "streamswarm.h"
 #include "network/controlconnection.h"
 #include "network/servent.h"
 #include "database/databasecommand_loadfiles.h"
@@ -33,30 +36,54 @@
 using namespace Tomahawk;
 
 
-StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString fid, const Tomahawk::result_ptr& result )
-    : Connection( s )
+StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString fid, const Tomahawk::result_ptr& result, StreamSwarm* swarm )
+    : Connection( s, cc ? cc->thread() : 0 )
     , m_cc( cc )
     , m_fid( fid )
     , m_type( RECEIVING )
     , m_curBlock( 0 )
+    , m_seekBlock( -1 )
+    , m_requestedBlock( -1 )
+    , m_swarm( swarm )
     , m_badded( 0 )
     , m_bsent( 0 )
     , m_allok( false )
     , m_result( result )
     , m_transferRate( 0 )
+    , m_channel( 0 )
+    , m_channelOpen( false )
+    , m_credit( 0 )
+    , m_stalled( false )
+    , m_channelStatsTimer( 0 )
+    , m_badded_last( 0 )
+    , m_bsent_last( 0 )
 {
     qDebug() << Q_FUNC_INFO;
 
-    BufferIODevice* bio = new BufferIODevice( result->size() );
-    m_iodev = QSharedPointer<QIODevice>( bio, &QObject::deleteLater ); // device audio data gets written to
-    m_iodev->open( QIODevice::ReadWrite );
+    if ( m_swarm )
+    {
+        // several peers share the swarm's buffer, it routes seeks to one of them
+        m_iodev = m_swarm->iodevice();
+        m_cacheKey = m_swarm->cacheKey();
+    }
+    else
+    {
+        BufferIODevice* bio = new BufferIODevice( result->size() );
+        m_iodev = QSharedPointer<QIODevice>( bio, &QObject::deleteLater ); // device audio data gets written to
+        m_iodev->open( QIODevice::ReadWrite );
+
+        // whatever blocks of this file we already have on disk are read once the player gets there
+        m_cacheKey = StreamCache::keyForResult( result );
+        bio->setCachedBlocks( m_cacheKey, StreamCache::instance()->cachedBlocks( m_cacheKey ) );
+
+        connect( m_iodev.data(), SIGNAL( blockRequest( int ) ), SLOT( onBlockRequest( int ) ) );
+    }
 
     Servent::instance()->registerStreamConnection( this );
 
     // if the audioengine closes the iodev (skip/stop/etc) then kill the connection
     // immediately to avoid unnecessary network transfer
     connect( m_iodev.data(), SIGNAL( aboutToClose() ), SLOT( shutdown() ), Qt::QueuedConnection );
-    connect( m_iodev.data(), SIGNAL( blockRequest( int ) ), SLOT( onBlockRequest( int ) ) );
 
     // auto delete when connection closes:
     connect( this, SIGNAL( finished() ), SLOT( deleteLater() ), Qt::QueuedConnection );
@@ -68,14 +95,25 @@ StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString f
 
 
 StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString fid )
-    : Connection( s )
+    : Connection( s, cc ? cc->thread() : 0 )
     , m_cc( cc )
     , m_fid( fid )
     , m_type( SENDING )
+    , m_curBlock( 0 )
+    , m_seekBlock( -1 )
+    , m_requestedBlock( -1 )
+    , m_swarm( 0 )
     , m_badded( 0 )
     , m_bsent( 0 )
     , m_allok( false )
     , m_transferRate( 0 )
+    , m_channel( 0 )
+    , m_channelOpen( false )
+    , m_credit( 0 )
+    , m_stalled( false )
+    , m_channelStatsTimer( 0 )
+    , m_badded_last( 0 )
+    , m_bsent_last( 0 )
 {
     Servent::instance()->registerStreamConnection( this );
     // auto delete when connection closes:
@@ -86,7 +124,12 @@ StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString f
 StreamConnection::~StreamConnection()
 {
     qDebug() << Q_FUNC_INFO << "TX/RX:" << bytesSent() << bytesReceived();
-    if( m_type == RECEIVING && !m_allok )
+    if ( m_swarm )
+    {
+        // the swarm decides whether another peer takes over
+        m_swarm->peerFinished( this, m_allok );
+    }
+    else if( m_type == RECEIVING && !m_allok )
     {
         qDebug() << "FTConnection closing before last data msg received, shame.";
         //TODO log the fact that our peer was bad-mannered enough to not finish the upload
@@ -97,6 +140,13 @@ StreamConnection::~StreamConnection()
         ((BufferIODevice*)m_iodev.data())->inputComplete();
     }
 
+    // let the peer know, so it stops sending
+    if ( m_channelOpen && m_cc )
+        m_cc->closeStream( m_channel );
+
+    if ( m_type == SENDING && UploadScheduler::instance() )
+        UploadScheduler::instance()->remove( this );
+
     Servent::instance()->onStreamFinished( this );
 }
 
@@ -131,6 +181,84 @@ StreamConnection::showStats( qint64 tx, qint64 rx )
 }
 
 
+void
+StreamConnection::startChannel( quint32 channel, int credit )
+{
+    Q_ASSERT( m_cc );
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << id() << "on channel" << channel;
+
+    m_channel = channel;
+    m_channelOpen = true;
+    m_credit = credit;
+
+    setName( m_cc->name() );
+
+    // without a socket of our own, Connection can't measure the transfer rate for us
+    m_channelStatsTimer = new QTimer( this );
+    m_channelStatsTimer->setInterval( 1000 );
+    connect( m_channelStatsTimer, SIGNAL( timeout() ), SLOT( onChannelStatsTimer() ) );
+    m_channelStatsTimer->start();
+
+    // the control connection is authed already, so there's no handshake to wait for
+    m_ready = true;
+    setup();
+}
+
+
+void
+StreamConnection::receiveChannelMsg( msg_ptr msg )
+{
+    if ( msg->payload().startsWith( "credit" ) )
+    {
+        m_credit += QString( msg->payload() ).mid( 6 ).toInt();
+
+        if ( m_stalled )
+        {
+            m_stalled = false;
+            QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+        }
+        return;
+    }
+
+    handleMsg( msg );
+}
+
+
+void
+StreamConnection::channelClosed()
+{
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << id();
+
+    m_channelOpen = false;
+    m_cc = 0;
+    shutdown();
+}
+
+
+void
+StreamConnection::onChannelStatsTimer()
+{
+    showStats( m_bsent - m_bsent_last, m_badded - m_badded_last );
+
+    m_bsent_last = m_bsent;
+    m_badded_last = m_badded;
+}
+
+
+void
+StreamConnection::sendStreamMsg( const QByteArray& payload, bool fragment )
+{
+    if ( isMultiplexed() )
+    {
+        if ( m_channelOpen && m_cc )
+            m_cc->sendStreamMsg( m_channel, payload, fragment );
+        return;
+    }
+
+    sendMsg( Msg::factory( payload, fragment ? Msg::RAW | Msg::FRAGMENT : Msg::RAW ) );
+}
+
+
 void
 StreamConnection::setup()
 {
@@ -152,6 +280,18 @@ StreamConnection::setup()
     if( m_type == RECEIVING )
     {
         qDebug() << "in RX mode";
+
+        // skip ahead to the first block missing from our stream cache, or to our part of the swarm
+        const int block = m_swarm ? m_swarm->startBlock( this ) : ((BufferIODevice*)m_iodev.data())->nextEmptyBlock();
+        if ( block > 0 )
+            onBlockRequest( block );
+        else if ( block < 0 && m_swarm )
+        {
+            // the others have fetched everything already
+            shutdown();
+            return;
+        }
+
         emit updated();
         return;
     }
@@ -186,6 +326,15 @@ StreamConnection::startSending( const Tomahawk::result_ptr& result )
     }
 
     m_readdev = QSharedPointer<QIODevice>( io );
+    m_sendStarted.start();
+
+    // the receiver asked for a block before we had opened the file
+    if ( m_seekBlock >= 0 )
+    {
+        seekToBlock( m_seekBlock );
+        m_seekBlock = -1;
+    }
+
     sendSome();
 
     emit updated();
@@ -200,15 +349,15 @@ StreamConnection::handleMsg( msg_ptr msg )
     if ( msg->payload().startsWith( "block" ) )
     {
         int block = QString( msg->payload() ).mid( 5 ).toInt();
-        m_readdev->seek( block * BufferIODevice::blockSize() );
-
-        qDebug() << "Seeked to block:" << block;
-
-        QByteArray sm;
-        sm.append( QString( "doneblock%1" ).arg( block ) );
+        if ( m_readdev.isNull() )
+        {
+            m_seekBlock = block;
+            return;
+        }
 
-        sendMsg( Msg::factory( sm, Msg::RAW | Msg::FRAGMENT ) );
+        seekToBlock( block );
         QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+        return;
     }
     else if ( msg->payload().startsWith( "doneblock" ) )
     {
@@ -216,12 +365,36 @@ StreamConnection::handleMsg( msg_ptr msg )
         ((BufferIODevice*)m_iodev.data())->seeked( block );
 
         m_curBlock = block;
+        if ( m_requestedBlock == block )
+            m_requestedBlock = -1;
         qDebug() << "Next block is now:" << block;
     }
     else if ( msg->payload().startsWith( "data" ) )
     {
         m_badded += msg->payload().length() - 4;
-        ((BufferIODevice*)m_iodev.data())->addData( m_curBlock++, msg->payload().mid( 4 ) );
+
+        const QByteArray data = msg->payload().mid( 4 );
+        BufferIODevice* bio = (BufferIODevice*)m_iodev.data();
+        if ( bio->isBlockEmpty( m_curBlock ) )
+        {
+            StreamCache::instance()->writeBlock( m_cacheKey, m_result->size(), m_curBlock, data );
+            bio->addData( m_curBlock, data );
+        }
+        else if ( m_swarm && m_requestedBlock < 0 )
+        {
+            // another peer got here first, move on to what's still missing
+            const int block = m_swarm->nextBlock( this );
+            if ( block >= 0 )
+                onBlockRequest( block );
+        }
+        m_curBlock++;
+
+        // grant the sender more blocks once it used up half of its window
+        if ( isMultiplexed() && ++m_credit >= STREAM_CHANNEL_WINDOW / 2 )
+        {
+            sendStreamMsg( QString( "credit%1" ).arg( m_credit ).toAscii(), true );
+            m_credit = 0;
+        }
     }
 
     //qDebug() << Q_FUNC_INFO << "flags" << (int) msg->flags()
@@ -251,24 +424,100 @@ StreamConnection::sendSome()
 {
     Q_ASSERT( m_type == StreamConnection::SENDING );
 
+    // with an upload limit, the scheduler decides when it's our turn
+    if ( UploadScheduler::instance()->isLimited() )
+    {
+        UploadScheduler::instance()->wantsToSend( this );
+        return;
+    }
+
+    if ( sendBlock() )
+        QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+}
+
+
+void
+StreamConnection::sendGranted( int blocks )
+{
+    bool more = true;
+    for ( int i = 0; i < blocks && more; i++ )
+        more = sendBlock();
+
+    // the limit may have been lifted while this grant was queued, sendSome() knows
+    if ( more )
+        sendSome();
+}
+
+
+bool
+StreamConnection::sendBlock()
+{
+    Q_ASSERT( m_type == StreamConnection::SENDING );
+
+    if ( m_readdev.isNull() )
+        return false;
+
+    if ( isMultiplexed() )
+    {
+        if ( !m_channelOpen )
+            return false;
+
+        // wait until the receiver has room for more
+        if ( m_credit <= 0 )
+        {
+            m_stalled = true;
+            return false;
+        }
+
+        // don't queue up audio in front of pings and other control msgs on the shared socket
+        if ( m_cc->bytesToWrite() > STREAM_CHANNEL_BACKLOG )
+        {
+            QTimer::singleShot( 10, this, SLOT( sendSome() ) );
+            return false;
+        }
+
+        m_credit--;
+    }
+
     QByteArray ba = "data";
     ba.append( m_readdev->read( BufferIODevice::blockSize() ) );
     m_bsent += ba.length() - 4;
 
     if( m_readdev->atEnd() )
     {
-        sendMsg( Msg::factory( ba, Msg::RAW ) );
-        return;
-    }
-    else
-    {
-        // more to come -> FRAGMENT
-        sendMsg( Msg::factory( ba, Msg::RAW | Msg::FRAGMENT ) );
+        sendStreamMsg( ba, false );
+        return false;
     }
 
-    // HINT: change the 0 to 50 to transmit at 640Kbps, for example
-    //       (this is where upload throttling could be implemented)
-    QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+    // more to come -> FRAGMENT
+    sendStreamMsg( ba, true );
+    return true;
+}
+
+
+double
+StreamConnection::headroom() const
+{
+    if ( m_type != SENDING || m_result.isNull() || !m_result->duration() || !m_result->size() )
+        return 3600.0; // unknown bitrate, don't let it jump the queue
+
+    // assume the peer started playing right away and listens in real time
+    const double bytesPerSecond = (double)m_result->size() / m_result->duration();
+    return m_bsent / bytesPerSecond - m_sendStarted.elapsed() / 1000.0;
+}
+
+
+void
+StreamConnection::seekToBlock( int block )
+{
+    m_readdev->seek( block * BufferIODevice::blockSize() );
+
+    qDebug() << "Seeked to block:" << block;
+
+    QByteArray sm;
+    sm.append( QString( "doneblock%1" ).arg( block ) );
+
+    sendStreamMsg( sm, true );
 }
 
 
@@ -280,8 +529,10 @@ StreamConnection::onBlockRequest( int block )
     if ( m_curBlock == block )
         return;
 
+    m_requestedBlock = block;
+
     QByteArray sm;
     sm.append( QString( "block%1" ).arg( block ) );
 
-    sendMsg( Msg::factory( sm, Msg::RAW | Msg::FRAGMENT ) );
+    sendStreamMsg( sm, true );
 }
@@ -22,14 +22,21 @@
 #include <QObject>
 #include <QSharedPointer>
 #include <QIODevice>
+#include <QTime>
 
 #include "network/connection.h"
 #include "result.h"
 
 #include "dllmacro.h"
 
+// blocks a multiplexed sender may send before the receiver grants it more
+#define STREAM_CHANNEL_WINDOW 32
+// bytes a multiplexed sender lets pile up on the shared socket, keeps control msgs flowing
+#define STREAM_CHANNEL_BACKLOG 65536
+
 class ControlConnection;
 class BufferIODevice;
+class StreamSwarm;
 
 class DLLEXPORT StreamConnection : public Connection
 {
@@ -42,8 +49,8 @@ public:
         RECEIVING = 1
     };
 
-    // RX:
-    explicit StreamConnection( Servent* s, ControlConnection* cc, QString fid, const Tomahawk::result_ptr& result );
+    // RX, writing into swarm's buffer if given:
+    explicit StreamConnection( Servent* s, ControlConnection* cc, QString fid, const Tomahawk::result_ptr& result, StreamSwarm* swarm = 0 );
     // TX:
     explicit StreamConnection( Servent* s, ControlConnection* cc, QString fid );
 
@@ -62,21 +69,48 @@ public:
 
     Type type() const { return m_type; }
     QString fid() const { return m_fid; }
+    int currentBlock() const { return m_curBlock; }
+
+    qint64 payloadSent() const { return m_bsent; }
+    // TX: estimated seconds of audio the peer has buffered beyond its playback position
+    double headroom() const;
+
+    /*
+        Instead of a socket of its own, a stream can run as a channel multiplexed
+        over the peer's ControlConnection. The ControlConnection routes the
+        channel's msgs to receiveChannelMsg() and calls channelClosed() when
+        either the peer closes the channel or the connection goes away.
+    */
+    bool isMultiplexed() const { return m_channel != 0; }
+    quint32 channel() const { return m_channel; }
+    void startChannel( quint32 channel, int credit );
+    void receiveChannelMsg( msg_ptr msg );
+    void channelClosed();
 
 signals:
     void updated();
 
+public slots:
+    // RX: asks the peer to continue from block
+    void onBlockRequest( int block );
+
 protected slots:
     virtual void handleMsg( msg_ptr msg );
 
 private slots:
     void startSending( const Tomahawk::result_ptr& );
     void sendSome();
+    // TX: the UploadScheduler's go-ahead for this many blocks
+    void sendGranted( int blocks );
     void showStats( qint64 tx, qint64 rx );
-
-    void onBlockRequest( int pos );
+    void onChannelStatsTimer();
 
 private:
+    // TX: sends the next block, returns true if there is more to send right away
+    bool sendBlock();
+    void seekToBlock( int block );
+    void sendStreamMsg( const QByteArray& payload, bool fragment );
+
     QSharedPointer<QIODevice> m_iodev;
     ControlConnection* m_cc;
     QString m_fid;
@@ -84,13 +118,25 @@ private:
     QSharedPointer<QIODevice> m_readdev;
 
     int m_curBlock;
+    int m_seekBlock; // block requested by the receiver before we were ready to send
+    int m_requestedBlock; // RX: block we asked for, until the peer confirms it
+    StreamSwarm* m_swarm;
+    QString m_cacheKey;
 
     int m_badded, m_bsent;
     bool m_allok; // got last msg ok, transfer complete?
+    QTime m_sendStarted;
 
     Tomahawk::source_ptr m_source;
     Tomahawk::result_ptr m_result;
     qint64 m_transferRate;
+
+    quint32 m_channel;
+    bool m_channelOpen;
+    int m_credit; // TX: blocks we may still send / RX: blocks received since we last granted more
+    bool m_stalled;
+    QTimer* m_channelStatsTimer;
+    int m_badded_last, m_bsent_last;
 };
 
 #endif // STREAMCONNECTION_H
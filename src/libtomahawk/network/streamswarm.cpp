@@ -0,0 +1,231 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "streamswarm.h"
+
+#include "bufferiodevice.h"
+#include "servent.h"
+#include "streamcache.h"
+#include "streamconnection.h"
+#include "database/database.h"
+#include "database/databasecommand_filesbyhash.h"
+#include "result.h"
+#include "utils/logger.h"
+
+// peers we stream one file from at most
+#define SWARM_MAX_PEERS 4
+// a seek this close ahead of a peer is left to that peer
+#define SWARM_SEEK_SLACK 16
+
+using namespace Tomahawk;
+
+
+StreamSwarm::StreamSwarm( const Tomahawk::result_ptr& result )
+    : QObject()
+    , m_result( result )
+{
+    BufferIODevice* bio = new BufferIODevice( result->size() );
+    m_iodev = QSharedPointer<QIODevice>( bio, &QObject::deleteLater );
+    m_iodev->open( QIODevice::ReadWrite );
+
+    // whatever blocks of this file we already have on disk are read once the player gets there
+    m_cacheKey = StreamCache::keyForResult( result );
+    bio->setCachedBlocks( m_cacheKey, StreamCache::instance()->cachedBlocks( m_cacheKey ) );
+
+    // seeks are routed to one of our peers, instead of all of them
+    connect( bio, SIGNAL( blockRequest( int ) ), SLOT( onBlockRequest( int ) ) );
+    connect( bio, SIGNAL( readChannelFinished() ), SLOT( onInputComplete() ) );
+
+    moveToThread( Servent::instance()->thread() );
+}
+
+
+StreamSwarm::~StreamSwarm()
+{
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << m_result->url();
+}
+
+
+BufferIODevice*
+StreamSwarm::buffer() const
+{
+    return (BufferIODevice*)m_iodev.data();
+}
+
+
+void
+StreamSwarm::findPeers()
+{
+    if ( m_result->hash().isEmpty() || buffer()->isComplete() )
+        return;
+
+    DatabaseCommand_FilesByHash* cmd = new DatabaseCommand_FilesByHash( m_result->hash(), m_result->size() );
+    connect( cmd, SIGNAL( results( QList<Tomahawk::result_ptr> ) ),
+                    SLOT( onPeersFound( QList<Tomahawk::result_ptr> ) ), Qt::QueuedConnection );
+    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+}
+
+
+void
+StreamSwarm::onPeersFound( const QList<Tomahawk::result_ptr>& results )
+{
+    foreach ( const result_ptr& result, results )
+    {
+        if ( result->url() != m_result->url() && !m_tried.contains( result->url() ) )
+            m_candidates << result;
+    }
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Found" << m_candidates.count() << "more copies of" << m_result->url();
+
+    while ( m_peers.count() < SWARM_MAX_PEERS && addNextCandidate() )
+        ;
+}
+
+
+bool
+StreamSwarm::addPeer( const Tomahawk::result_ptr& result )
+{
+    if ( buffer()->isComplete() || !m_iodev->isOpen() )
+        return false;
+
+    m_tried << result->url();
+
+    StreamConnection* sc = Servent::instance()->streamFromPeer( result, this );
+    if ( !sc )
+        return false;
+
+    QMutexLocker lock( &m_mutex );
+    m_peers << sc;
+    return true;
+}
+
+
+bool
+StreamSwarm::addNextCandidate()
+{
+    while ( !m_candidates.isEmpty() )
+    {
+        const result_ptr result = m_candidates.takeFirst();
+        if ( m_tried.contains( result->url() ) || !result->isOnline() )
+            continue;
+
+        if ( addPeer( result ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+int
+StreamSwarm::startBlock( StreamConnection* sc ) const
+{
+    bool alone = true;
+    {
+        QMutexLocker lock( &m_mutex );
+        foreach ( StreamConnection* peer, m_peers )
+        {
+            if ( peer != sc )
+                alone = false;
+        }
+    }
+
+    // the only peer fetches what the player needs next, later ones split the biggest gap
+    if ( alone )
+    {
+        const int block = buffer()->nextEmptyBlock( m_iodev->pos() / BufferIODevice::blockSize() );
+        return block >= 0 ? block : buffer()->nextEmptyBlock();
+    }
+
+    return buffer()->largestGapMiddle();
+}
+
+
+int
+StreamSwarm::nextBlock( StreamConnection* sc ) const
+{
+    Q_UNUSED( sc );
+    return buffer()->largestGapMiddle();
+}
+
+
+void
+StreamSwarm::peerFinished( StreamConnection* sc, bool complete )
+{
+    // sc is being destroyed on its own thread, it must not be touched after this
+    {
+        QMutexLocker lock( &m_mutex );
+        m_peers.removeAll( sc );
+    }
+
+    QMetaObject::invokeMethod( this, "onPeerLost", Qt::QueuedConnection, Q_ARG( bool, complete ) );
+}
+
+
+void
+StreamSwarm::onPeerLost( bool complete )
+{
+    if ( !complete && !buffer()->isComplete() && m_iodev->isOpen() )
+    {
+        tLog() << "Lost a peer while streaming" << m_result->url() << "- trying another copy";
+        addNextCandidate();
+    }
+
+    m_mutex.lock();
+    const bool empty = m_peers.isEmpty();
+    m_mutex.unlock();
+
+    if ( empty )
+    {
+        // nobody left to feed the player
+        buffer()->inputComplete();
+        deleteLater();
+    }
+}
+
+
+void
+StreamSwarm::onBlockRequest( int block )
+{
+    QMutexLocker lock( &m_mutex );
+    if ( m_peers.isEmpty() )
+        return;
+
+    // leave it to a peer that is about to get there anyway
+    StreamConnection* fastest = m_peers.first();
+    foreach ( StreamConnection* sc, m_peers )
+    {
+        if ( sc->currentBlock() <= block && block - sc->currentBlock() < SWARM_SEEK_SLACK )
+            return;
+
+        if ( sc->transferRate() > fastest->transferRate() )
+            fastest = sc;
+    }
+
+    QMetaObject::invokeMethod( fastest, "onBlockRequest", Qt::QueuedConnection, Q_ARG( int, block ) );
+}
+
+
+void
+StreamSwarm::onInputComplete()
+{
+    QMutexLocker lock( &m_mutex );
+    foreach ( StreamConnection* sc, m_peers )
+        QMetaObject::invokeMethod( sc, "shutdown", Qt::QueuedConnection );
+}
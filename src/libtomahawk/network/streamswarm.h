@@ -0,0 +1,90 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STREAMSWARM_H
+#define STREAMSWARM_H
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QIODevice>
+
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+class BufferIODevice;
+class StreamConnection;
+
+/**
+ * Fetches one remote file from every online peer that has an identical copy.
+ *
+ * All StreamConnections of a swarm write into the same BufferIODevice. Each
+ * peer streams its own region of the file. Once a peer runs into blocks
+ * another one already delivered, it is moved to the middle of the largest
+ * gap that is still missing. If a peer goes away mid-stream, another copy
+ * takes over its part, so playback only fails once no copy is left.
+ *
+ * The peers may run on different network threads; they only call the
+ * thread-safe methods below, everything else happens on the swarm's thread.
+ */
+class DLLEXPORT StreamSwarm : public QObject
+{
+Q_OBJECT
+
+public:
+    explicit StreamSwarm( const Tomahawk::result_ptr& result );
+    virtual ~StreamSwarm();
+
+    const QSharedPointer<QIODevice>& iodevice() const { return m_iodev; }
+    QString cacheKey() const { return m_cacheKey; }
+
+    // adds a peer's copy, returns false if we can't stream from it right now
+    bool addPeer( const Tomahawk::result_ptr& result );
+
+    // called by our StreamConnections, from their threads:
+    int startBlock( StreamConnection* sc ) const;
+    int nextBlock( StreamConnection* sc ) const;
+    void peerFinished( StreamConnection* sc, bool complete );
+
+public slots:
+    void findPeers();
+
+private slots:
+    void onPeersFound( const QList<Tomahawk::result_ptr>& results );
+    void onBlockRequest( int block );
+    void onInputComplete();
+    void onPeerLost( bool complete );
+
+private:
+    BufferIODevice* buffer() const;
+    bool addNextCandidate();
+
+    Tomahawk::result_ptr m_result;
+    QSharedPointer<QIODevice> m_iodev;
+    QString m_cacheKey;
+
+    QList< Tomahawk::result_ptr > m_candidates; // copies we are not streaming from (yet)
+    QList< StreamConnection* > m_peers;
+    mutable QMutex m_mutex; // guards m_peers, peers remove themselves while they are destroyed
+    QList< QString > m_tried; // urls we've streamed from before, don't go back to them
+};
+
+#endif // STREAMSWARM_H
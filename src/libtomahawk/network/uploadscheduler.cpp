@@ -0,0 +1,228 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "uploadscheduler.h"
+
+#include "bufferiodevice.h"
+#include "streamconnection.h"
+#include "tomahawksettings.h"
+#include "utils/metrics.h"
+#include "utils/logger.h"
+
+// how often the bucket is refilled
+#define TICK_INTERVAL 50
+// streams with less than this many seconds of audio buffered on the peer's end are served first
+#define UNDERRUN_THRESHOLD 10
+
+UploadScheduler* UploadScheduler::s_instance = 0;
+
+
+UploadScheduler*
+UploadScheduler::instance()
+{
+    return s_instance;
+}
+
+
+UploadScheduler::UploadScheduler( QObject* parent )
+    : QObject( parent )
+    , m_limit( 0 )
+    , m_tokens( 0 )
+    , m_timer( this )
+    , m_awake( false )
+{
+    s_instance = this;
+    m_clock.start();
+
+    m_timer.setInterval( TICK_INTERVAL );
+    connect( &m_timer, SIGNAL( timeout() ), SLOT( tick() ) );
+
+    connect( TomahawkSettings::instance(), SIGNAL( changed() ), SLOT( onSettingsChanged() ) );
+    setLimit( TomahawkSettings::instance()->uploadLimit() );
+}
+
+
+UploadScheduler::~UploadScheduler()
+{
+    s_instance = 0;
+}
+
+
+void
+UploadScheduler::onSettingsChanged()
+{
+    setLimit( TomahawkSettings::instance()->uploadLimit() );
+}
+
+
+void
+UploadScheduler::setLimit( qint64 bytesPerSecond )
+{
+    if ( bytesPerSecond < 0 )
+        bytesPerSecond = 0;
+
+    QMutexLocker lock( &m_mutex );
+    if ( bytesPerSecond == m_limit )
+        return;
+
+    tDebug() << Q_FUNC_INFO << "Upload limit is now" << bytesPerSecond << "bytes/sec";
+    m_limit = bytesPerSecond;
+    m_tokens = 0;
+    Metrics::instance()->setGauge( "network.upload.limit", m_limit );
+
+    if ( !isLimited() )
+    {
+        // back to sending as fast as we can, kick everyone that's been waiting for budget
+        m_timer.stop();
+        m_awake = false;
+        releaseWaiting();
+    }
+}
+
+
+void
+UploadScheduler::releaseWaiting()
+{
+    foreach ( StreamConnection* sc, m_waiting )
+        QMetaObject::invokeMethod( sc, "sendSome", Qt::QueuedConnection );
+    m_waiting.clear();
+    m_underrunAt.clear();
+}
+
+
+qint64
+UploadScheduler::fairShare() const
+{
+    if ( !isLimited() )
+        return 0;
+
+    QMutexLocker lock( &m_mutex );
+    return m_limit / qMax( 1, m_active.count() );
+}
+
+
+void
+UploadScheduler::wantsToSend( StreamConnection* sc )
+{
+    // headroom() reads the stream's own state, so it's only safe on the stream's thread
+    const double headroom = sc->headroom();
+
+    QMutexLocker lock( &m_mutex );
+    m_underrunAt[ sc ] = m_clock.elapsed() + (qint64)( headroom * 1000 );
+
+    if ( !m_active.contains( sc ) )
+        m_active << sc;
+    if ( !m_waiting.contains( sc ) )
+        m_waiting << sc;
+
+    // streams call in from their connection threads, the timer lives on ours
+    if ( !m_awake )
+    {
+        m_awake = true;
+        QMetaObject::invokeMethod( this, "wake", Qt::QueuedConnection );
+    }
+}
+
+
+void
+UploadScheduler::remove( StreamConnection* sc )
+{
+    QMutexLocker lock( &m_mutex );
+    m_waiting.removeAll( sc );
+    m_active.removeAll( sc );
+    m_underrunAt.remove( sc );
+}
+
+
+void
+UploadScheduler::wake()
+{
+    if ( !m_timer.isActive() )
+    {
+        m_lastTick.start();
+        m_timer.start();
+    }
+}
+
+
+void
+UploadScheduler::tick()
+{
+    QMutexLocker lock( &m_mutex );
+
+    // streams granted budget before the limit was lifted may have asked again since
+    if ( !isLimited() )
+    {
+        m_timer.stop();
+        m_awake = false;
+        releaseWaiting();
+        return;
+    }
+
+    // allow a quarter second worth of burst, but always enough for one block
+    const qint64 burst = qMax( m_limit / 4, (qint64)BufferIODevice::blockSize() );
+    m_tokens = qMin( burst, m_tokens + m_limit * m_lastTick.restart() / 1000 );
+
+    Metrics::instance()->setGauge( "network.upload.streams", m_active.count() );
+
+    // granted streams ask again right away if they have more, so idle only once nobody did
+    if ( m_waiting.isEmpty() )
+    {
+        m_timer.stop();
+        m_awake = false;
+        return;
+    }
+
+    const qint64 blockSize = BufferIODevice::blockSize();
+    if ( m_tokens < blockSize )
+        return;
+
+    // every waiting stream gets an equal share, the ones closest to an underrun first
+    QList< QPair< qint64, StreamConnection* > > byUnderrun;
+    foreach ( StreamConnection* sc, m_waiting )
+        byUnderrun << qMakePair( m_underrunAt.value( sc ), sc );
+    qStableSort( byUnderrun.begin(), byUnderrun.end() );
+
+    QList< StreamConnection* > round;
+    for ( int i = 0; i < byUnderrun.count(); i++ )
+        round << byUnderrun.at( i ).second;
+    m_waiting.clear();
+
+    const qint64 now = m_clock.elapsed();
+    const qint64 share = qMax( (qint64)1, m_tokens / ( blockSize * round.count() ) );
+
+    for ( int i = 0; i < round.count(); i++ )
+    {
+        StreamConnection* sc = round.at( i );
+        if ( m_tokens < blockSize )
+        {
+            // out of budget, the rest keep their place for the next tick
+            m_waiting = round.mid( i );
+            break;
+        }
+
+        const bool underrun = m_underrunAt.value( sc ) - now < UNDERRUN_THRESHOLD * 1000;
+        const qint64 blocks = qMin( m_tokens / blockSize, underrun ? share * 2 : share );
+        m_tokens -= blocks * blockSize;
+        m_underrunAt.remove( sc );
+
+        // sc sends on its own thread and asks again if it has more
+        QMetaObject::invokeMethod( sc, "sendGranted", Qt::QueuedConnection, Q_ARG( int, (int)blocks ) );
+    }
+}
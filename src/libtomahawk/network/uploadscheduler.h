@@ -0,0 +1,91 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UPLOADSCHEDULER_H
+#define UPLOADSCHEDULER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
+
+#include "dllmacro.h"
+
+class StreamConnection;
+
+/**
+ * Token bucket that shares the configured upload budget between all
+ * StreamConnections sending to peers.
+ *
+ * Every tick the bucket is refilled and split evenly between the waiting
+ * streams, which are granted their blocks on their own connection threads.
+ * Streams that are close to running out of buffered audio on the other end
+ * are served first and get twice their share.
+ *
+ * With no limit configured, streams send as fast as the event loop allows.
+ */
+class DLLEXPORT UploadScheduler : public QObject
+{
+Q_OBJECT
+
+public:
+    static UploadScheduler* instance();
+
+    explicit UploadScheduler( QObject* parent = 0 );
+    virtual ~UploadScheduler();
+
+    bool isLimited() const { return m_limit > 0; }
+    qint64 limit() const { return m_limit; } /// bytes/sec, 0 means unlimited
+    void setLimit( qint64 bytesPerSecond );
+
+    /// what each currently active upload gets, 0 if unlimited
+    qint64 fairShare() const;
+
+    /// sc has a block ready, its sendGranted() gets called once there is budget for it; call from sc's thread
+    void wantsToSend( StreamConnection* sc );
+    void remove( StreamConnection* sc );
+
+private slots:
+    void onSettingsChanged();
+    void wake();
+    void tick();
+
+private:
+    // hands every waiting stream back to sending on its own, caller holds m_mutex
+    void releaseWaiting();
+
+    QList< StreamConnection* > m_waiting;
+    QList< StreamConnection* > m_active; // every stream we've seen since it last finished
+    // when each waiting stream's peer runs out of audio, in m_clock time; taken on the stream's thread
+    QHash< StreamConnection*, qint64 > m_underrunAt;
+    QTime m_clock;
+
+    qint64 m_limit;
+    qint64 m_tokens;
+    QTimer m_timer;
+    QTime m_lastTick;
+    bool m_awake;
+    mutable QMutex m_mutex;
+
+    static UploadScheduler* s_instance;
+};
+
+#endif // UPLOADSCHEDULER_H
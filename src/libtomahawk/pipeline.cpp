@@ -27,12 +27,15 @@
 #include "resolvers/qtscriptresolver.h"
 
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 #include "boost/bind.hpp"
 
 #define DEFAULT_CONCURRENT_QUERIES 4
 #define MAX_CONCURRENT_QUERIES 16
 #define CLEANUP_TIMEOUT 5 * 60 * 1000
+#define LAZY_RESOLVE_LIMIT 250
+#define BATCH_TIMEOUT 25
 #define MINSCORE 0.5
 
 using namespace Tomahawk;
@@ -58,6 +61,10 @@ Pipeline::Pipeline( QObject* parent )
 
     m_temporaryQueryTimer.setInterval( CLEANUP_TIMEOUT );
     connect( &m_temporaryQueryTimer, SIGNAL( timeout() ), SLOT( onTemporaryQueryTimer() ) );
+
+    m_batchTimer.setInterval( BATCH_TIMEOUT );
+    m_batchTimer.setSingleShot( true );
+    connect( &m_batchTimer, SIGNAL( timeout() ), SLOT( flushBatches() ) );
 }
 
 
@@ -106,6 +113,7 @@ Pipeline::removeResolver( Resolver* r )
     QMutexLocker lock( &m_mut );
 
     m_resolvers.removeAll( r );
+    m_batches.remove( r );
     emit resolverRemoved( r );
 }
 
@@ -207,7 +215,15 @@ Pipeline::resolve( const QList<query_ptr>& qlist, bool prioritized, bool tempora
             if ( q->resolvingFinished() )
                 continue;
             if ( m_queries_pending.contains( q ) )
+            {
+                // prioritizing an already queued query moves it to the front, e.g. when it scrolls into view
+                if ( prioritized )
+                {
+                    m_queries_pending.removeOne( q );
+                    m_queries_pending.insert( i++, q );
+                }
                 continue;
+            }
             if ( m_qidsState.contains( q->id() ) )
                 continue;
 
@@ -234,6 +250,33 @@ Pipeline::resolve( const QList<query_ptr>& qlist, bool prioritized, bool tempora
 }
 
 
+bool
+Pipeline::isResolving( const query_ptr& q ) const
+{
+    QMutexLocker lock( &m_mut );
+    return m_qids.contains( q->id() );
+}
+
+
+QList< query_ptr >
+Pipeline::resolveLazily( const QList< query_ptr >& qlist )
+{
+    QList< query_ptr > queries;
+    foreach ( const query_ptr& q, qlist )
+    {
+        if ( q->resolvingFinished() )
+            continue;
+
+        queries << q;
+        if ( queries.count() >= LAZY_RESOLVE_LIMIT )
+            break;
+    }
+
+    resolve( queries, false );
+    return queries;
+}
+
+
 void
 Pipeline::resolve( const query_ptr& q, bool prioritized, bool temporaryQuery )
 {
@@ -254,7 +297,7 @@ Pipeline::resolve( QID qid, bool prioritized, bool temporaryQuery )
 
 
 void
-Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
+Pipeline::reportResults( QID qid, const QList< result_ptr >& results, bool partial )
 {
     if ( !m_running )
         return;
@@ -266,6 +309,9 @@ Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
     }
     const query_ptr& q = m_qids.value( qid );
 
+    if ( !partial && q->currentResolver() && m_qidsDispatched.contains( qid ) )
+        Metrics::instance()->addTiming( "pipeline.resolver." + q->currentResolver()->name(), m_qidsDispatched.take( qid ).elapsed() );
+
     QList< result_ptr > cleanResults;
     foreach( const result_ptr& r, results )
     {
@@ -292,7 +338,8 @@ Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
         }
     }
 
-    decQIDState( q );
+    if ( !partial )
+        decQIDState( q );
 }
 
 
@@ -366,6 +413,9 @@ Pipeline::shuntNext()
         QMutexLocker lock( &m_mut );
 
         rc = m_resolvers.count();
+        Metrics::instance()->setGauge( "pipeline.pending", m_queries_pending.count() );
+        Metrics::instance()->setGauge( "pipeline.active", m_qidsState.count() );
+
         if ( m_queries_pending.isEmpty() )
         {
             if ( m_qidsState.isEmpty() )
@@ -374,7 +424,7 @@ Pipeline::shuntNext()
         }
 
         // Check if we are ready to dispatch more queries
-        if ( m_qidsState.count() >= m_maxConcurrentQueries )
+        if ( !canDispatch( nextResolver( m_queries_pending.first() ) ) )
             return;
 
         /*
@@ -398,6 +448,9 @@ Pipeline::timeoutShunt( const query_ptr& q )
     // are we still waiting for a timeout?
     if ( m_qidsTimeout.contains( q->id() ) )
     {
+        if ( q->currentResolver() )
+            Metrics::instance()->increment( "pipeline.timeouts." + q->currentResolver()->name() );
+
         decQIDState( q );
     }
 }
@@ -415,10 +468,31 @@ Pipeline::shunt( const query_ptr& q )
 
     if ( r )
     {
+        {
+            QMutexLocker lock( &m_mut );
+
+            if ( r->batchSize() > 1 )
+                m_qidsBatched.insert( q->id() );
+            else if ( m_qidsBatched.remove( q->id() ) && !canDispatch( r ) )
+            {
+                // a whole batch moving on to a regular resolver at once would flood it, so wait in line
+                m_qidsState.remove( q->id() );
+                m_qidsDispatched.remove( q->id() );
+                m_queries_pending.prepend( q );
+                return;
+            }
+        }
+
         tLog( LOGVERBOSE ) << "Dispatching to resolver" << r->name() << q->toString() << q->solved() << q->id();
 
         q->setCurrentResolver( r );
-        r->resolve( q );
+        m_qidsDispatched[ q->id() ].start();
+        Metrics::instance()->increment( "pipeline.dispatched" );
+
+        if ( r->batchSize() > 1 )
+            queueBatch( r, q );
+        else
+            r->resolve( q );
         emit resolving( q );
 
         if ( r->timeout() > 0 )
@@ -462,6 +536,60 @@ Pipeline::nextResolver( const Tomahawk::query_ptr& query ) const
 }
 
 
+bool
+Pipeline::canDispatch( Tomahawk::Resolver* r ) const
+{
+    // resolvers which batch queries get to see a whole batch at once, the others share the usual limit
+    if ( r && r->batchSize() > 1 )
+        return m_qidsBatched.count() < (int)r->batchSize();
+
+    return m_qidsState.count() - m_qidsBatched.count() < m_maxConcurrentQueries;
+}
+
+
+void
+Pipeline::queueBatch( Tomahawk::Resolver* r, const Tomahawk::query_ptr& query )
+{
+    QList< query_ptr > batch;
+    {
+        QMutexLocker lock( &m_mut );
+        m_batches[ r ] << query;
+
+        if ( (unsigned int)m_batches[ r ].count() >= r->batchSize() )
+            batch = m_batches.take( r );
+        else if ( !m_batchTimer.isActive() )
+            m_batchTimer.start();
+    }
+
+    if ( !batch.isEmpty() )
+    {
+        tLog( LOGVERBOSE ) << "Dispatching full batch of" << batch.count() << "queries to resolver" << r->name();
+        r->resolveBatch( batch );
+    }
+}
+
+
+void
+Pipeline::flushBatches()
+{
+    QMap< Resolver*, QList< query_ptr > > batches;
+    {
+        QMutexLocker lock( &m_mut );
+        batches = m_batches;
+        m_batches.clear();
+    }
+
+    foreach ( Resolver* r, batches.keys() )
+    {
+        if ( !m_resolvers.contains( r ) )
+            continue;
+
+        tLog( LOGVERBOSE ) << "Dispatching batch of" << batches.value( r ).count() << "queries to resolver" << r->name();
+        r->resolveBatch( batches.value( r ) );
+    }
+}
+
+
 void
 Pipeline::setQIDState( const Tomahawk::query_ptr& query, int state )
 {
@@ -479,6 +607,8 @@ Pipeline::setQIDState( const Tomahawk::query_ptr& query, int state )
     else
     {
         m_qidsState.remove( query->id() );
+        m_qidsBatched.remove( query->id() );
+        m_qidsDispatched.remove( query->id() );
         query->onResolvingFinished();
 
         if ( !m_queries_temporary.contains( query ) )
@@ -26,6 +26,8 @@
 #include <QList>
 #include <QMap>
 #include <QMutex>
+#include <QSet>
+#include <QTime>
 #include <QTimer>
 
 #include <boost/function.hpp>
@@ -52,8 +54,11 @@ public:
 
     unsigned int pendingQueryCount() const { return m_queries_pending.count(); }
     unsigned int activeQueryCount() const { return m_qidsState.count(); }
+    // whether q is queued or with a resolver right now
+    bool isResolving( const query_ptr& q ) const;
 
-    void reportResults( QID qid, const QList< result_ptr >& results );
+    // partial results don't count as an answer of the current resolver, more results are to come
+    void reportResults( QID qid, const QList< result_ptr >& results, bool partial = false );
     void reportAlbums( QID qid, const QList< album_ptr >& albums );
     void reportArtists( QID qid, const QList< artist_ptr >& artists );
 
@@ -67,6 +72,9 @@ public:
     void addResolver( Resolver* r );
     void removeResolver( Resolver* r );
 
+    /// Enqueues queries at low priority. Only the head of huge lists gets enqueued, views resolve the rest once it scrolls into view.
+    QList< query_ptr > resolveLazily( const QList< query_ptr >& qlist );
+
     query_ptr query( const QID& qid ) const
     {
         return m_qids.value( qid );
@@ -99,9 +107,13 @@ private slots:
     void shuntNext();
 
     void onTemporaryQueryTimer();
+    void flushBatches();
 
 private:
     Tomahawk::Resolver* nextResolver( const Tomahawk::query_ptr& query ) const;
+    void queueBatch( Tomahawk::Resolver* r, const Tomahawk::query_ptr& query );
+    // whether there's room for another query at r, m_mut must be held
+    bool canDispatch( Tomahawk::Resolver* r ) const;
 
     void setQIDState( const Tomahawk::query_ptr& query, int state );
     int incQIDState( const Tomahawk::query_ptr& query );
@@ -111,11 +123,17 @@ private:
     QList< QWeakPointer<Tomahawk::ExternalResolver> > m_scriptResolvers;
     QList< ResolverFactoryFunc > m_resolverFactories;
     QMap< QID, bool > m_qidsTimeout;
+    QMap< QID, QTime > m_qidsDispatched; // when the query went to its current resolver
     QMap< QID, unsigned int > m_qidsState;
+    QSet< QID > m_qidsBatched; // active queries currently with a resolver which batches them
     QMap< QID, query_ptr > m_qids;
     QMap< RID, result_ptr > m_rids;
 
-    QMutex m_mut; // for m_qids, m_rids
+    // queries waiting to be sent to resolvers which support batching
+    QMap< Resolver*, QList< query_ptr > > m_batches;
+    QTimer m_batchTimer;
+
+    mutable QMutex m_mut; // for m_qids, m_rids
 
     // store queries here until DB index is loaded, then shunt them all
     QList< query_ptr > m_queries_pending;
@@ -95,6 +95,7 @@ Playlist::Playlist( const source_ptr& author )
     : m_source( author )
     , m_lastmodified( 0 )
     , m_updater( 0 )
+    , m_loaded( false )
 {
 }
 
@@ -154,6 +155,7 @@ Playlist::init()
     m_busy = false;
     m_deleted = false;
     m_locallyChanged = false;
+    m_loaded = false;
     connect( Pipeline::instance(), SIGNAL( idle() ), SLOT( onResolvingFinished() ) );
 }
 
@@ -272,8 +274,9 @@ Playlist::loadRevision( const QString& rev )
 //    qDebug() << Q_FUNC_INFO << currentrevision() << rev << m_title;
 
     setBusy( true );
+    m_loadingRevision = rev.isEmpty() ? currentrevision() : rev;
     DatabaseCommand_LoadPlaylistEntries* cmd =
-            new DatabaseCommand_LoadPlaylistEntries( rev.isEmpty() ? currentrevision() : rev );
+            new DatabaseCommand_LoadPlaylistEntries( m_loadingRevision );
 
     connect( cmd, SIGNAL( done( const QString&,
                                 const QList<QString>&,
@@ -292,6 +295,19 @@ Playlist::loadRevision( const QString& rev )
 }
 
 
+bool
+Playlist::ensureLoaded()
+{
+    if ( m_loaded )
+        return true;
+
+    if ( !busy() )
+        loadRevision();
+
+    return false;
+}
+
+
 //public, model can call this if user changes a playlist:
 void
 Playlist::createNewRevision( const QString& newrev, const QString& oldrev, const QList< plentry_ptr >& entries )
@@ -355,6 +371,18 @@ Playlist::setRevision( const QString& rev,
         return;
     }
 
+    // a peer changed a playlist nobody opened yet: it's in the db already and will be loaded from there.
+    // if a load is underway, load this revision right after it
+    if ( !m_loaded && !author()->isLocal() && rev != m_loadingRevision )
+    {
+        if ( busy() )
+            m_pendingRevision = rev;
+        else if ( applied )
+            m_currentrevision = rev;
+
+        return;
+    }
+
     PlaylistRevision pr = setNewRevision( rev, neworderedguids, oldorderedguids, is_newest_rev, addedmap );
 
     Q_ASSERT( applied );
@@ -379,6 +407,13 @@ Playlist::setRevision( const QString& rev,
     else
         emit revisionLoaded( pr );
 
+    if ( !m_pendingRevision.isEmpty() )
+    {
+        const QString pending = m_pendingRevision;
+        m_pendingRevision.clear();
+        loadRevision( pending );
+    }
+
     checkRevisionQueue();
 }
 
@@ -454,6 +489,7 @@ Playlist::setNewRevision( const QString& rev,
 
     pr.added = addedmap.values();
     pr.newlist = entries;
+    m_loaded = true;
 
     return pr;
 }
@@ -475,7 +511,7 @@ Playlist::resolve()
         qlist << p->query();
     }
 
-    Pipeline::instance()->resolve( qlist );
+    Pipeline::instance()->resolveLazily( qlist );
 }
 
 
@@ -161,6 +161,10 @@ public:
     uint createdOn() const            { return m_createdOn; }
 
     bool busy() const { return m_busy; }
+    // false until a revision was loaded with loadRevision(), until then only the metadata above is known
+    bool loaded() const { return m_loaded; }
+    // returns loaded(). If it isn't, starts loading the current revision, revisionLoaded() is emitted once the entries are in
+    bool ensureLoaded();
 
     const QList< plentry_ptr >& entries() { return m_entries; }
     virtual void addEntry( const Tomahawk::query_ptr& query, const QString& oldrev );
@@ -279,6 +283,9 @@ private:
     bool m_locallyChanged;
     bool m_deleted;
     bool m_busy;
+    bool m_loaded;
+    QString m_loadingRevision;
+    QString m_pendingRevision;
 
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
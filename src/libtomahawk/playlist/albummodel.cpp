@@ -27,9 +27,13 @@
 #include "source.h"
 #include "sourcelist.h"
 #include "database/database.h"
+#include "database/databasecommandgroup.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
+// rows per chunk when listing a whole collection
+#define LOAD_CHUNK_SIZE 1000
+
 using namespace Tomahawk;
 
 
@@ -37,6 +41,7 @@ AlbumModel::AlbumModel( QObject* parent )
     : QAbstractItemModel( parent )
     , m_rootItem( new AlbumItem( 0, this ) )
     , m_overwriteOnAdd( false )
+    , m_loaders( new DatabaseCommandGroup( this ) )
 {
 }
 
@@ -241,10 +246,14 @@ AlbumModel::addCollection( const collection_ptr& collection, bool overwrite )
     m_overwriteOnAdd = overwrite;
     m_collection = collection;
 
+    // each chunk would replace the one before when overwriting
+    if ( !overwrite )
+        cmd->setChunkSize( LOAD_CHUNK_SIZE );
+
     connect( cmd, SIGNAL( albums( QList<Tomahawk::album_ptr>, QVariant ) ),
                     SLOT( addAlbums( QList<Tomahawk::album_ptr> ) ) );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_loaders->enqueue( cmd );
 
     m_title = tr( "All albums from %1" ).arg( collection->source()->friendlyName() );
 
@@ -285,7 +294,7 @@ AlbumModel::addFilteredCollection( const collection_ptr& collection, unsigned in
     connect( cmd, SIGNAL( albums( QList<Tomahawk::album_ptr>, QVariant ) ),
                     SLOT( addAlbums( QList<Tomahawk::album_ptr> ) ) );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_loaders->enqueue( cmd );
 
     if ( !collection.isNull() )
         m_title = tr( "All albums from %1" ).arg( collection->source()->friendlyName() );
@@ -299,6 +308,9 @@ AlbumModel::addFilteredCollection( const collection_ptr& collection, unsigned in
 void
 AlbumModel::addAlbums( const QList<Tomahawk::album_ptr>& albums )
 {
+    if ( m_loaders->isStale( sender() ) )
+        return;
+
     emit loadingFinished();
 
     if ( m_overwriteOnAdd )
@@ -398,6 +410,7 @@ AlbumModel::onSourceAdded( const Tomahawk::source_ptr& source )
 void
 AlbumModel::onCollectionChanged()
 {
+    m_loaders->cancel();
     addCollection( m_collection, true );
 }
 
@@ -29,6 +29,7 @@
 #include "dllmacro.h"
 
 class AlbumItem;
+class DatabaseCommandGroup;
 class QMetaData;
 
 class DLLEXPORT AlbumModel : public QAbstractItemModel
@@ -115,6 +116,7 @@ private:
     bool m_overwriteOnAdd;
 
     Tomahawk::collection_ptr m_collection;
+    DatabaseCommandGroup* m_loaders;
 };
 
 #endif // ALBUMMODEL_H
@@ -37,6 +37,8 @@
 #include "utils/logger.h"
 
 #define SCROLL_TIMEOUT 280
+// rows left below the viewport when we ask the model for the next page of artists
+#define FETCH_AHEAD 50
 
 using namespace Tomahawk;
 
@@ -175,6 +177,13 @@ ArtistView::onScrollTimeout()
     while ( right.isValid() && right.parent().isValid() )
         right = right.parent();
 
+    // filtered views get their artists from the filter, not from paging
+    if ( m_proxyModel->filterRegExp().isEmpty() &&
+       ( !right.isValid() || right.row() + FETCH_AHEAD >= m_proxyModel->rowCount() ) )
+    {
+        m_model->fetchMoreArtists();
+    }
+
     int max = m_proxyModel->playlistInterface()->trackCount();
     if ( right.isValid() )
         max = right.row() + 1;
@@ -19,14 +19,19 @@
 #include "collectionflatmodel.h"
 
 #include "database/database.h"
+#include "database/databasecommandgroup.h"
 #include "sourcelist.h"
 #include "utils/logger.h"
 
+// rows per chunk when listing a whole collection
+#define LOAD_CHUNK_SIZE 1000
+
 using namespace Tomahawk;
 
 
 CollectionFlatModel::CollectionFlatModel( QObject* parent )
     : TrackModel( parent )
+    , m_loaders( new DatabaseCommandGroup( this ) )
 {
 }
 
@@ -61,10 +66,13 @@ CollectionFlatModel::addCollection( const collection_ptr& collection, bool sendN
         emit loadingStarted();
 
     DatabaseCommand_AllTracks* cmd = new DatabaseCommand_AllTracks( collection );
+    cmd->setChunkSize( LOAD_CHUNK_SIZE );
     connect( cmd, SIGNAL( tracks( QList<Tomahawk::query_ptr>, QVariant ) ),
                     SLOT( onTracksAdded( QList<Tomahawk::query_ptr> ) ), Qt::QueuedConnection );
+    connect( cmd, SIGNAL( done( Tomahawk::collection_ptr ) ),
+                    SLOT( onCollectionLoaded( Tomahawk::collection_ptr ) ), Qt::QueuedConnection );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_loaders->enqueue( cmd );
 
     m_loadingCollections << collection.data();
 
@@ -91,7 +99,7 @@ CollectionFlatModel::addFilteredCollection( const collection_ptr& collection, un
     connect( cmd, SIGNAL( tracks( QList<Tomahawk::query_ptr>, QVariant ) ),
                     SLOT( onTracksAdded( QList<Tomahawk::query_ptr> ) ), Qt::QueuedConnection );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_loaders->enqueue( cmd );
 }
 
 
@@ -100,13 +108,15 @@ CollectionFlatModel::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks )
 {
     qDebug() << Q_FUNC_INFO << tracks.count() << rowCount( QModelIndex() );
 
-    if ( !m_loadingCollections.isEmpty() && sender() && qobject_cast< Collection* >( sender() ) )
-    {
-        // we are keeping track and are called as a slot
-        m_loadingCollections.removeAll( qobject_cast< Collection* >( sender() ) );
-    }
-
     append( tracks );
+}
+
+
+void
+CollectionFlatModel::onCollectionLoaded( const Tomahawk::collection_ptr& collection )
+{
+    // collections arrive in chunks, we're done once their last one is in
+    m_loadingCollections.removeAll( collection.data() );
 
     if ( m_loadingCollections.isEmpty() )
         emit loadingFinished();
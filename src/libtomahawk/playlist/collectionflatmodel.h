@@ -34,6 +34,7 @@
 #include "dllmacro.h"
 
 class QMetaData;
+class DatabaseCommandGroup;
 
 class DLLEXPORT CollectionFlatModel : public TrackModel
 {
@@ -59,6 +60,7 @@ signals:
 
 private slots:
     void onTracksAdded( const QList<Tomahawk::query_ptr>& tracks );
+    void onCollectionLoaded( const Tomahawk::collection_ptr& collection );
     void onTracksRemoved( const QList<Tomahawk::query_ptr>& tracks );
 
 private:
@@ -66,6 +68,7 @@ private:
     QList<Tomahawk::query_ptr> m_tracksToAdd;
     // just to keep track of what we are waiting to be loaded
     QList<Tomahawk::Collection*> m_loadingCollections;
+    DatabaseCommandGroup* m_loaders;
 };
 
 #endif // COLLECTIONFLATMODEL_H
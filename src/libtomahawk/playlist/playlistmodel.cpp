@@ -81,6 +81,10 @@ PlaylistModel::loadPlaylist( const Tomahawk::playlist_ptr& playlist, bool loadEn
     if ( !loadEntries )
         return;
 
+    // a peer's playlist only had its metadata loaded at startup, onRevisionLoaded() gets back to us with the entries
+    if ( !playlist->author()->isLocal() && !playlist->ensureLoaded() )
+        return;
+
     QList<plentry_ptr> entries = playlist->entries();
     append( entries );
 }
@@ -217,21 +221,21 @@ PlaylistModel::insert( const QList< Tomahawk::plentry_ptr >& entries, int row )
             setCurrentItem( plitem->index );
 
         if ( !entry->query()->resolvingFinished() && !entry->query()->playable() )
-        {
             queries << entry->query();
-            m_waitingForResolved.append( entry->query().data() );
-            connect( entry->query().data(), SIGNAL( resolvingFinished( bool ) ), SLOT( trackResolved( bool ) ) );
-        }
 
         connect( plitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
     }
 
-    if ( !m_waitingForResolved.isEmpty() )
+    // the view resolves whatever scrolls into view, only wait for the head of the playlist here
+    foreach ( const query_ptr& query, Pipeline::instance()->resolveLazily( queries ) )
     {
-        Pipeline::instance()->resolve( queries );
-        emit loadingStarted();
+        m_waitingForResolved.append( query.data() );
+        connect( query.data(), SIGNAL( resolvingFinished( bool ) ), SLOT( trackResolved( bool ) ) );
     }
 
+    if ( !m_waitingForResolved.isEmpty() )
+        emit loadingStarted();
+
     emit endInsertRows();
     emit trackCountChanged( rowCount( QModelIndex() ) );
 }
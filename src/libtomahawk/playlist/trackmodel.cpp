@@ -560,13 +560,16 @@ TrackModel::onPlaybackStopped()
 void
 TrackModel::ensureResolved()
 {
+    QList< query_ptr > queries;
     for( int i = 0; i < rowCount( QModelIndex() ); i++ )
     {
         query_ptr query = itemFromIndex( index( i, 0, QModelIndex() ) )->query();
 
         if ( !query->resolvingFinished() )
-            Pipeline::instance()->resolve( query );
+            queries << query;
     }
+
+    Pipeline::instance()->resolveLazily( queries );
 }
 
 
@@ -22,8 +22,12 @@
 #include "artist.h"
 #include "album.h"
 #include "query.h"
+#include "pipeline.h"
 #include "utils/logger.h"
 
+// how many rows ahead of the current one we resolve, so we find a playable next item
+#define RESOLVE_AHEAD 10
+
 using namespace Tomahawk;
 
 TrackProxyModelPlaylistInterface::TrackProxyModelPlaylistInterface( TrackProxyModel* proxyModel )
@@ -105,7 +109,11 @@ TrackProxyModelPlaylistInterface::siblingItem( int itemsAway )
 bool
 TrackProxyModelPlaylistInterface::hasNextItem()
 {
-    return !( siblingItem( 1, true ).isNull() );
+    if ( m_proxyModel.isNull() )
+        return false;
+
+    resolveAhead( m_proxyModel.data()->currentIndex() );
+    return siblingIndex( 1 ).isValid();
 }
 
 
@@ -119,14 +127,57 @@ TrackProxyModelPlaylistInterface::siblingItem( int itemsAway, bool readOnly )
 
     TrackProxyModel* proxyModel = m_proxyModel.data();
 
+    // what comes next has to be on its way through the pipeline before we judge it
+    resolveAhead( proxyModel->currentIndex() );
+
+    const QModelIndex idx = siblingIndex( itemsAway );
+    TrackModelItem* item = idx.isValid() ? proxyModel->itemFromIndex( proxyModel->mapToSource( idx ) ) : 0;
+    if ( !item )
+    {
+        if ( !readOnly )
+            proxyModel->setCurrentIndex( QModelIndex() );
+        return Tomahawk::result_ptr();
+    }
+
+    if ( !item->query()->playable() )
+    {
+        // still resolving, the engine asks again once it's done
+        if ( !readOnly )
+            waitFor( item->query() );
+        return Tomahawk::result_ptr();
+    }
+
+    qDebug() << "Next PlaylistItem found:" << item->query()->toString() << item->query()->results().at( 0 )->url();
+    if ( !readOnly )
+    {
+        proxyModel->setCurrentIndex( idx );
+        resolveAhead( idx );
+    }
+    return item->query()->results().at( 0 );
+}
+
+
+QModelIndex
+TrackProxyModelPlaylistInterface::siblingIndex( int itemsAway ) const
+{
+    TrackProxyModel* proxyModel = m_proxyModel.data();
+
     QModelIndex idx = proxyModel->index( 0, 0 );
     if ( proxyModel->rowCount() )
     {
         if ( m_shuffled )
         {
-            // random mode is enabled
+            // random mode is enabled, only pick rows we can already play or are about to know about
             // TODO come up with a clever random logic, that keeps track of previously played items
-            idx = proxyModel->index( qrand() % proxyModel->rowCount(), 0 );
+            QList< int > candidates;
+            for ( int i = 0; i < proxyModel->rowCount(); i++ )
+            {
+                TrackModelItem* item = proxyModel->itemFromIndex( proxyModel->mapToSource( proxyModel->index( i, 0 ) ) );
+                if ( item && ( item->query()->playable() || Pipeline::instance()->isResolving( item->query() ) ) )
+                    candidates << i;
+            }
+
+            return candidates.isEmpty() ? QModelIndex() : proxyModel->index( candidates.at( qrand() % candidates.count() ), 0 );
         }
         else if ( proxyModel->currentIndex().isValid() )
         {
@@ -156,24 +207,61 @@ TrackProxyModelPlaylistInterface::siblingItem( int itemsAway, bool readOnly )
         }
     }
 
-    // Try to find the next available PlaylistItem (with results)
+    // Try to find the next PlaylistItem that has results or may still get some
     while ( idx.isValid() )
     {
         TrackModelItem* item = proxyModel->itemFromIndex( proxyModel->mapToSource( idx ) );
-        if ( item && item->query()->playable() )
-        {
-            qDebug() << "Next PlaylistItem found:" << item->query()->toString() << item->query()->results().at( 0 )->url();
-            if ( !readOnly )
-                proxyModel->setCurrentIndex( idx );
-            return item->query()->results().at( 0 );
-        }
+        if ( item && ( item->query()->playable() || !item->query()->resolvingFinished() ) )
+            return idx;
 
         idx = proxyModel->index( idx.row() + ( itemsAway > 0 ? 1 : -1 ), 0 );
     }
 
-    if ( !readOnly )
-        proxyModel->setCurrentIndex( QModelIndex() );
-    return Tomahawk::result_ptr();
+    return QModelIndex();
+}
+
+
+void
+TrackProxyModelPlaylistInterface::waitFor( const Tomahawk::query_ptr& query )
+{
+    if ( m_pending == query )
+        return;
+
+    if ( !m_pending.isNull() )
+        disconnect( m_pending.data(), SIGNAL( resolvingFinished( bool ) ), this, SLOT( onPendingResolved() ) );
+
+    m_pending = query;
+    connect( query.data(), SIGNAL( resolvingFinished( bool ) ), SLOT( onPendingResolved() ) );
+    Pipeline::instance()->resolve( query, true );
+}
+
+
+void
+TrackProxyModelPlaylistInterface::onPendingResolved()
+{
+    disconnect( m_pending.data(), SIGNAL( resolvingFinished( bool ) ), this, SLOT( onPendingResolved() ) );
+    m_pending.clear();
+
+    // playable or not, the engine can move on now
+    emit nextTrackReady();
+}
+
+
+void
+TrackProxyModelPlaylistInterface::resolveAhead( const QModelIndex& current )
+{
+    TrackProxyModel* proxyModel = m_proxyModel.data();
+
+    QList< Tomahawk::query_ptr > queries;
+    for ( int i = current.row() + 1; i <= current.row() + RESOLVE_AHEAD && i < proxyModel->rowCount(); i++ )
+    {
+        TrackModelItem* item = proxyModel->itemFromIndex( proxyModel->mapToSource( proxyModel->index( i, 0 ) ) );
+        if ( item && !item->query()->resolvingFinished() )
+            queries << item->query();
+    }
+
+    if ( !queries.isEmpty() )
+        Pipeline::instance()->resolve( queries, true );
 }
 
 
@@ -54,14 +54,26 @@ public:
     virtual PlaylistInterface::RepeatMode repeatMode() const { return m_repeatMode; }
     virtual bool shuffled() const { return m_shuffled; }
 
+    // while the next row is still being resolved, the engine waits for nextTrackReady()
+    virtual PlaylistInterface::RetryMode retryMode() const { return m_pending.isNull() ? NoRetry : Retry; }
+
 public slots:
     virtual void setRepeatMode( Tomahawk::PlaylistInterface::RepeatMode mode ) { m_repeatMode = mode; emit repeatModeChanged( mode ); }
     virtual void setShuffled( bool enabled ) { m_shuffled = enabled; emit shuffleModeChanged( enabled ); }
 
+private slots:
+    void onPendingResolved();
+
 protected:
+    void resolveAhead( const QModelIndex& current );
+    // the next row that is playable or may still become playable
+    QModelIndex siblingIndex( int itemsAway ) const;
+    void waitFor( const Tomahawk::query_ptr& query );
+
     QWeakPointer< TrackProxyModel > m_proxyModel;
     RepeatMode m_repeatMode;
     bool m_shuffled;
+    Tomahawk::query_ptr m_pending; // the next row, we're waiting for it to resolve
 };
 
 } //ns
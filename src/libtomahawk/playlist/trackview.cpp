@@ -26,6 +26,7 @@
 #include "viewmanager.h"
 #include "trackmodel.h"
 #include "trackproxymodel.h"
+#include "pipeline.h"
 #include "audio/audioengine.h"
 #include "context/ContextWidget.h"
 #include "widgets/overlaywidget.h"
@@ -37,6 +38,7 @@
 #include "album.h"
 
 #define SCROLL_TIMEOUT 280
+#define PREFETCH_ROWS 50
 
 using namespace Tomahawk;
 
@@ -166,9 +168,6 @@ TrackView::setTrackModel( TrackModel* model )
 void
 TrackView::onViewChanged()
 {
-    if ( m_model->style() != TrackModel::Short && m_model->style() != TrackModel::Large ) // eventual FIXME?
-        return;
-
     if ( m_timer.isActive() )
         m_timer.stop();
 
@@ -194,7 +193,22 @@ TrackView::onScrollTimeout()
     if ( right.isValid() )
         max = right.row();
 
-    if ( !max )
+    if ( !max || !left.isValid() )
+        return;
+
+    // resolve the visible rows plus a prefetch window first, ahead of everything else in the pipeline
+    QList< query_ptr > queries;
+    const int last = qMin( max + PREFETCH_ROWS, m_proxyModel->rowCount() - 1 );
+    for ( int i = left.row(); i <= last; i++ )
+    {
+        TrackModelItem* item = m_model->itemFromIndex( m_proxyModel->mapToSource( m_proxyModel->index( i, 0 ) ) );
+        if ( item && !item->query().isNull() && !item->query()->resolvingFinished() )
+            queries << item->query();
+    }
+    if ( !queries.isEmpty() )
+        Pipeline::instance()->resolve( queries, true );
+
+    if ( m_model->style() != TrackModel::Short && m_model->style() != TrackModel::Large ) // eventual FIXME?
         return;
 
     for ( int i = left.row(); i <= max; i++ )
@@ -19,17 +19,26 @@
 #include "treemodel.h"
 
 #include <QMimeData>
+#include <QSet>
 
 #include "pipeline.h"
 #include "source.h"
 #include "sourcelist.h"
+#include "supercollection.h"
 #include "audio/audioengine.h"
 #include "database/databasecommand_allalbums.h"
 #include "database/databasecommand_alltracks.h"
 #include "database/database.h"
+#include "database/databasecommandgroup.h"
+#include "database/databaseimpl.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
+// rows per chunk when listing a whole collection
+#define LOAD_CHUNK_SIZE 1000
+// artists, or albums of one artist, fetched at a time while browsing
+#define BROWSE_PAGE_SIZE 200
+
 using namespace Tomahawk;
 
 
@@ -39,6 +48,8 @@ TreeModel::TreeModel( QObject* parent )
     , m_infoId( uuid() )
     , m_columnStyle( AllColumns )
     , m_mode( DatabaseMode )
+    , m_loaders( new DatabaseCommandGroup( this ) )
+    , m_pagingArtists( false )
 {
     setIcon( QPixmap( RESPATH "images/music-icon.png" ) );
 
@@ -53,12 +64,22 @@ TreeModel::TreeModel( QObject* parent )
 
 TreeModel::~TreeModel()
 {
+    Tomahawk::InfoSystem::InfoSystem::instance()->cancelRequests( m_infoId );
 }
 
 
 void
 TreeModel::clear()
 {
+    m_pendingAlbums.clear();
+    m_loaders->cancel();
+
+    m_pagingArtists = false;
+    m_artistsAfter.clear();
+    m_artistIndex.clear();
+    m_rootItem->fetchingMore = false;
+    m_rootItem->fetchedAll = true;
+
     if ( rowCount( QModelIndex() ) )
     {
         emit loadingFinished();
@@ -144,7 +165,11 @@ TreeModel::canFetchMore( const QModelIndex& parent ) const
 {
     TreeModelItem* parentItem = itemFromIndex( parent );
 
-    if ( parentItem->fetchingMore )
+    // top level pages are fetched as the view scrolls, QTreeView would otherwise keep asking until it has them all
+    if ( parentItem == m_rootItem )
+        return false;
+
+    if ( parentItem->fetchingMore || parentItem->fetchedAll )
         return false;
 
     if ( !parentItem->artist().isNull() )
@@ -175,7 +200,9 @@ TreeModel::fetchMore( const QModelIndex& parent )
     }
     else if ( !parentItem->album().isNull() )
     {
+        // an album's tracks come in one go
         qDebug() << Q_FUNC_INFO << "Loading Album:" << parentItem->album()->name();
+        parentItem->fetchedAll = true;
         addTracks( parentItem->album(), parent );
     }
     else
@@ -564,13 +591,16 @@ TreeModel::removeIndexes( const QList<QModelIndex>& indexes )
 void
 TreeModel::addAllCollections()
 {
-    emit loadingStarted();
-    DatabaseCommand_AllArtists* cmd = new DatabaseCommand_AllArtists();
-
-    connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
-                    SLOT( onArtistsAdded( QList<Tomahawk::artist_ptr> ) ) );
+    m_pagingArtists = true;
+    m_rootItem->fetchedAll = false;
+    fetchMoreArtists();
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    // start merging everyone's tracks while the artists are being browsed
+    SuperCollection::instance()->load();
+    connect( SuperCollection::instance(), SIGNAL( tracksAdded( QList<Tomahawk::query_ptr> ) ),
+                                          SLOT( onSuperCollectionTracksAdded( QList<Tomahawk::query_ptr> ) ), Qt::UniqueConnection );
+    connect( SuperCollection::instance(), SIGNAL( tracksRemoved( QList<Tomahawk::query_ptr> ) ),
+                                          SLOT( onSuperCollectionTracksRemoved( QList<Tomahawk::query_ptr> ) ), Qt::UniqueConnection );
 
     connect( SourceList::instance(), SIGNAL( sourceAdded( Tomahawk::source_ptr ) ), SLOT( onSourceAdded( Tomahawk::source_ptr ) ), Qt::UniqueConnection );
 
@@ -598,6 +628,46 @@ TreeModel::addArtists( const artist_ptr& artist )
 }
 
 
+void
+TreeModel::addArtists( const QList<Tomahawk::artist_ptr>& artists )
+{
+    // once every page is in, there's nothing missing
+    if ( !m_pagingArtists || m_rootItem->fetchedAll )
+        return;
+
+    onArtistsAdded( artists );
+}
+
+
+bool
+TreeModel::canFetchMoreArtists() const
+{
+    return m_pagingArtists && !m_rootItem->fetchingMore && !m_rootItem->fetchedAll;
+}
+
+
+void
+TreeModel::fetchMoreArtists()
+{
+    if ( !canFetchMoreArtists() )
+        return;
+
+    emit loadingStarted();
+    m_rootItem->fetchingMore = true;
+
+    DatabaseCommand_AllArtists* cmd = new DatabaseCommand_AllArtists( m_collection );
+    cmd->setSortOrder( DatabaseCommand_AllArtists::Name );
+    cmd->setLimit( BROWSE_PAGE_SIZE );
+    if ( !m_artistsAfter.isNull() )
+        cmd->setAfter( m_artistsAfter );
+
+    connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
+                    SLOT( onArtistsPage( QList<Tomahawk::artist_ptr> ) ) );
+
+    m_loaders->enqueue( cmd );
+}
+
+
 void
 TreeModel::addAlbums( const artist_ptr& artist, const QModelIndex& parent, bool autoRefetch )
 {
@@ -607,14 +677,26 @@ TreeModel::addAlbums( const artist_ptr& artist, const QModelIndex& parent, bool
     {
         DatabaseCommand_AllAlbums* cmd = new DatabaseCommand_AllAlbums( m_collection, artist );
         cmd->setData( parent.row() );
+        cmd->setSortOrder( DatabaseCommand_AllAlbums::Name );
+        cmd->setLimit( BROWSE_PAGE_SIZE );
+
+        // continue after the last album we have, albums of an artist only ever come from its pages here
+        TreeModelItem* parentItem = itemFromIndex( parent );
+        if ( !parentItem->children.isEmpty() )
+        {
+            const album_ptr last = parentItem->children.last()->album();
+            cmd->setAfter( last->id() ? DatabaseImpl::sortname( last->name() ) : QString( "" ), last->id() );
+        }
 
         connect( cmd, SIGNAL( albums( QList<Tomahawk::album_ptr>, QVariant ) ),
                         SLOT( onAlbumsFound( QList<Tomahawk::album_ptr>, QVariant ) ) );
 
-        Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+        m_loaders->enqueue( cmd );
     }
     else if ( m_mode == InfoSystemMode )
     {
+        itemFromIndex( parent )->fetchedAll = true;
+
         Tomahawk::InfoSystem::InfoStringHash artistInfo;
         artistInfo["artist"] = artist->name();
 
@@ -640,16 +722,29 @@ TreeModel::addTracks( const album_ptr& album, const QModelIndex& parent, bool au
     rows << parent.row();
     rows << parent.parent().row();
 
-    if ( m_mode == DatabaseMode )
+    if ( m_mode == DatabaseMode && m_collection.isNull() )
+    {
+        // all collections: browse the SuperCollection, which lists each track only once
+        if ( SuperCollection::instance()->isLoaded() )
+            onTracksFound( SuperCollection::instance()->tracks( album ), QVariant( rows ) );
+        else
+        {
+            m_pendingAlbums << qMakePair( album, QVariant( rows ) );
+            connect( SuperCollection::instance(), SIGNAL( loaded() ), SLOT( onSuperCollectionLoaded() ), Qt::UniqueConnection );
+            SuperCollection::instance()->load();
+        }
+    }
+    else if ( m_mode == DatabaseMode )
     {
         DatabaseCommand_AllTracks* cmd = new DatabaseCommand_AllTracks( m_collection );
         cmd->setAlbum( album );
         cmd->setData( QVariant( rows ) );
+        cmd->setChunkSize( LOAD_CHUNK_SIZE );
 
         connect( cmd, SIGNAL( tracks( QList<Tomahawk::query_ptr>, QVariant ) ),
                         SLOT( onTracksFound( QList<Tomahawk::query_ptr>, QVariant ) ) );
 
-        Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+        m_loaders->enqueue( cmd );
     }
     else if ( m_mode == InfoSystemMode )
     {
@@ -681,12 +776,9 @@ TreeModel::addCollection( const collection_ptr& collection )
                             << collection->source()->userName();
 
     m_collection = collection;
-    DatabaseCommand_AllArtists* cmd = new DatabaseCommand_AllArtists( collection );
-
-    connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
-                    SLOT( onArtistsAdded( QList<Tomahawk::artist_ptr> ) ) );
-
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_pagingArtists = true;
+    m_rootItem->fetchedAll = false;
+    fetchMoreArtists();
 
     connect( collection.data(), SIGNAL( changed() ), SLOT( onCollectionChanged() ), Qt::UniqueConnection );
 
@@ -713,10 +805,10 @@ TreeModel::addFilteredCollection( const collection_ptr& collection, unsigned int
     cmd->setSortOrder( order );
     cmd->setSortDescending( true );
 
-    connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr>, Tomahawk::collection_ptr ) ),
-                    SLOT( onArtistsAdded( QList<Tomahawk::artist_ptr>, Tomahawk::collection_ptr ) ) );
+    connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
+                    SLOT( onArtistsAdded( QList<Tomahawk::artist_ptr> ) ) );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_loaders->enqueue( cmd );
 
     if ( collection->source()->isLocal() )
         setTitle( tr( "My Collection" ) );
@@ -747,8 +839,20 @@ TreeModel::onCollectionChanged()
 void
 TreeModel::onArtistsAdded( const QList<Tomahawk::artist_ptr>& artists )
 {
+    if ( m_loaders->isStale( sender() ) )
+        return;
+
     emit loadingFinished();
-    if ( !artists.count() )
+
+    // a filter may have brought in artists ahead of their page
+    QList<Tomahawk::artist_ptr> newArtists;
+    foreach( const artist_ptr& artist, artists )
+    {
+        if ( !indexFromArtist( artist ).isValid() && !newArtists.contains( artist ) )
+            newArtists << artist;
+    }
+
+    if ( !newArtists.count() )
     {
         emit itemCountChanged( rowCount( QModelIndex() ) );
         return;
@@ -757,15 +861,16 @@ TreeModel::onArtistsAdded( const QList<Tomahawk::artist_ptr>& artists )
     int c = rowCount( QModelIndex() );
     QPair< int, int > crows;
     crows.first = c;
-    crows.second = c + artists.count() - 1;
+    crows.second = c + newArtists.count() - 1;
 
     emit beginInsertRows( QModelIndex(), crows.first, crows.second );
 
     TreeModelItem* artistitem;
-    foreach( const artist_ptr& artist, artists )
+    foreach( const artist_ptr& artist, newArtists )
     {
         artistitem = new TreeModelItem( artist, m_rootItem );
         artistitem->index = createIndex( m_rootItem->children.count() - 1, 0, artistitem );
+        m_artistIndex.insert( artist.data(), artistitem->index );
         connect( artistitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
     }
 
@@ -774,6 +879,26 @@ TreeModel::onArtistsAdded( const QList<Tomahawk::artist_ptr>& artists )
 }
 
 
+void
+TreeModel::onArtistsPage( const QList<Tomahawk::artist_ptr>& artists )
+{
+    if ( m_loaders->isStale( sender() ) )
+        return;
+
+    m_rootItem->fetchingMore = false;
+    m_rootItem->fetchedAll = artists.count() < BROWSE_PAGE_SIZE;
+    if ( !artists.isEmpty() )
+    {
+        // never null, so the next page knows it isn't the first one
+        m_artistsAfter = DatabaseImpl::sortname( artists.last()->name() );
+        if ( m_artistsAfter.isNull() )
+            m_artistsAfter = QString( "" );
+    }
+
+    onArtistsAdded( artists );
+}
+
+
 void
 TreeModel::onAlbumsAdded( const QList<Tomahawk::album_ptr>& albums, const QModelIndex& parent )
 {
@@ -823,7 +948,8 @@ TreeModel::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks, const QModel
     TreeModelItem* item = 0;
     foreach( const query_ptr& query, tracks )
     {
-        if ( query->numResults() )
+        // SuperCollection tracks stay query items, so they follow their results going online and offline
+        if ( query->numResults() && !m_collection.isNull() )
             item = new TreeModelItem( query->results().first(), parentItem );
         else
             item = new TreeModelItem( query, parentItem );
@@ -840,6 +966,9 @@ TreeModel::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks, const QModel
 void
 TreeModel::onTracksFound( const QList<Tomahawk::query_ptr>& tracks, const QVariant& variant )
 {
+    if ( m_loaders->isStale( sender() ) )
+        return;
+
     QList< QVariant > rows = variant.toList();
     QModelIndex idx = index( rows.first().toUInt(), 0, index( rows.at( 1 ).toUInt(), 0, QModelIndex() ) );
 
@@ -847,10 +976,95 @@ TreeModel::onTracksFound( const QList<Tomahawk::query_ptr>& tracks, const QVaria
 }
 
 
+void
+TreeModel::onSuperCollectionLoaded()
+{
+    QList< QPair< album_ptr, QVariant > > pending = m_pendingAlbums;
+    m_pendingAlbums.clear();
+
+    for ( int i = 0; i < pending.count(); i++ )
+        onTracksFound( SuperCollection::instance()->tracks( pending.at( i ).first ), pending.at( i ).second );
+}
+
+
+void
+TreeModel::onSuperCollectionTracksAdded( const QList<Tomahawk::query_ptr>& tracks )
+{
+    // albums still waiting for the SuperCollection get all their tracks once it's loaded
+    if ( !m_collection.isNull() || !SuperCollection::instance()->isLoaded() )
+        return;
+
+    QSet< Tomahawk::Query* > added;
+    foreach ( const query_ptr& query, tracks )
+        added << query.data();
+
+    foreach ( TreeModelItem* albumitem, expandedAlbums() )
+    {
+        QList< query_ptr > ql;
+        foreach ( const query_ptr& query, SuperCollection::instance()->tracks( albumitem->album() ) )
+        {
+            if ( added.contains( query.data() ) )
+                ql << query;
+        }
+
+        if ( !ql.isEmpty() )
+            onTracksAdded( ql, albumitem->index );
+    }
+}
+
+
+void
+TreeModel::onSuperCollectionTracksRemoved( const QList<Tomahawk::query_ptr>& tracks )
+{
+    if ( !m_collection.isNull() )
+        return;
+
+    QSet< Tomahawk::Query* > removed;
+    foreach ( const query_ptr& query, tracks )
+        removed << query.data();
+
+    foreach ( TreeModelItem* albumitem, expandedAlbums() )
+    {
+        for ( int i = albumitem->children.count() - 1; i >= 0; i-- )
+        {
+            if ( removed.contains( albumitem->children.at( i )->query().data() ) )
+                removeIndex( albumitem->children.at( i )->index );
+        }
+    }
+}
+
+
+QList< TreeModelItem* >
+TreeModel::expandedAlbums() const
+{
+    QList< TreeModelItem* > albums;
+    foreach ( TreeModelItem* artistitem, m_rootItem->children )
+    {
+        foreach ( TreeModelItem* albumitem, artistitem->children )
+        {
+            if ( !albumitem->album().isNull() && albumitem->fetchedAll )
+                albums << albumitem;
+        }
+    }
+
+    return albums;
+}
+
+
 void
 TreeModel::onAlbumsFound( const QList<Tomahawk::album_ptr>& albums, const QVariant& variant )
 {
+    if ( m_loaders->isStale( sender() ) )
+        return;
+
     QModelIndex idx = index( variant.toInt(), 0, QModelIndex() );
+    TreeModelItem* parentItem = itemFromIndex( idx );
+    if ( parentItem != m_rootItem )
+    {
+        parentItem->fetchingMore = false;
+        parentItem->fetchedAll = albums.count() < BROWSE_PAGE_SIZE;
+    }
+
     onAlbumsAdded( albums, idx );
 }
 
@@ -1007,15 +1221,10 @@ TreeModel::setColumnStyle( TreeModel::ColumnStyle style )
 QModelIndex
 TreeModel::indexFromArtist( const Tomahawk::artist_ptr& artist ) const
 {
-    for ( int i = 0; i < rowCount(); i++ )
-    {
-        QModelIndex idx = index( i, 0, QModelIndex() );
-        TreeModelItem* item = itemFromIndex( idx );
-        if ( item && item->artist() == artist )
-        {
-            return idx;
-        }
-    }
+    // removed items leave an invalid index behind
+    const QPersistentModelIndex idx = m_artistIndex.value( artist.data() );
+    if ( !idx.isValid() || itemFromIndex( idx )->artist() != artist )
+        return QModelIndex();
 
-    return QModelIndex();
+    return idx;
 }
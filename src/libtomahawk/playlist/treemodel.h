@@ -36,6 +36,7 @@
 #include "typedefs.h"
 
 class QMetaData;
+class DatabaseCommandGroup;
 
 class DLLEXPORT TreeModel : public QAbstractItemModel
 {
@@ -95,6 +96,11 @@ public:
     void addFilteredCollection( const Tomahawk::collection_ptr& collection, unsigned int amount, DatabaseCommand_AllArtists::SortOrder order );
 
     void addArtists( const Tomahawk::artist_ptr& artist );
+    // lets artists show up before their page is fetched, e.g. because they match a filter
+    void addArtists( const QList<Tomahawk::artist_ptr>& artists );
+    // loads the next page of artists, views call this as they get scrolled to the bottom
+    void fetchMoreArtists();
+    bool canFetchMoreArtists() const;
     void addAlbums( const Tomahawk::artist_ptr& artist, const QModelIndex& parent, bool autoRefetch = false );
     void addTracks( const Tomahawk::album_ptr& album, const QModelIndex& parent, bool autoRefetch = false );
 
@@ -145,10 +151,14 @@ protected:
 
 private slots:
     void onArtistsAdded( const QList<Tomahawk::artist_ptr>& artists );
+    void onArtistsPage( const QList<Tomahawk::artist_ptr>& artists );
     void onAlbumsAdded( const QList<Tomahawk::album_ptr>& albums, const QModelIndex& index );
     void onAlbumsFound( const QList<Tomahawk::album_ptr>& albums, const QVariant& variant );
     void onTracksAdded( const QList<Tomahawk::query_ptr>& tracks, const QModelIndex& index );
     void onTracksFound( const QList<Tomahawk::query_ptr>& tracks, const QVariant& variant );
+    void onSuperCollectionLoaded();
+    void onSuperCollectionTracksAdded( const QList<Tomahawk::query_ptr>& tracks );
+    void onSuperCollectionTracksRemoved( const QList<Tomahawk::query_ptr>& tracks );
 
     void infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
 
@@ -161,6 +171,9 @@ private slots:
     void onCollectionChanged();
 
 private:
+    // album items whose tracks have been loaded
+    QList< TreeModelItem* > expandedAlbums() const;
+
     QPersistentModelIndex m_currentIndex;
     TreeModelItem* m_rootItem;
     QString m_infoId;
@@ -175,6 +188,14 @@ private:
 
     Tomahawk::collection_ptr m_collection;
     QList<Tomahawk::InfoSystem::InfoStringHash> m_receivedInfoData;
+    DatabaseCommandGroup* m_loaders;
+
+    bool m_pagingArtists;
+    QString m_artistsAfter; // sortname of the last artist paged in
+    QHash< Tomahawk::Artist*, QPersistentModelIndex > m_artistIndex;
+
+    // albums expanded before the SuperCollection finished loading
+    QList< QPair< Tomahawk::album_ptr, QVariant > > m_pendingAlbums;
 };
 
 #endif // ALBUMMODEL_H
@@ -49,6 +49,7 @@ TreeModelItem::TreeModelItem( TreeModelItem* parent, QAbstractItemModel* model )
     childCount = 0;
     toberemoved = false;
     fetchingMore = false;
+    fetchedAll = true; // models page artists in explicitly, see TreeModel::fetchMoreArtists()
     m_isPlaying = false;
 
     if ( parent )
@@ -64,6 +65,7 @@ TreeModelItem::TreeModelItem( const Tomahawk::album_ptr& album, TreeModelItem* p
 {
     this->parent = parent;
     fetchingMore = false;
+    fetchedAll = false;
     m_isPlaying = false;
 
     if ( parent )
@@ -93,6 +95,7 @@ TreeModelItem::TreeModelItem( const Tomahawk::artist_ptr& artist, TreeModelItem*
 {
     this->parent = parent;
     fetchingMore = false;
+    fetchedAll = false;
     m_isPlaying = false;
 
     if ( parent )
@@ -122,6 +125,7 @@ TreeModelItem::TreeModelItem( const Tomahawk::result_ptr& result, TreeModelItem*
 {
     this->parent = parent;
     fetchingMore = false;
+    fetchedAll = false;
     m_isPlaying = false;
 
     if ( parent )
@@ -149,6 +153,7 @@ TreeModelItem::TreeModelItem( const Tomahawk::query_ptr& query, TreeModelItem* p
 {
     this->parent = parent;
     fetchingMore = false;
+    fetchedAll = false;
     m_isPlaying = false;
 
     if ( parent )
@@ -168,6 +173,9 @@ TreeModelItem::TreeModelItem( const Tomahawk::query_ptr& query, TreeModelItem* p
 
     toberemoved = false;
 
+    if ( query->numResults() )
+        m_result = query->results().first();
+
     connect( query.data(), SIGNAL( resultsAdded( QList<Tomahawk::result_ptr> ) ),
                              SLOT( onResultsChanged() ) );
 
@@ -61,6 +61,7 @@ public:
 
     bool toberemoved;
     bool fetchingMore;
+    bool fetchedAll; // no more children left to fetch
 
 signals:
     void dataChanged();
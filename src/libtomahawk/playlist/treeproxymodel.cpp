@@ -26,12 +26,14 @@
 #include "database/database.h"
 #include "database/databaseimpl.h"
 #include "database/databasecommand_allalbums.h"
+#include "database/databasecommand_allartists.h"
+#include "database/databasecommandgroup.h"
 #include "utils/logger.h"
 
 
 TreeProxyModel::TreeProxyModel( QObject* parent )
     : QSortFilterProxyModel( parent )
-    , m_artistsFilterCmd( 0 )
+    , m_filterLoaders( new DatabaseCommandGroup( this ) )
     , m_model( 0 )
 {
     setFilterCaseSensitivity( Qt::CaseInsensitive );
@@ -98,7 +100,7 @@ TreeProxyModel::onRowsInserted( const QModelIndex& parent, int /* start */, int
     connect( cmd, SIGNAL( albums( QList<Tomahawk::album_ptr>, QVariant ) ),
                     SLOT( onFilterAlbums( QList<Tomahawk::album_ptr> ) ) );
 
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    m_filterLoaders->enqueue( cmd );
 }
 
 
@@ -119,13 +121,8 @@ TreeProxyModel::newFilterFromPlaylistInterface( const QString &pattern )
     m_filter = pattern;
     m_albumsFilter.clear();
 
-    if ( m_artistsFilterCmd )
-    {
-        disconnect( m_artistsFilterCmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
-                    this,                 SLOT( onFilterArtists( QList<Tomahawk::artist_ptr> ) ) );
-
-        m_artistsFilterCmd = 0;
-    }
+    // whatever is still searching for the previous filter is of no use anymore
+    m_filterLoaders->cancel();
 
     if ( m_filter.isEmpty() )
     {
@@ -135,12 +132,11 @@ TreeProxyModel::newFilterFromPlaylistInterface( const QString &pattern )
     {
         DatabaseCommand_AllArtists* cmd = new DatabaseCommand_AllArtists( m_model->collection() );
         cmd->setFilter( pattern );
-        m_artistsFilterCmd = cmd;
 
         connect( cmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
                         SLOT( onFilterArtists( QList<Tomahawk::artist_ptr> ) ) );
 
-        Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+        m_filterLoaders->enqueue( cmd );
     }
 }
 
@@ -148,9 +144,14 @@ TreeProxyModel::newFilterFromPlaylistInterface( const QString &pattern )
 void
 TreeProxyModel::onFilterArtists( const QList<Tomahawk::artist_ptr>& artists )
 {
+    if ( m_filterLoaders->isStale( sender() ) )
+        return;
+
     bool finished = true;
     m_artistsFilter = artists;
-    m_artistsFilterCmd = 0;
+
+    // matches that haven't been paged in yet
+    m_model->addArtists( artists );
 
     foreach ( const Tomahawk::artist_ptr& artist, artists )
     {
@@ -166,7 +167,7 @@ TreeProxyModel::onFilterArtists( const QList<Tomahawk::artist_ptr>& artists )
             connect( cmd, SIGNAL( albums( QList<Tomahawk::album_ptr>, QVariant ) ),
                             SLOT( onFilterAlbums( QList<Tomahawk::album_ptr> ) ) );
 
-            Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+            m_filterLoaders->enqueue( cmd );
         }
     }
 
@@ -178,6 +179,9 @@ TreeProxyModel::onFilterArtists( const QList<Tomahawk::artist_ptr>& artists )
 void
 TreeProxyModel::onFilterAlbums( const QList<Tomahawk::album_ptr>& albums )
 {
+    if ( m_filterLoaders->isStale( sender() ) )
+        return;
+
     foreach ( const Tomahawk::album_ptr& album, albums )
         m_albumsFilter << album->id();
 
@@ -188,8 +192,6 @@ TreeProxyModel::onFilterAlbums( const QList<Tomahawk::album_ptr>& albums )
 void
 TreeProxyModel::filterFinished()
 {
-    m_artistsFilterCmd = 0;
-
     if ( qobject_cast< Tomahawk::TreeProxyModelPlaylistInterface* >( m_playlistInterface.data() )->vanillaFilter() != m_filter )
     {
         emit filterChanged( m_filter );
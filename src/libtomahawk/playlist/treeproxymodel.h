@@ -26,7 +26,7 @@
 
 #include "dllmacro.h"
 
-class DatabaseCommand_AllArtists;
+class DatabaseCommandGroup;
 
 namespace Tomahawk
 {
@@ -84,7 +84,7 @@ private:
 
     QList<Tomahawk::artist_ptr> m_artistsFilter;
     QList<int> m_albumsFilter;
-    DatabaseCommand_AllArtists* m_artistsFilterCmd;
+    DatabaseCommandGroup* m_filterLoaders;
 
      QString m_filter;
 
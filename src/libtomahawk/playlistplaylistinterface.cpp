@@ -30,6 +30,7 @@ PlaylistPlaylistInterface::PlaylistPlaylistInterface( Tomahawk::Playlist* playli
     : Tomahawk::PlaylistInterface()
     , m_playlist( playlist )
 {
+    connect( playlist, SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), SLOT( onRevisionLoaded() ) );
 }
 
 
@@ -49,16 +50,31 @@ PlaylistPlaylistInterface::unfilteredTrackCount() const
 int
 PlaylistPlaylistInterface::trackCount() const
 {
-    return ( m_playlist.isNull() ? 0 : m_playlist.data()->entries().count() );
+    if ( m_playlist.isNull() )
+        return 0;
+
+    // an unopened peer's playlist starts loading here, trackCountChanged() tells once it's done
+    m_playlist.data()->ensureLoaded();
+    return m_playlist.data()->entries().count();
 }
 
 
 QList< Tomahawk::query_ptr >
 PlaylistPlaylistInterface::tracks()
 {
+    if ( !m_playlist.isNull() )
+        m_playlist.data()->ensureLoaded();
+
     QList<Tomahawk::query_ptr> queries;
     foreach( const plentry_ptr& p, ( m_playlist.isNull() ? QList< Tomahawk::plentry_ptr >() : m_playlist.data()->entries() ) )
         queries << p->query();
 
     return queries;
 }
+
+
+void
+PlaylistPlaylistInterface::onRevisionLoaded()
+{
+    emit trackCountChanged( trackCount() );
+}
@@ -60,6 +60,9 @@ public slots:
     virtual void setRepeatMode( PlaylistInterface::RepeatMode ) {}
     virtual void setShuffled( bool ) {}
 
+private slots:
+    void onRevisionLoaded();
+
 private:
     PlaylistPlaylistInterface();
     Q_DISABLE_COPY( PlaylistPlaylistInterface )
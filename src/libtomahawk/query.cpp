@@ -70,9 +70,9 @@ Query::get( const QString& query, const QID& qid )
 
 Query::Query( const QString& artist, const QString& track, const QString& album, const QID& qid, bool autoResolve )
     : m_qid( qid )
-    , m_artist( artist )
-    , m_album( album )
-    , m_track( track )
+    , m_artist( StringPool::intern( artist ) )
+    , m_album( StringPool::intern( album ) )
+    , m_track( StringPool::intern( track ) )
     , m_socialActionsLoaded( false )
 {
     init();
@@ -129,17 +129,17 @@ Query::updateSortNames()
 {
     if ( isFullTextQuery() )
     {
-        m_artistSortname = DatabaseImpl::sortname( m_fullTextQuery, true );
-        m_composerSortName = DatabaseImpl::sortname( m_composer, true );
-        m_albumSortname = DatabaseImpl::sortname( m_fullTextQuery );
+        m_artistSortname = StringPool::intern( DatabaseImpl::sortname( m_fullTextQuery, true ) );
+        m_composerSortName = StringPool::intern( DatabaseImpl::sortname( m_composer, true ) );
+        m_albumSortname = StringPool::intern( DatabaseImpl::sortname( m_fullTextQuery ) );
         m_trackSortname = m_albumSortname;
     }
     else
     {
-        m_artistSortname = DatabaseImpl::sortname( m_artist, true );
-        m_composerSortName = DatabaseImpl::sortname( m_composer, true );
-        m_albumSortname = DatabaseImpl::sortname( m_album );
-        m_trackSortname = DatabaseImpl::sortname( m_track );
+        m_artistSortname = StringPool::intern( DatabaseImpl::sortname( m_artist, true ) );
+        m_composerSortName = StringPool::intern( DatabaseImpl::sortname( m_composer, true ) );
+        m_albumSortname = StringPool::intern( DatabaseImpl::sortname( m_album ) );
+        m_trackSortname = StringPool::intern( DatabaseImpl::sortname( m_track ) );
     }
 }
 
@@ -318,6 +318,10 @@ Query::resultSorter( const result_ptr& left, const result_ptr& right )
 
     if ( ls == rs )
     {
+        // of equally good results, the ones we can play right now come first
+        if ( left->isOnline() != right->isOnline() )
+            return left->isOnline();
+
         if ( !left->collection().isNull() && left->collection()->source()->isLocal() )
             return true;
         else
@@ -26,6 +26,7 @@
 
 #include "typedefs.h"
 #include "result.h"
+#include "utils/stringpool.h"
 
 #include "dllmacro.h"
 
@@ -81,10 +82,10 @@ public:
     Tomahawk::Resolver* currentResolver() const;
     QList< QWeakPointer< Tomahawk::Resolver > > resolvedBy() const { return m_resolvers; }
 
-    void setArtist( const QString& artist ) { m_artist = artist; updateSortNames(); }
-    void setComposer( const QString& composer ) { m_composer = composer; updateSortNames(); }
-    void setAlbum( const QString& album ) { m_album = album; updateSortNames(); }
-    void setTrack( const QString& track ) { m_track = track; updateSortNames(); }
+    void setArtist( const QString& artist ) { m_artist = StringPool::intern( artist ); updateSortNames(); }
+    void setComposer( const QString& composer ) { m_composer = StringPool::intern( composer ); updateSortNames(); }
+    void setAlbum( const QString& album ) { m_album = StringPool::intern( album ); updateSortNames(); }
+    void setTrack( const QString& track ) { m_track = StringPool::intern( track ); updateSortNames(); }
     void setResultHint( const QString& resultHint ) { m_resultHint = resultHint; }
     void setDuration( int duration ) { m_duration = duration; }
     void setAlbumPos( unsigned int albumpos ) { m_albumpos = albumpos; }
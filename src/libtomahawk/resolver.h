@@ -48,6 +48,15 @@ public:
     virtual unsigned int weight() const = 0;
     virtual unsigned int timeout() const = 0;
 
+    // max amount of queries a resolver wants to get in a single resolveBatch() call, 1 if it can't batch
+    virtual unsigned int batchSize() const { return 1; }
+
+    virtual void resolveBatch( const QList< Tomahawk::query_ptr >& queries )
+    {
+        foreach ( const Tomahawk::query_ptr& query, queries )
+            resolve( query );
+    }
+
 public slots:
     virtual void resolve( const Tomahawk::query_ptr& query ) = 0;
 };
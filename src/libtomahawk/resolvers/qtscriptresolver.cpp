@@ -37,6 +37,7 @@
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QCryptographicHash>
+#include <QtCore/QTime>
 
 // FIXME: bloody hack, remove this for 0.3
 // this one adds new functionality to old resolvers
@@ -44,6 +45,11 @@
 // this one keeps old code invokable
 #define RESOLVER_LEGACY_CODE2 "var resolver = Tomahawk.resolver.instance ? Tomahawk.resolver.instance : window;"
 
+// max time in ms spent evaluating queued queries before returning to the event loop
+#define QUEUE_SLICE 15
+// max time in ms a single resolve() call may block the event loop before the resolver is disabled
+#define RESOLVE_BUDGET 1000
+
 
 QtScriptResolverHelper::QtScriptResolverHelper( const QString& scriptPath, QtScriptResolver* parent )
     : QObject( parent )
@@ -173,20 +179,111 @@ QtScriptResolverHelper::addCustomUrlHandler( const QString& protocol, const QStr
 
 QSharedPointer< QIODevice >
 QtScriptResolverHelper::customIODeviceFactory( const Tomahawk::result_ptr& result )
+{
+    // WebKit may only be touched from our thread, and whoever asks might be what our thread is waiting for
+    return QSharedPointer< QIODevice >( new ScriptStreamDevice( this, result->url() ), &QObject::deleteLater );
+}
+
+
+void
+QtScriptResolverHelper::requestStreamUrl( const QString& requestId, const QString& url )
+{
+    emit streamUrlReady( requestId, streamUrl( url ) );
+}
+
+
+QString
+QtScriptResolverHelper::streamUrl( const QString& url )
 {
     QString getUrl = QString( "Tomahawk.resolver.instance.%1( '%2' );" ).arg( m_urlCallback )
-                                                                        .arg( QString( QUrl( result->url() ).toEncoded() ) );
+                                                                        .arg( QString( QUrl( url ).toEncoded() ) );
 
-    QString urlStr = m_resolver->m_engine->mainFrame()->evaluateJavaScript( getUrl ).toString();
+    return m_resolver->m_engine->mainFrame()->evaluateJavaScript( getUrl ).toString();
+}
+
+
+ScriptStreamDevice::ScriptStreamDevice( QtScriptResolverHelper* helper, const QString& url )
+    : QIODevice()
+    , m_requestId( uuid() )
+    , m_reply( 0 )
+    , m_finished( false )
+{
+    open( QIODevice::ReadOnly );
+
+    connect( helper, SIGNAL( streamUrlReady( QString, QString ) ), SLOT( onStreamUrl( QString, QString ) ) );
+    QMetaObject::invokeMethod( helper, "requestStreamUrl", Qt::QueuedConnection, Q_ARG( QString, m_requestId ), Q_ARG( QString, url ) );
+}
 
-    if ( urlStr.isEmpty() )
-        return QSharedPointer< QIODevice >();
 
-    QUrl url = QUrl::fromEncoded( urlStr.toUtf8() );
-    QNetworkRequest req( url );
-    tDebug() << "Creating a QNetowrkReply with url:" << req.url().toString();
-    QNetworkReply* reply = TomahawkUtils::nam()->get( req );
-    return QSharedPointer<QIODevice>( reply, &QObject::deleteLater );
+ScriptStreamDevice::~ScriptStreamDevice()
+{
+    if ( m_reply )
+        m_reply->deleteLater();
+}
+
+
+bool
+ScriptStreamDevice::atEnd() const
+{
+    return m_finished && bytesAvailable() == 0;
+}
+
+
+qint64
+ScriptStreamDevice::bytesAvailable() const
+{
+    return ( m_reply ? m_reply->bytesAvailable() : 0 ) + QIODevice::bytesAvailable();
+}
+
+
+qint64
+ScriptStreamDevice::readData( char* data, qint64 maxSize )
+{
+    if ( !m_reply )
+        return 0;
+
+    return m_reply->read( data, maxSize );
+}
+
+
+qint64
+ScriptStreamDevice::writeData( const char* data, qint64 maxSize )
+{
+    Q_UNUSED( data );
+    Q_UNUSED( maxSize );
+    return -1;
+}
+
+
+void
+ScriptStreamDevice::onStreamUrl( const QString& requestId, const QString& streamUrl )
+{
+    if ( requestId != m_requestId )
+        return;
+
+    disconnect( sender(), SIGNAL( streamUrlReady( QString, QString ) ), this, SLOT( onStreamUrl( QString, QString ) ) );
+
+    if ( streamUrl.isEmpty() )
+    {
+        setErrorString( "Resolver returned no stream url" );
+        onFinished();
+        return;
+    }
+
+    QNetworkRequest req( QUrl::fromEncoded( streamUrl.toUtf8() ) );
+    tDebug() << "Creating a QNetworkReply with url:" << req.url().toString();
+    m_reply = TomahawkUtils::nam()->get( req );
+
+    connect( m_reply, SIGNAL( readyRead() ), SIGNAL( readyRead() ) );
+    connect( m_reply, SIGNAL( finished() ), SLOT( onFinished() ) );
+}
+
+
+void
+ScriptStreamDevice::onFinished()
+{
+    m_finished = true;
+    emit readChannelFinished();
 }
 
 
@@ -206,6 +303,7 @@ QtScriptResolver::QtScriptResolver( const QString& scriptPath )
     , m_stopped( true )
     , m_error( Tomahawk::ExternalResolver::NoError )
     , m_resolverHelper( new QtScriptResolverHelper( scriptPath, this ) )
+    , m_queueScheduled( false )
 {
     tLog() << Q_FUNC_INFO << "Loading JS resolver:" << scriptPath;
 
@@ -315,6 +413,10 @@ void
 QtScriptResolver::start()
 {
     m_stopped = false;
+    // a resolver disabled for being too slow gets another chance once it's enabled again
+    if ( m_error == Tomahawk::ExternalResolver::FailedToLoad )
+        m_error = Tomahawk::ExternalResolver::NoError;
+
     if ( m_ready )
         Tomahawk::Pipeline::instance()->addResolver( this );
     else
@@ -332,12 +434,54 @@ QtScriptResolver::error() const
 void
 QtScriptResolver::resolve( const Tomahawk::query_ptr& query )
 {
-    if ( QThread::currentThread() != thread() )
+    // never evaluate right away: bulk resolves would block the GUI thread and every other resolver behind us
+    QMutexLocker lock( &m_queueMutex );
+    m_queue << query;
+
+    if ( !m_queueScheduled )
     {
-        QMetaObject::invokeMethod( this, "resolve", Qt::QueuedConnection, Q_ARG(Tomahawk::query_ptr, query) );
-        return;
+        m_queueScheduled = true;
+        QMetaObject::invokeMethod( this, "processQueue", Qt::QueuedConnection );
+    }
+}
+
+
+void
+QtScriptResolver::processQueue()
+{
+    QTime t;
+    t.start();
+
+    forever
+    {
+        Tomahawk::query_ptr query;
+        {
+            QMutexLocker lock( &m_queueMutex );
+            if ( m_queue.isEmpty() )
+            {
+                m_queueScheduled = false;
+                return;
+            }
+
+            if ( t.elapsed() >= QUEUE_SLICE )
+            {
+                // give the event loop, and with it other resolvers, a chance to run
+                QMetaObject::invokeMethod( this, "processQueue", Qt::QueuedConnection );
+                return;
+            }
+
+            query = m_queue.takeFirst();
+        }
+
+        if ( !m_stopped )
+            doResolve( query );
     }
+}
 
+
+void
+QtScriptResolver::doResolve( const Tomahawk::query_ptr& query )
+{
     QString eval;
     if ( !query->isFullTextQuery() )
     {
@@ -359,8 +503,23 @@ QtScriptResolver::resolve( const Tomahawk::query_ptr& query )
                   .arg( query->fullTextQuery().replace( "'", "\\'" ) );
     }
 
+    QTime t;
+    t.start();
+
     QVariantMap m = m_engine->mainFrame()->evaluateJavaScript( eval ).toMap();
 
+    // a call can't be cut short from here, WebKit only aborts runaway scripts itself through
+    // ScriptEngine::shouldInterruptJavaScript(). Don't let a slow resolver stall the UI again
+    if ( t.elapsed() > RESOLVE_BUDGET )
+    {
+        tLog() << "Resolver" << name() << "blocked for" << t.elapsed() << "ms resolving" << query->toString() << "- disabling it";
+
+        m_error = Tomahawk::ExternalResolver::FailedToLoad;
+        stop();
+        emit changed();
+        return;
+    }
+
     if( m.isEmpty() )
     {
         // if the resolver doesn't return anything, async api is used
@@ -433,6 +592,9 @@ QtScriptResolver::stop()
 {
     m_stopped = true;
     Tomahawk::Pipeline::instance()->removeResolver( this );
+
+    QMutexLocker lock( &m_queueMutex );
+    m_queue.clear();
     emit stopped();
 }
 
@@ -26,6 +26,7 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include <QtWebKit/QWebPage>
 #include <QtWebKit/QWebFrame>
@@ -36,6 +37,7 @@
 
 #include "dllmacro.h"
 
+class QNetworkReply;
 class QtScriptResolver;
 
 class DLLEXPORT QtScriptResolverHelper : public QObject
@@ -52,8 +54,12 @@ public:
 
     Q_INVOKABLE void addCustomUrlHandler( const QString& protocol, const QString& callbackFuncName );
 
+    // may be called from any thread, the script itself is always evaluated in the resolver's thread
     QSharedPointer<QIODevice> customIODeviceFactory( const Tomahawk::result_ptr& result );
 
+signals:
+    void streamUrlReady( const QString& requestId, const QString& streamUrl );
+
 public slots:
     QByteArray readRaw( const QString& fileName );
     QString readBase64( const QString& fileName );
@@ -67,6 +73,12 @@ public slots:
 
     void addTrackResults( const QVariantMap& results );
 
+    // asks the script for the real url of url, answered with streamUrlReady()
+    void requestStreamUrl( const QString& requestId, const QString& url );
+
+private:
+    QString streamUrl( const QString& url );
+
 private:
     QString m_scriptPath, m_urlCallback;
     QVariantMap m_resolverConfig;
@@ -76,6 +88,39 @@ private:
 #endif
 };
 
+/**
+ * Device for results of a custom url scheme, filled once the script told us where the stream is.
+ *
+ * The script is evaluated asynchronously in the resolver's thread, so nobody has to block on it.
+ * Until then, the device is open but has nothing to read.
+ */
+class DLLEXPORT ScriptStreamDevice : public QIODevice
+{
+Q_OBJECT
+
+public:
+    ScriptStreamDevice( QtScriptResolverHelper* helper, const QString& url );
+    virtual ~ScriptStreamDevice();
+
+    virtual bool isSequential() const { return true; }
+    virtual bool atEnd() const;
+    virtual qint64 bytesAvailable() const;
+
+protected:
+    virtual qint64 readData( char* data, qint64 maxSize );
+    virtual qint64 writeData( const char* data, qint64 maxSize );
+
+private slots:
+    void onStreamUrl( const QString& requestId, const QString& streamUrl );
+    void onFinished();
+
+private:
+    QString m_requestId;
+    QNetworkReply* m_reply;
+    bool m_finished;
+};
+
+
 class DLLEXPORT ScriptEngine : public QWebPage
 {
 Q_OBJECT
@@ -144,8 +189,12 @@ public slots:
 signals:
     void stopped();
 
+private slots:
+    void processQueue();
+
 private:
     void init();
+    void doResolve( const Tomahawk::query_ptr& query );
 
     void loadUi();
     QWidget* findWidget( QWidget* widget, const QString& objectName );
@@ -172,6 +221,11 @@ private:
     QtScriptResolverHelper* m_resolverHelper;
     QWeakPointer< QWidget > m_configWidget;
     QList< QVariant > m_dataWidgets;
+
+    // queries waiting to be evaluated, filled from any thread and drained in slices by processQueue()
+    QList< Tomahawk::query_ptr > m_queue;
+    QMutex m_queueMutex;
+    bool m_queueScheduled;
 };
 
 #endif // QTSCRIPTRESOLVER_H
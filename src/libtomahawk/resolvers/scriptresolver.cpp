@@ -37,6 +37,7 @@
 
 ScriptResolver::ScriptResolver( const QString& exe )
     : Tomahawk::ExternalResolverGui( exe )
+    , m_batchSize( 1 )
     , m_num_restarts( 0 )
     , m_msgsize( 0 )
     , m_ready( false )
@@ -231,40 +232,22 @@ ScriptResolver::handleMsg( const QByteArray& msg )
 
     else if ( msgtype == "results" )
     {
-        const QString qid = m.value( "qid" ).toString();
-        QList< Tomahawk::result_ptr > results;
-        const QVariantList reslist = m.value( "results" ).toList();
+        const bool partial = m.value( "partial", false ).toBool();
 
-        foreach( const QVariant& rv, reslist )
+        if ( m.contains( "batch" ) )
         {
-            QVariantMap m = rv.toMap();
-            qDebug() << "Found result:" << m;
-
-            Tomahawk::result_ptr rp = Tomahawk::Result::get( m.value( "url" ).toString() );
-            Tomahawk::artist_ptr ap = Tomahawk::Artist::get( m.value( "artist" ).toString(), false );
-            rp->setArtist( ap );
-            rp->setAlbum( Tomahawk::Album::get( ap, m.value( "album" ).toString(), false ) );
-            rp->setAlbumPos( m.value( "albumpos" ).toUInt() );
-            rp->setTrack( m.value( "track" ).toString() );
-            rp->setDuration( m.value( "duration" ).toUInt() );
-            rp->setBitrate( m.value( "bitrate" ).toUInt() );
-            rp->setSize( m.value( "size" ).toUInt() );
-            rp->setRID( uuid() );
-            rp->setFriendlySource( m_name );
-            rp->setYear( m.value( "year").toUInt() );
-            rp->setDiscNumber( m.value( "discnumber" ).toUInt() );
-
-            rp->setMimetype( m.value( "mimetype" ).toString() );
-            if ( rp->mimetype().isEmpty() )
+            // batched reply: one entry per query of the request, possibly spread over several messages
+            foreach ( const QVariant& bv, m.value( "batch" ).toList() )
             {
-                rp->setMimetype( TomahawkUtils::extensionToMimetype( m.value( "extension" ).toString() ) );
-                Q_ASSERT( !rp->mimetype().isEmpty() );
+                const QVariantMap bm = bv.toMap();
+                Tomahawk::Pipeline::instance()->reportResults( bm.value( "qid" ).toString(), parseResults( bm.value( "results" ).toList() ), partial );
             }
-
-            results << rp;
         }
-
-        Tomahawk::Pipeline::instance()->reportResults( qid, results );
+        else
+        {
+            const QString qid = m.value( "qid" ).toString();
+            Tomahawk::Pipeline::instance()->reportResults( qid, parseResults( m.value( "results" ).toList() ), partial );
+        }
     }
     else if ( msgtype == "playlist" )
     {
@@ -319,11 +302,10 @@ ScriptResolver::cmdExited( int code, QProcess::ExitStatus status )
     }
 }
 
-void
-ScriptResolver::resolve( const Tomahawk::query_ptr& query )
+QVariantMap
+ScriptResolver::queryToVariant( const Tomahawk::query_ptr& query ) const
 {
     QVariantMap m;
-    m.insert( "_msgtype", "rq" );
 
     if ( query->isFullTextQuery() )
     {
@@ -339,6 +321,76 @@ ScriptResolver::resolve( const Tomahawk::query_ptr& query )
         m.insert( "qid", query->id() );
     }
 
+    return m;
+}
+
+
+QList< Tomahawk::result_ptr >
+ScriptResolver::parseResults( const QVariantList& reslist )
+{
+    QList< Tomahawk::result_ptr > results;
+
+    foreach( const QVariant& rv, reslist )
+    {
+        QVariantMap m = rv.toMap();
+        qDebug() << "Found result:" << m;
+
+        Tomahawk::result_ptr rp = Tomahawk::Result::get( m.value( "url" ).toString() );
+        Tomahawk::artist_ptr ap = Tomahawk::Artist::get( m.value( "artist" ).toString(), false );
+        rp->setArtist( ap );
+        rp->setAlbum( Tomahawk::Album::get( ap, m.value( "album" ).toString(), false ) );
+        rp->setAlbumPos( m.value( "albumpos" ).toUInt() );
+        rp->setTrack( m.value( "track" ).toString() );
+        rp->setDuration( m.value( "duration" ).toUInt() );
+        rp->setBitrate( m.value( "bitrate" ).toUInt() );
+        rp->setSize( m.value( "size" ).toUInt() );
+        rp->setRID( uuid() );
+        rp->setFriendlySource( m_name );
+        rp->setYear( m.value( "year").toUInt() );
+        rp->setDiscNumber( m.value( "discnumber" ).toUInt() );
+
+        rp->setMimetype( m.value( "mimetype" ).toString() );
+        if ( rp->mimetype().isEmpty() )
+        {
+            rp->setMimetype( TomahawkUtils::extensionToMimetype( m.value( "extension" ).toString() ) );
+            Q_ASSERT( !rp->mimetype().isEmpty() );
+        }
+
+        results << rp;
+    }
+
+    return results;
+}
+
+
+void
+ScriptResolver::resolve( const Tomahawk::query_ptr& query )
+{
+    QVariantMap m = queryToVariant( query );
+    m.insert( "_msgtype", "rq" );
+
+    const QByteArray msg = m_serializer.serialize( QVariant( m ) );
+    sendMsg( msg );
+}
+
+
+void
+ScriptResolver::resolveBatch( const QList< Tomahawk::query_ptr >& queries )
+{
+    if ( queries.count() == 1 )
+    {
+        resolve( queries.first() );
+        return;
+    }
+
+    QVariantList ql;
+    foreach ( const Tomahawk::query_ptr& query, queries )
+        ql << queryToVariant( query );
+
+    QVariantMap m;
+    m.insert( "_msgtype", "rq" );
+    m.insert( "queries", ql );
+
     const QByteArray msg = m_serializer.serialize( QVariant( m ) );
     sendMsg( msg );
 }
@@ -352,7 +404,9 @@ ScriptResolver::doSetup( const QVariantMap& m )
     m_name    = m.value( "name" ).toString();
     m_weight  = m.value( "weight", 0 ).toUInt();
     m_timeout = m.value( "timeout", 5 ).toUInt() * 1000;
-    qDebug() << "SCRIPT" << filePath() << "READY," << "name" << m_name << "weight" << m_weight << "timeout" << m_timeout;
+    // resolvers announcing a batchsize > 1 understand "rq" messages carrying a list of queries
+    m_batchSize = qMax( 1u, m.value( "batchsize", 1 ).toUInt() );
+    qDebug() << "SCRIPT" << filePath() << "READY," << "name" << m_name << "weight" << m_weight << "timeout" << m_timeout << "batchsize" << m_batchSize;
 
     m_ready = true;
     m_configSent = false;
@@ -45,6 +45,9 @@ public:
     virtual unsigned int weight() const     { return m_weight; }
     virtual unsigned int preference() const { return m_preference; }
     virtual unsigned int timeout() const    { return m_timeout; }
+    virtual unsigned int batchSize() const  { return m_batchSize; }
+
+    virtual void resolveBatch( const QList< Tomahawk::query_ptr >& queries );
 
     virtual QWidget* configUI() const;
     virtual void saveConfig();
@@ -69,6 +72,8 @@ private slots:
 
 private:
     void sendConfig();
+    QVariantMap queryToVariant( const Tomahawk::query_ptr& query ) const;
+    QList< Tomahawk::result_ptr > parseResults( const QVariantList& reslist );
 
     void handleMsg( const QByteArray& msg );
     void sendMsg( const QByteArray& msg );
@@ -79,7 +84,7 @@ private:
 
     QProcess m_proc;
     QString m_name;
-    unsigned int m_weight, m_preference, m_timeout, m_num_restarts;
+    unsigned int m_weight, m_preference, m_timeout, m_batchSize, m_num_restarts;
     QWeakPointer< QWidget > m_configWidget;
 
     quint32 m_msgsize;
@@ -26,35 +26,30 @@
 #include "database/databasecommand_alltracks.h"
 #include "database/databasecommand_addfiles.h"
 
+#include "utils/internmap.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk;
 
-static QHash< QString, QWeakPointer< Result > > s_results;
-static QMutex s_mutex;
+static InternMap< QString, Result > s_results( "result" );
 
 
 Tomahawk::result_ptr
 Result::get( const QString& url )
 {
-    QMutexLocker lock( &s_mutex );
-    if ( s_results.contains( url ) )
-    {
-        return s_results.value( url );
-    }
-
-    result_ptr r = result_ptr( new Result( url ), &Result::deleteLater );
-    s_results.insert( url, r );
+    result_ptr r = s_results.value( url );
+    if ( !r.isNull() )
+        return r;
 
-    return r;
+    // if another thread beat us to it, ours is dropped again right away
+    return s_results.insert( url, result_ptr( new Result( url ), &Result::deleteLater ) );
 }
 
 
 bool
 Result::isCached( const QString& url )
 {
-    QMutexLocker lock( &s_mutex );
-    return ( s_results.contains( url ) );
+    return s_results.contains( url );
 }
 
 
@@ -83,12 +78,7 @@ Result::~Result()
 void
 Result::deleteLater()
 {
-    QMutexLocker lock( &s_mutex );
-
-    if ( s_results.contains( m_url ) )
-    {
-        s_results.remove( m_url );
-    }
+    s_results.removeDead( m_url );
 
     QObject::deleteLater();
 }
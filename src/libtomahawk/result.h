@@ -24,6 +24,7 @@
 #include <QtCore/QVariant>
 
 #include "typedefs.h"
+#include "utils/stringpool.h"
 
 #include "dllmacro.h"
 
@@ -74,6 +75,7 @@ public:
     QString track() const { return m_track; }
     QString url() const { return m_url; }
     QString mimetype() const { return m_mimetype; }
+    QString hash() const { return m_hash; } /// content hash, identical files on different sources share it
     QString friendlySource() const;
 
     unsigned int duration() const { return m_duration; }
@@ -89,12 +91,13 @@ public:
     void setFileId( unsigned int id ) { m_fileId = id; }
     void setRID( RID id ) { m_rid = id; }
     void setCollection( const Tomahawk::collection_ptr& collection );
-    void setFriendlySource( const QString& s ) { m_friendlySource = s; }
+    void setFriendlySource( const QString& s ) { m_friendlySource = StringPool::intern( s ); }
     void setArtist( const Tomahawk::artist_ptr& artist );
     void setAlbum( const Tomahawk::album_ptr& album );
     void setComposer( const Tomahawk::artist_ptr& composer );
-    void setTrack( const QString& track ) { m_track = track; }
-    void setMimetype( const QString& mimetype ) { m_mimetype = mimetype; }
+    void setTrack( const QString& track ) { m_track = StringPool::intern( track ); }
+    void setMimetype( const QString& mimetype ) { m_mimetype = StringPool::intern( mimetype ); }
+    void setHash( const QString& hash ) { m_hash = hash; }
     void setDuration( unsigned int duration ) { m_duration = duration; }
     void setBitrate( unsigned int bitrate ) { m_bitrate = bitrate; }
     void setSize( unsigned int size ) { m_size = size; }
@@ -137,6 +140,7 @@ private:
     QString m_track;
     QString m_url;
     QString m_mimetype;
+    QString m_hash;
     QString m_friendlySource;
 
     unsigned int m_duration;
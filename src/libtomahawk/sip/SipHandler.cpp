@@ -33,6 +33,7 @@
 #include "database/database.h"
 #include "network/controlconnection.h"
 #include "network/servent.h"
+#include "network/connectscheduler.h"
 #include "sourcelist.h"
 #include "tomahawksettings.h"
 #include "utils/logger.h"
@@ -84,6 +85,14 @@ SipHandler::avatar( const QString& name ) const
         return QPixmap();
     }
 }
+
+
+void
+SipHandler::applyAvatar( const QString& name, const Tomahawk::source_ptr& source )
+{
+    if ( !source.isNull() && m_usernameAvatars.contains( name ) )
+        source->setAvatar( m_usernameAvatars.value( name ) );
+}
 #endif
 
 const SipInfo
@@ -160,6 +169,9 @@ SipHandler::onPeerOffline( const QString& jid )
 {
 //    qDebug() << Q_FUNC_INFO;
     qDebug() << "SIP offline:" << jid;
+
+    // no point in retrying someone who's gone
+    ConnectScheduler::instance()->cancel( jid );
 }
 
 
@@ -179,11 +191,11 @@ SipHandler::onSipInfo( const QString& peerId, const SipInfo& info )
             Servent::instance()->externalAddress() <= info.host().hostName() )
         {
             qDebug() << "Initiate connection to" << peerId;
-            Servent::instance()->connectToPeer( info.host().hostName(),
-                                          info.port(),
-                                          info.key(),
-                                          peerId,
-                                          info.uniqname() );
+            ConnectScheduler::instance()->connectToPeer( info.host().hostName(),
+                                                         info.port(),
+                                                         info.key(),
+                                                         peerId,
+                                                         info.uniqname() );
         }
         else
         {
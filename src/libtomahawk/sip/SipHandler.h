@@ -21,6 +21,7 @@
 #define SIPHANDLER_H
 
 #include "sip/SipPlugin.h"
+#include "typedefs.h"
 #include "dllmacro.h"
 
 #include <QObject>
@@ -71,6 +72,9 @@ private slots:
 
     // set data for other sources
     void onAvatarReceived( const QString& from, const QPixmap& avatar );
+
+    // sets the avatar we know for name on a source that just came online
+    void applyAvatar( const QString& name, const Tomahawk::source_ptr& source );
 #endif
 
 private:
@@ -46,6 +46,7 @@ Source::Source( int id, const QString& username )
     , m_id( id )
     , m_updateIndexWhenSynced( false )
     , m_state( DBSyncConnection::UNKNOWN )
+    , m_currentTrackTimer( this ) // so it follows us when SourceList adopts a source created by a peer's connection
     , m_cc( 0 )
     , m_commandCount( 0 )
     , m_avatar( 0 )
@@ -190,6 +191,13 @@ Source::removeCollection( const collection_ptr& c )
 void
 Source::setOffline()
 {
+    // control connections go away on their network threads
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "setOffline", Qt::QueuedConnection );
+        return;
+    }
+
     qDebug() << Q_FUNC_INFO << friendlyName();
     if ( !m_online )
         return;
@@ -209,6 +217,12 @@ Source::setOffline()
 void
 Source::setOnline()
 {
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "setOnline", Qt::QueuedConnection );
+        return;
+    }
+
     qDebug() << Q_FUNC_INFO << friendlyName();
     if ( m_online )
         return;
@@ -378,6 +392,27 @@ Source::addCommand( const QSharedPointer<DatabaseCommand>& command )
 }
 
 
+void
+Source::addCommands( const QList< QSharedPointer<DatabaseCommand> >& commands )
+{
+    // a whole batch of synced ops in one hop from the network thread
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "addCommands", Qt::QueuedConnection, Q_ARG( QList< QSharedPointer<DatabaseCommand> >, commands ) );
+        return;
+    }
+
+    foreach ( const QSharedPointer<DatabaseCommand>& command, commands )
+    {
+        m_cmds << command;
+        if ( !command->singletonCmd() )
+            m_lastCmdGuid = command->guid();
+    }
+
+    m_commandCount = m_cmds.count();
+}
+
+
 void
 Source::executeCommands()
 {
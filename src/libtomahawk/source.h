@@ -130,6 +130,7 @@ private slots:
 
     void executeCommands();
     void addCommand( const QSharedPointer<DatabaseCommand>& command );
+    void addCommands( const QList< QSharedPointer<DatabaseCommand> >& commands );
 
 private:
     void updateTracks();
@@ -18,6 +18,8 @@
 
 #include "sourcelist.h"
 
+#include <QThread>
+
 #include "database/database.h"
 #include "database/databasecommand_loadallsources.h"
 #include "network/remotecollection.h"
@@ -129,7 +131,19 @@ SourceList::add( const source_ptr& source )
     m_sources.insert( source->userName(), source );
 
     if ( source->id() > 0 )
-        m_sources_id2name.insert( source->id(), source->userName() );
+        m_sourcesById.insert( source->id(), source );
+
+    // peers' control connections look up their sources from the network threads
+    if ( QThread::currentThread() != thread() )
+        QMetaObject::invokeMethod( this, "setupSource", Qt::QueuedConnection, Q_ARG( Tomahawk::source_ptr, source ) );
+    else
+        setupSource( source );
+}
+
+
+void
+SourceList::setupSource( const source_ptr& source )
+{
     connect( source.data(), SIGNAL( syncedWithDatabase() ), SLOT( sourceSynced() ) );
 
     collection_ptr coll( new RemoteCollection( source ) );
@@ -144,12 +158,15 @@ SourceList::add( const source_ptr& source )
 void
 SourceList::removeAllRemote()
 {
+    QMutexLocker lock( &m_mut );
+
     foreach( const source_ptr& s, m_sources )
     {
         qDebug() << "Disconnecting" << s->friendlyName() << s->isLocal() << s->controlConnection() << s->isOnline();
         if ( !s->isLocal() && s->controlConnection() )
         {
-            s->controlConnection()->shutdown( true );
+            // the connection lives on a network thread
+            QMetaObject::invokeMethod( s->controlConnection(), "shutdown", Qt::QueuedConnection, Q_ARG( bool, true ) );
         }
     }
 }
@@ -179,7 +196,7 @@ SourceList::get( int id ) const
     if ( id == 0 )
         return m_local;
     else
-        return m_sources.value( m_sources_id2name.value( id ) );
+        return m_sourcesById.value( id );
 }
 
 
@@ -188,24 +205,23 @@ SourceList::get( const QString& username, const QString& friendlyName )
 {
     QMutexLocker lock( &m_mut );
 
-    source_ptr source;
     if ( Database::instance()->dbid() == username )
     {
         return m_local;
     }
 
-    if ( !m_sources.contains( username ) )
+    QHash< QString, source_ptr >::const_iterator it = m_sources.constFind( username );
+    if ( it != m_sources.constEnd() )
     {
-        source = source_ptr( new Source( -1, username ) );
-        source->setFriendlyName( friendlyName );
-        add( source );
-    }
-    else
-    {
-        source = m_sources.value( username );
-        source->setFriendlyName( friendlyName );
+        it.value()->setFriendlyName( friendlyName );
+        return it.value();
     }
 
+    source_ptr source = source_ptr( new Source( -1, username ) );
+    source->setFriendlyName( friendlyName );
+    source->moveToThread( thread() );
+    add( source );
+
     return source;
 }
 
@@ -215,7 +231,8 @@ SourceList::sourceSynced()
 {
     Source* src = qobject_cast< Source* >( sender() );
 
-    m_sources_id2name.insert( src->id(), src->userName() );
+    QMutexLocker lock( &m_mut );
+    m_sourcesById.insert( src->id(), m_sources.value( src->userName() ) );
 }
 
 
@@ -230,7 +247,9 @@ void
 SourceList::latchedOff( const source_ptr& to )
 {
     Source* s = qobject_cast< Source* >( sender() );
-    const source_ptr source = m_sources[ s->userName() ];
+    m_mut.lock();
+    const source_ptr source = m_sources.value( s->userName() );
+    m_mut.unlock();
 
     emit sourceLatchedOff( source, to );
 }
@@ -240,7 +259,9 @@ SourceList::latchedOn( const source_ptr& to )
 {
 
     Source* s = qobject_cast< Source* >( sender() );
-    const source_ptr source = m_sources[ s->userName() ];
+    m_mut.lock();
+    const source_ptr source = m_sources.value( s->userName() );
+    m_mut.unlock();
 
     emit sourceLatchedOn( source, to );
 }
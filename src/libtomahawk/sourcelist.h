@@ -21,7 +21,7 @@
 
 #include <QObject>
 #include <QMutex>
-#include <QMap>
+#include <QHash>
 
 #include "typedefs.h"
 #include "source.h"
@@ -66,15 +66,17 @@ signals:
 private slots:
     void setSources( const QList<Tomahawk::source_ptr>& sources );
     void sourceSynced();
+    void setupSource( const Tomahawk::source_ptr& source );
 
     void latchedOn( const Tomahawk::source_ptr& );
     void latchedOff( const Tomahawk::source_ptr& );
 
 private:
+    // caller holds m_mut
     void add( const Tomahawk::source_ptr& source );
 
-    QMap< QString, Tomahawk::source_ptr > m_sources;
-    QMap< int, QString > m_sources_id2name;
+    QHash< QString, Tomahawk::source_ptr > m_sources; /// by username
+    QHash< int, Tomahawk::source_ptr > m_sourcesById; /// only sources already synced to the db
 
     bool m_isReady;
     Tomahawk::source_ptr m_local;
@@ -0,0 +1,267 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "supercollection.h"
+
+#include <QStringList>
+
+#include "album.h"
+#include "artist.h"
+#include "collection.h"
+#include "query.h"
+#include "result.h"
+#include "sourcelist.h"
+#include "database/database.h"
+#include "database/databasecommand_alltracks.h"
+#include "database/databasecommand_loadfiles.h"
+
+#include "utils/logger.h"
+
+// files per batch while loading all collections
+#define LOAD_CHUNK_SIZE 1000
+
+using namespace Tomahawk;
+
+SuperCollection* SuperCollection::s_instance = 0;
+
+
+SuperCollection*
+SuperCollection::instance()
+{
+    if ( !s_instance )
+    {
+        s_instance = new SuperCollection();
+    }
+
+    return s_instance;
+}
+
+
+SuperCollection::SuperCollection( QObject* parent )
+    : QObject( parent )
+    , m_loading( false )
+    , m_loaded( false )
+{
+}
+
+
+SuperCollection::~SuperCollection()
+{
+    if ( s_instance == this )
+        s_instance = 0;
+}
+
+
+void
+SuperCollection::load()
+{
+    if ( m_loading || m_loaded )
+        return;
+
+    m_loading = true;
+
+    connect( SourceList::instance(), SIGNAL( sourceAdded( Tomahawk::source_ptr ) ),
+                                       SLOT( onSourceAdded( Tomahawk::source_ptr ) ), Qt::UniqueConnection );
+    foreach ( const source_ptr& source, SourceList::instance()->sources() )
+        onSourceAdded( source );
+
+    // stream everyone's files in chunks, merging them one huge batch at once would stall the GUI
+    DatabaseCommand_AllTracks* cmd = new DatabaseCommand_AllTracks();
+    cmd->setChunkSize( LOAD_CHUNK_SIZE );
+    connect( cmd, SIGNAL( tracks( QList<Tomahawk::query_ptr>, QVariant ) ),
+                    SLOT( onTracksLoaded( QList<Tomahawk::query_ptr> ) ) );
+    connect( cmd, SIGNAL( done( Tomahawk::collection_ptr ) ),
+                    SLOT( onLoadFinished() ) );
+
+    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+}
+
+
+QList< query_ptr >
+SuperCollection::tracks( const album_ptr& album ) const
+{
+    if ( album.isNull() )
+        return QList< query_ptr >();
+
+    return m_albums.value( albumKey( album->artist().isNull() ? 0 : album->artist()->id(), album->id() ) );
+}
+
+
+QList< source_ptr >
+SuperCollection::sources( const query_ptr& track ) const
+{
+    QList< source_ptr > sources;
+    foreach ( const result_ptr& result, track->results() )
+    {
+        if ( !result->collection().isNull() && !sources.contains( result->collection()->source() ) )
+            sources << result->collection()->source();
+    }
+
+    return sources;
+}
+
+
+void
+SuperCollection::onSourceAdded( const source_ptr& source )
+{
+    connect( source->collection().data(), SIGNAL( tracksAdded( QList<unsigned int> ) ),
+                                            SLOT( onFilesAdded( QList<unsigned int> ) ), Qt::UniqueConnection );
+    connect( source->collection().data(), SIGNAL( tracksRemoved( QList<unsigned int> ) ),
+                                            SLOT( onFilesRemoved( QList<unsigned int> ) ), Qt::UniqueConnection );
+}
+
+
+void
+SuperCollection::onTracksLoaded( const QList<Tomahawk::query_ptr>& tracks )
+{
+    QList< result_ptr > results;
+    foreach ( const query_ptr& query, tracks )
+        results << query->results();
+
+    addFiles( results );
+}
+
+
+void
+SuperCollection::onLoadFinished()
+{
+    tDebug() << Q_FUNC_INFO << "Loaded" << m_tracks.count() << "unique tracks from" << m_files.count() << "files";
+
+    m_loading = false;
+    m_loaded = true;
+    emit loaded();
+}
+
+
+void
+SuperCollection::onFilesAdded( const QList<unsigned int>& fileids )
+{
+    DatabaseCommand_LoadFiles* cmd = new DatabaseCommand_LoadFiles( fileids );
+    connect( cmd, SIGNAL( results( QList<Tomahawk::result_ptr> ) ),
+                    SLOT( onFilesLoaded( QList<Tomahawk::result_ptr> ) ) );
+
+    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+}
+
+
+void
+SuperCollection::onFilesLoaded( const QList<Tomahawk::result_ptr>& results )
+{
+    const QList< query_ptr > added = addFiles( results );
+    if ( !added.isEmpty() )
+        emit tracksAdded( added );
+}
+
+
+void
+SuperCollection::onFilesRemoved( const QList<unsigned int>& fileids )
+{
+    QList< query_ptr > removed;
+    foreach ( unsigned int fileid, fileids )
+    {
+        const result_ptr result = m_files.take( fileid );
+        if ( result.isNull() )
+            continue;
+
+        const QString key = trackKey( result );
+        const query_ptr track = m_tracks.value( key );
+        if ( track.isNull() )
+            continue;
+
+        track->removeResult( result );
+        if ( track->numResults() )
+            continue;
+
+        // nobody has this track anymore
+        m_tracks.remove( key );
+        const AlbumKey album = albumKey( result->artist()->id(), result->album().isNull() ? 0 : result->album()->id() );
+        m_albums[ album ].removeAll( track );
+        if ( m_albums.value( album ).isEmpty() )
+            m_albums.remove( album );
+
+        removed << track;
+    }
+
+    if ( !removed.isEmpty() )
+        emit tracksRemoved( removed );
+}
+
+
+QList< query_ptr >
+SuperCollection::addFiles( const QList<Tomahawk::result_ptr>& results )
+{
+    // group the files first, so every track sorts its results only once
+    QHash< QString, QList< result_ptr > > files;
+    QStringList keys;
+    foreach ( const result_ptr& result, results )
+    {
+        if ( result.isNull() || result->artist().isNull() || m_files.contains( result->fileId() ) )
+            continue;
+
+        m_files.insert( result->fileId(), result );
+
+        const QString key = trackKey( result );
+        if ( !files.contains( key ) )
+            keys << key;
+        files[ key ] << result;
+    }
+
+    QList< query_ptr > added;
+    foreach ( const QString& key, keys )
+    {
+        const QList< result_ptr >& rl = files[ key ];
+
+        query_ptr track = m_tracks.value( key );
+        if ( track.isNull() )
+        {
+            const result_ptr& first = rl.first();
+            track = Query::get( first->artist()->name(), first->track(), first->album().isNull() ? QString() : first->album()->name(), QString(), false );
+            track->setResolveFinished( true );
+
+            m_tracks.insert( key, track );
+            m_albums[ albumKey( first->artist()->id(), first->album().isNull() ? 0 : first->album()->id() ) ] << track;
+            added << track;
+        }
+
+        track->addResults( rl );
+    }
+
+    return added;
+}
+
+
+QString
+SuperCollection::trackKey( const result_ptr& result )
+{
+    // artist, album and track ids are unique per sortname
+    return QString( "%1\t%2\t%3" ).arg( result->artist()->id() )
+                                  .arg( result->album().isNull() ? 0 : result->album()->id() )
+                                  .arg( result->trackId() );
+}
+
+
+SuperCollection::AlbumKey
+SuperCollection::albumKey( unsigned int artistId, unsigned int albumId )
+{
+    // tracks without an album are grouped by their artist, like DatabaseCommand_AllTracks does
+    if ( albumId )
+        return AlbumKey( 0, albumId );
+
+    return AlbumKey( artistId, 0 );
+}
@@ -0,0 +1,95 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SUPERCOLLECTION_H
+#define SUPERCOLLECTION_H
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+/*
+    The SuperCollection keeps one entry per unique track across the collections
+    of all sources. A track is identified by its artist, album and track ids,
+    which stand for their sortnames. Each entry is a query holding one result
+    per file providing the track, so a track shared by many peers is loaded,
+    sorted and shown only once, and its availability changes as its sources
+    go online and offline.
+
+    load() populates it once, in chunks, after that it follows the collections'
+    tracksAdded and tracksRemoved signals and reports the unique tracks that
+    came and went through its own.
+*/
+class DLLEXPORT SuperCollection : public QObject
+{
+Q_OBJECT
+
+public:
+    static SuperCollection* instance();
+
+    explicit SuperCollection( QObject* parent = 0 );
+    virtual ~SuperCollection();
+
+    bool isLoaded() const { return m_loaded; }
+    void load();
+
+    unsigned int trackCount() const { return m_tracks.count(); }
+    QList< Tomahawk::query_ptr > tracks( const Tomahawk::album_ptr& album ) const;
+    QList< Tomahawk::source_ptr > sources( const Tomahawk::query_ptr& track ) const;
+
+signals:
+    void loaded();
+
+    // unique tracks that showed up in or disappeared from all collections
+    void tracksAdded( const QList<Tomahawk::query_ptr>& tracks );
+    void tracksRemoved( const QList<Tomahawk::query_ptr>& tracks );
+
+private slots:
+    void onSourceAdded( const Tomahawk::source_ptr& source );
+    void onTracksLoaded( const QList<Tomahawk::query_ptr>& tracks );
+    void onLoadFinished();
+
+    void onFilesAdded( const QList<unsigned int>& fileids );
+    void onFilesRemoved( const QList<unsigned int>& fileids );
+    void onFilesLoaded( const QList<Tomahawk::result_ptr>& results );
+
+private:
+    typedef QPair< unsigned int, unsigned int > AlbumKey;
+
+    static QString trackKey( const Tomahawk::result_ptr& result );
+    static AlbumKey albumKey( unsigned int artistId, unsigned int albumId );
+
+    // files we already know of are skipped, returns the tracks that are new
+    QList< Tomahawk::query_ptr > addFiles( const QList<Tomahawk::result_ptr>& results );
+
+    bool m_loading;
+    bool m_loaded;
+
+    QHash< QString, Tomahawk::query_ptr > m_tracks;
+    QHash< AlbumKey, QList< Tomahawk::query_ptr > > m_albums;
+    QHash< unsigned int, Tomahawk::result_ptr > m_files;
+
+    static SuperCollection* s_instance;
+};
+
+#endif // SUPERCOLLECTION_H
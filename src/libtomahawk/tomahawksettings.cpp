@@ -438,6 +438,20 @@ TomahawkSettings::infoSystemCacheVersion() const
 }
 
 
+QDateTime
+TomahawkSettings::lastOplogCompaction() const
+{
+    return value( "database/lastoplogcompaction" ).toDateTime();
+}
+
+
+void
+TomahawkSettings::setLastOplogCompaction( const QDateTime& time )
+{
+    setValue( "database/lastoplogcompaction", time );
+}
+
+
 QString
 TomahawkSettings::storageCacheLocation() const
 {
@@ -627,6 +641,48 @@ TomahawkSettings::setProxyDns( bool lookupViaProxy )
 }
 
 
+qint64
+TomahawkSettings::streamCacheSize() const
+{
+    return value( "network/streamcache/size", 512 * 1024 * 1024 ).toLongLong();
+}
+
+
+void
+TomahawkSettings::setStreamCacheSize( qint64 bytes )
+{
+    setValue( "network/streamcache/size", bytes );
+}
+
+
+qint64
+TomahawkSettings::uploadLimit() const
+{
+    return value( "network/uploadlimit", 0 ).toLongLong();
+}
+
+
+void
+TomahawkSettings::setUploadLimit( qint64 bytesPerSecond )
+{
+    setValue( "network/uploadlimit", bytesPerSecond );
+}
+
+
+QStringList
+TomahawkSettings::recentStreamPeers() const
+{
+    return value( "network/recentstreampeers" ).toStringList();
+}
+
+
+void
+TomahawkSettings::setRecentStreamPeers( const QStringList& nodeids )
+{
+    setValue( "network/recentstreampeers", nodeids );
+}
+
+
 QVariantHash
 TomahawkSettings::aclEntries() const
 {
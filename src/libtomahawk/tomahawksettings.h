@@ -23,6 +23,7 @@
 #include "playlist.h"
 
 #include <QSettings>
+#include <QDateTime>
 #include <QtNetwork/QNetworkProxy>
 
 #include "dllmacro.h"
@@ -53,6 +54,8 @@ public:
     void setScannerTime( uint time );
     uint infoSystemCacheVersion() const;
     void setInfoSystemCacheVersion( uint version );
+    QDateTime lastOplogCompaction() const;
+    void setLastOplogCompaction( const QDateTime& time );
 
     bool watchForChanges() const;
     void setWatchForChanges( bool watch );
@@ -161,6 +164,13 @@ public:
     bool proxyDns() const;
     void setProxyDns( bool lookupViaProxy );
 
+    qint64 streamCacheSize() const; /// max bytes kept on disk for streamed tracks, 512MB by default
+    void setStreamCacheSize( qint64 bytes );
+    qint64 uploadLimit() const; /// bytes per second shared by all outgoing streams, 0 means unlimited
+    void setUploadLimit( qint64 bytesPerSecond );
+    QStringList recentStreamPeers() const; /// nodeids we last streamed from, most recent first
+    void setRecentStreamPeers( const QStringList& nodeids );
+
     /// ACL settings
     QVariantHash aclEntries() const;
     void setAclEntries( const QVariantHash &entries );
@@ -0,0 +1,159 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "covercache.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtCore/QtConcurrentRun>
+
+#include "tomahawksettings.h"
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+
+// memory budget for decoded covers, in KB
+#define COVERCACHE_MAXCOST 48 * 1024
+// scaled covers up to this size get stored as thumbnails on disk
+#define COVERCACHE_MAXTHUMBNAIL 512
+
+CoverCache* CoverCache::s_instance = 0;
+
+
+CoverCache*
+CoverCache::instance()
+{
+    if ( !s_instance )
+        s_instance = new CoverCache( QCoreApplication::instance() );
+
+    return s_instance;
+}
+
+
+CoverCache::CoverCache( QObject* parent )
+    : QObject( parent )
+    , m_thumbnailDir( TomahawkSettings::instance()->storageCacheLocation() + "/CoverCache/" )
+{
+    m_cache.setMaxCost( COVERCACHE_MAXCOST );
+
+    QDir dir( m_thumbnailDir );
+    if ( !dir.exists() && !dir.mkpath( m_thumbnailDir ) )
+        tLog() << "Failed to create cover cache dir:" << m_thumbnailDir;
+}
+
+
+CoverCache::~CoverCache()
+{
+    s_instance = 0;
+}
+
+
+QPixmap
+CoverCache::cover( const QString& id, const QByteArray& data, const QSize& size, QObject* receiver )
+{
+    Q_ASSERT( QThread::currentThread() == thread() );
+
+    if ( id.isEmpty() || data.isEmpty() )
+        return QPixmap();
+
+    const QString key = QString( "%1@%2x%3" ).arg( id ).arg( size.width() ).arg( size.height() );
+    if ( QPixmap* pixmap = m_cache.object( key ) )
+        return *pixmap;
+
+    if ( size.isEmpty() )
+    {
+        // callers asking for the original image need it right away
+        QPixmap pixmap;
+        pixmap.loadFromData( data );
+        insert( key, pixmap );
+        return pixmap;
+    }
+
+    if ( !m_pending.contains( key ) )
+    {
+        QString thumbnailPath;
+        if ( size.width() <= COVERCACHE_MAXTHUMBNAIL && size.height() <= COVERCACHE_MAXTHUMBNAIL )
+            thumbnailPath = m_thumbnailDir + TomahawkUtils::md5( key.toUtf8() ) + ".png";
+
+        m_pending[ key ] = QList< QPointer< QObject > >();
+        QtConcurrent::run( &CoverCache::decode, key, data, size, thumbnailPath );
+    }
+
+    if ( receiver && !m_pending[ key ].contains( receiver ) )
+        m_pending[ key ] << receiver;
+
+    return QPixmap();
+}
+
+
+void
+CoverCache::decode( const QString& key, const QByteArray& data, const QSize& size, const QString& thumbnailPath )
+{
+    QImage image;
+    if ( !thumbnailPath.isEmpty() && QFile::exists( thumbnailPath ) )
+        image.load( thumbnailPath );
+
+    if ( image.isNull() )
+    {
+        image.loadFromData( data );
+        if ( !image.isNull() )
+        {
+            image = image.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+            if ( !thumbnailPath.isEmpty() )
+                image.save( thumbnailPath, "PNG" );
+        }
+    }
+
+    if ( !s_instance )
+        return;
+
+    QMetaObject::invokeMethod( s_instance, "onCoverDecoded", Qt::QueuedConnection,
+                               Q_ARG( QString, key ), Q_ARG( QImage, image ) );
+}
+
+
+void
+CoverCache::onCoverDecoded( const QString& key, const QImage& image )
+{
+    const QList< QPointer< QObject > > receivers = m_pending.take( key );
+    if ( image.isNull() )
+    {
+        tDebug( LOGVERBOSE ) << "Failed to decode cover:" << key;
+        return;
+    }
+
+    insert( key, QPixmap::fromImage( image ) );
+
+    foreach ( const QPointer< QObject >& receiver, receivers )
+    {
+        if ( !receiver.isNull() )
+            QMetaObject::invokeMethod( receiver.data(), "onCoverReady", Qt::DirectConnection );
+    }
+}
+
+
+void
+CoverCache::insert( const QString& key, const QPixmap& pixmap )
+{
+    if ( pixmap.isNull() )
+        return;
+
+    const int cost = qMax( 1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024 );
+    m_cache.insert( key, new QPixmap( pixmap ), cost );
+}
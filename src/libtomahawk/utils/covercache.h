@@ -0,0 +1,75 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COVERCACHE_H
+#define COVERCACHE_H
+
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QSize>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+#include "dllmacro.h"
+
+/**
+ * Process-wide, memory-bounded cache of scaled cover art.
+ *
+ * Covers are keyed by the md5 of their encoded image data plus the requested size, so
+ * identical images shared by several artists / albums are only kept once. Scaled covers
+ * are decoded on a worker thread and persisted as thumbnails on disk; until they're ready
+ * cover() returns a null pixmap, which the delegates replace with a placeholder.
+ */
+class DLLEXPORT CoverCache : public QObject
+{
+Q_OBJECT
+
+public:
+    static CoverCache* instance();
+
+    /**
+     * Returns the cover with id, built from the encoded image data and scaled to size.
+     * An empty size returns the original image, which is decoded synchronously.
+     * If the scaled cover isn't in memory yet, a null pixmap is returned and the
+     * receiver's onCoverReady() slot is invoked as soon as it is.
+     */
+    QPixmap cover( const QString& id, const QByteArray& data, const QSize& size, QObject* receiver = 0 );
+
+    int maxCost() const { return m_cache.maxCost(); }
+    int totalCost() const { return m_cache.totalCost(); }
+
+private slots:
+    void onCoverDecoded( const QString& key, const QImage& image );
+
+private:
+    explicit CoverCache( QObject* parent = 0 );
+    virtual ~CoverCache();
+
+    static void decode( const QString& key, const QByteArray& data, const QSize& size, const QString& thumbnailPath );
+    void insert( const QString& key, const QPixmap& pixmap );
+
+    QString m_thumbnailDir;
+    QCache< QString, QPixmap > m_cache; // cost in KB
+    QHash< QString, QList< QPointer< QObject > > > m_pending;
+
+    static CoverCache* s_instance;
+};
+
+#endif // COVERCACHE_H
@@ -0,0 +1,170 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INTERNMAP_H
+#define INTERNMAP_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QWeakPointer>
+
+#include "utils/metrics.h"
+
+/**
+ * Thread-safe map of weakly referenced, interned objects, so there's only ever one live object per key.
+ *
+ * Keys are spread over a fixed number of shards, each behind its own read-write lock, so lookups from
+ * different threads rarely wait for each other. Entries don't keep their objects alive: the owner's
+ * deleter calls removeDead() once the last strong reference is gone. Lookups, misses and lookups that
+ * had to wait for a lock are published as "intern.<name>.*" counters.
+ */
+template< typename Key, typename T >
+class InternMap
+{
+public:
+    explicit InternMap( const QString& name )
+        : m_name( name )
+    {
+    }
+
+    // the live object for key, or a null pointer
+    QSharedPointer< T > value( const Key& key )
+    {
+        Shard& s = shard( key );
+        lockForRead( s );
+        const QSharedPointer< T > p = s.hash.value( key ).toStrongRef();
+        s.lock.unlock();
+
+        if ( p.isNull() )
+            m_misses.fetchAndAddRelaxed( 1 );
+        lookedUp();
+
+        return p;
+    }
+
+    bool contains( const Key& key )
+    {
+        return !value( key ).isNull();
+    }
+
+    // interns p, unless another thread interned an object for key first, which is returned instead
+    QSharedPointer< T > insert( const Key& key, const QSharedPointer< T >& p )
+    {
+        Shard& s = shard( key );
+        lockForWrite( s );
+        QWeakPointer< T >& entry = s.hash[ key ];
+        QSharedPointer< T > existing = entry.toStrongRef();
+        if ( existing.isNull() )
+        {
+            entry = p;
+            existing = p;
+        }
+        s.lock.unlock();
+
+        return existing;
+    }
+
+    // drops key, unless it was interned again since its last object went away
+    void removeDead( const Key& key )
+    {
+        Shard& s = shard( key );
+        lockForWrite( s );
+        typename QHash< Key, QWeakPointer< T > >::iterator it = s.hash.find( key );
+        if ( it != s.hash.end() && it.value().isNull() )
+            s.hash.erase( it );
+        s.lock.unlock();
+    }
+
+    int count() const
+    {
+        int c = 0;
+        for ( int i = 0; i < ShardCount; i++ )
+        {
+            QReadLocker lock( &m_shards[ i ].lock );
+            c += m_shards[ i ].hash.count();
+        }
+
+        return c;
+    }
+
+private:
+    enum { ShardCount = 16, PublishInterval = 1024 };
+
+    struct Shard
+    {
+        mutable QReadWriteLock lock;
+        QHash< Key, QWeakPointer< T > > hash;
+    };
+
+    Shard& shard( const Key& key )
+    {
+        return m_shards[ qHash( key ) % ShardCount ];
+    }
+
+    void lockForRead( Shard& s )
+    {
+        if ( s.lock.tryLockForRead() )
+            return;
+
+        m_contended.fetchAndAddRelaxed( 1 );
+        s.lock.lockForRead();
+    }
+
+    void lockForWrite( Shard& s )
+    {
+        if ( s.lock.tryLockForWrite() )
+            return;
+
+        m_contended.fetchAndAddRelaxed( 1 );
+        s.lock.lockForWrite();
+    }
+
+    void lookedUp()
+    {
+        // hand the counters over to Metrics in batches, its mutex would be the next bottleneck
+        if ( m_lookups.fetchAndAddRelaxed( 1 ) + 1 < PublishInterval )
+            return;
+
+        const int lookups = m_lookups.fetchAndStoreRelaxed( 0 );
+        if ( lookups < PublishInterval )
+        {
+            // another thread published in the meantime
+            m_lookups.fetchAndAddRelaxed( lookups );
+            return;
+        }
+
+        Metrics* metrics = Metrics::instance();
+        metrics->increment( "intern." + m_name + ".lookups", lookups );
+        metrics->increment( "intern." + m_name + ".misses", m_misses.fetchAndStoreRelaxed( 0 ) );
+        metrics->increment( "intern." + m_name + ".contended", m_contended.fetchAndStoreRelaxed( 0 ) );
+        metrics->setGauge( "intern." + m_name + ".size", count() );
+    }
+
+    QString m_name;
+    Shard m_shards[ ShardCount ];
+
+    QAtomicInt m_lookups;
+    QAtomicInt m_misses;
+    QAtomicInt m_contended;
+};
+
+#endif // INTERNMAP_H
@@ -0,0 +1,183 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.h"
+
+// upper bounds in ms, the last bucket takes everything slower
+static const qint64 s_bucketBounds[] = { 1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000 };
+static const int s_bucketCount = sizeof( s_bucketBounds ) / sizeof( s_bucketBounds[0] ) + 1;
+
+Metrics* Metrics::s_instance = 0;
+
+
+Metrics*
+Metrics::instance()
+{
+    static QMutex s_instanceMutex;
+    QMutexLocker lock( &s_instanceMutex );
+
+    if ( !s_instance )
+        s_instance = new Metrics();
+
+    return s_instance;
+}
+
+
+Metrics::Metrics()
+{
+}
+
+
+Metrics::Histogram::Histogram()
+    : count( 0 )
+    , sum( 0 )
+    , min( 0 )
+    , max( 0 )
+    , buckets( s_bucketCount, 0 )
+{
+}
+
+
+qint64
+Metrics::Histogram::percentile( float p ) const
+{
+    if ( !count )
+        return 0;
+
+    // report the upper bound of the bucket the percentile falls into
+    const qint64 rank = qMax( (qint64)1, (qint64)( p * count + 0.5 ) );
+    qint64 seen = 0;
+    for ( int i = 0; i < buckets.count(); i++ )
+    {
+        seen += buckets.at( i );
+        if ( seen >= rank )
+            return i < s_bucketCount - 1 ? qMin( s_bucketBounds[ i ], max ) : max;
+    }
+
+    return max;
+}
+
+
+void
+Metrics::increment( const QString& name, qint64 by )
+{
+    QMutexLocker lock( &m_mutex );
+    m_counters[ name ] += by;
+}
+
+
+void
+Metrics::setGauge( const QString& name, qint64 value )
+{
+    QMutexLocker lock( &m_mutex );
+    m_gauges[ name ] = value;
+}
+
+
+void
+Metrics::removeGauge( const QString& name )
+{
+    QMutexLocker lock( &m_mutex );
+    m_gauges.remove( name );
+}
+
+
+void
+Metrics::addTiming( const QString& name, qint64 ms )
+{
+    int bucket = 0;
+    while ( bucket < s_bucketCount - 1 && ms > s_bucketBounds[ bucket ] )
+        bucket++;
+
+    QMutexLocker lock( &m_mutex );
+    Histogram& h = m_histograms[ name ];
+    h.min = h.count ? qMin( h.min, ms ) : ms;
+    h.max = qMax( h.max, ms );
+    h.count++;
+    h.sum += ms;
+    h.buckets[ bucket ]++;
+}
+
+
+qint64
+Metrics::counter( const QString& name ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_counters.value( name );
+}
+
+
+QVariantMap
+Metrics::snapshot() const
+{
+    QMutexLocker lock( &m_mutex );
+
+    QVariantMap counters;
+    QHash< QString, qint64 >::const_iterator it;
+    for ( it = m_counters.constBegin(); it != m_counters.constEnd(); ++it )
+        counters[ it.key() ] = it.value();
+
+    QVariantMap gauges;
+    for ( it = m_gauges.constBegin(); it != m_gauges.constEnd(); ++it )
+        gauges[ it.key() ] = it.value();
+
+    QVariantMap histograms;
+    QHash< QString, Histogram >::const_iterator hit;
+    for ( hit = m_histograms.constBegin(); hit != m_histograms.constEnd(); ++hit )
+    {
+        const Histogram& h = hit.value();
+
+        QVariantMap buckets;
+        for ( int i = 0; i < s_bucketCount; i++ )
+        {
+            if ( !h.buckets.at( i ) )
+                continue;
+
+            buckets[ i < s_bucketCount - 1 ? QString::number( s_bucketBounds[ i ] ) : "inf" ] = h.buckets.at( i );
+        }
+
+        QVariantMap m;
+        m[ "count" ] = h.count;
+        m[ "sum" ] = h.sum;
+        m[ "min" ] = h.min;
+        m[ "max" ] = h.max;
+        m[ "mean" ] = h.count ? h.sum / h.count : 0;
+        m[ "p50" ] = h.percentile( 0.5 );
+        m[ "p95" ] = h.percentile( 0.95 );
+        m[ "p99" ] = h.percentile( 0.99 );
+        m[ "buckets" ] = buckets;
+
+        histograms[ hit.key() ] = m;
+    }
+
+    QVariantMap snapshot;
+    snapshot[ "counters" ] = counters;
+    snapshot[ "gauges" ] = gauges;
+    snapshot[ "histograms" ] = histograms;
+
+    return snapshot;
+}
+
+
+void
+Metrics::reset()
+{
+    QMutexLocker lock( &m_mutex );
+    m_counters.clear();
+    m_histograms.clear();
+}
@@ -0,0 +1,79 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+#include <QtCore/QVector>
+
+#include "dllmacro.h"
+
+/**
+ * Process-wide registry of runtime metrics: counters, gauges and latency histograms.
+ *
+ * Metric names are dotted paths, e.g. "database.exec.alltracks" or
+ * "pipeline.resolver.Local Collection". All methods are thread-safe.
+ * snapshot() is served as JSON by the web API (/stats) and shown in the
+ * diagnostics dialog.
+ */
+class DLLEXPORT Metrics
+{
+public:
+    static Metrics* instance();
+
+    void increment( const QString& name, qint64 by = 1 );
+    void setGauge( const QString& name, qint64 value );
+    void removeGauge( const QString& name );
+    void addTiming( const QString& name, qint64 ms );
+
+    qint64 counter( const QString& name ) const;
+
+    // { "counters": {...}, "gauges": {...}, "histograms": { name: { count, sum, min, max, mean, p50, p95, p99, buckets } } }
+    QVariantMap snapshot() const;
+
+    void reset();
+
+private:
+    struct Histogram
+    {
+        Histogram();
+
+        qint64 percentile( float p ) const;
+
+        qint64 count;
+        qint64 sum;
+        qint64 min;
+        qint64 max;
+        QVector< qint64 > buckets;
+    };
+
+    Metrics();
+
+    QHash< QString, qint64 > m_counters;
+    QHash< QString, qint64 > m_gauges;
+    QHash< QString, Histogram > m_histograms;
+    mutable QMutex m_mutex;
+
+    static Metrics* s_instance;
+};
+
+#endif // METRICS_H
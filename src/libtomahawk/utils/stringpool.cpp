@@ -0,0 +1,138 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "stringpool.h"
+
+#include <QtCore/QMutex>
+
+// number of independently locked parts of the pool
+#define POOL_SHARDS 16
+// a shard isn't purged before it holds this many strings
+#define POOL_PURGE_MIN 1024
+
+StringPool* StringPool::s_instance = 0;
+
+
+// what other holders besides the pool keep a reference, QString has no const accessor for it
+static int
+references( const QString& s )
+{
+    return const_cast< QString& >( s ).data_ptr()->ref;
+}
+
+
+static qint64
+footprint( const QString& s )
+{
+    return sizeof( *const_cast< QString& >( s ).data_ptr() ) + s.capacity() * sizeof( QChar );
+}
+
+
+StringPool*
+StringPool::instance()
+{
+    static QMutex s_instanceMutex;
+    QMutexLocker lock( &s_instanceMutex );
+
+    if ( !s_instance )
+        s_instance = new StringPool();
+
+    return s_instance;
+}
+
+
+StringPool::StringPool()
+    : m_shards( new Shard[ POOL_SHARDS ] )
+{
+}
+
+
+StringPool::Shard::Shard()
+    : purgeAt( POOL_PURGE_MIN )
+{
+}
+
+
+QString
+StringPool::lookup( const QString& s )
+{
+    if ( s.isEmpty() )
+        return s;
+
+    Shard& shard = m_shards[ qHash( s ) % POOL_SHARDS ];
+    {
+        QReadLocker lock( &shard.lock );
+        QSet< QString >::const_iterator it = shard.strings.constFind( s );
+        if ( it != shard.strings.constEnd() )
+            return *it;
+    }
+
+    QWriteLocker lock( &shard.lock );
+    QSet< QString >::const_iterator it = shard.strings.constFind( s );
+    if ( it != shard.strings.constEnd() )
+        return *it;
+
+    if ( shard.strings.count() >= shard.purgeAt )
+        purge( shard );
+
+    // don't pin a big buffer s might only be a part of
+    QString pooled = s;
+    pooled.squeeze();
+    shard.strings.insert( pooled );
+
+    return pooled;
+}
+
+
+void
+StringPool::purge( Shard& shard )
+{
+    QSet< QString >::iterator it = shard.strings.begin();
+    while ( it != shard.strings.end() )
+    {
+        if ( it->isDetached() )
+            it = shard.strings.erase( it );
+        else
+            ++it;
+    }
+
+    shard.purgeAt = qMax( POOL_PURGE_MIN, shard.strings.count() * 2 );
+}
+
+
+StringPool::Statistics
+StringPool::statistics() const
+{
+    Statistics stats;
+    for ( int i = 0; i < POOL_SHARDS; i++ )
+    {
+        const Shard& shard = m_shards[ i ];
+        QReadLocker lock( &shard.lock );
+
+        foreach ( const QString& s, shard.strings )
+        {
+            const qint64 size = footprint( s );
+            stats.strings++;
+            stats.bytes += size;
+            stats.unpooledBytes += size * ( references( s ) - 1 );
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,74 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include "dllmacro.h"
+
+/**
+ * Process-wide pool of artist, album and track names, so equal names share one copy.
+ *
+ * intern() returns the pooled, implicitly shared copy of a string. Queries, results, artists
+ * and albums store their names through it. Strings nobody but the pool refers to anymore are
+ * dropped every now and then. All methods are thread-safe.
+ */
+class DLLEXPORT StringPool
+{
+public:
+    struct Statistics
+    {
+        Statistics() : strings( 0 ), bytes( 0 ), unpooledBytes( 0 ) {}
+
+        int strings;
+        qint64 bytes;           // what the pooled strings take
+        qint64 unpooledBytes;   // about what they'd take if every holder had its own copy
+    };
+
+    static StringPool* instance();
+
+    static QString intern( const QString& s ) { return instance()->lookup( s ); }
+
+    QString lookup( const QString& s );
+    Statistics statistics() const;
+
+private:
+    struct Shard
+    {
+        Shard();
+
+        mutable QReadWriteLock lock;
+        QSet< QString > strings;
+        int purgeAt;
+    };
+
+    StringPool();
+
+    void purge( Shard& shard );
+
+    Shard* m_shards;
+
+    static StringPool* s_instance;
+};
+
+#endif // STRINGPOOL_H
@@ -48,6 +48,14 @@ XSPFGenerator::generate()
 {
     Q_ASSERT( !m_playlist.isNull() );
 
+    // a peer's playlist has no entries until it's been opened, come back once they're loaded
+    if ( !m_playlist->ensureLoaded() )
+    {
+        connect( m_playlist.data(), SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), SLOT( generate() ), Qt::UniqueConnection );
+        return;
+    }
+    disconnect( m_playlist.data(), SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), this, SLOT( generate() ) );
+
     QByteArray xspf;
     QXmlStreamWriter w( &xspf );
     w.setAutoFormatting( true );
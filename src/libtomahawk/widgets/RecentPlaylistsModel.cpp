@@ -111,6 +111,14 @@ RecentPlaylistsModel::playlistsLoaded( const QList<DatabaseCommand_LoadAllSorted
             continue;
         }
         connect( pl.data(), SIGNAL( changed() ), this, SLOT( updatePlaylist() ) );
+
+        // a peer's playlists aren't loaded until opened, but we show their artists
+        if ( !pl->loaded() && !pl->busy() && !pl->author()->isLocal() && pl.dynamicCast< Tomahawk::DynamicPlaylist >().isNull() )
+        {
+            connect( pl.data(), SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), this, SLOT( updatePlaylist() ), Qt::UniqueConnection );
+            pl->loadRevision();
+        }
+
         m_playlists << pl;
     }
 
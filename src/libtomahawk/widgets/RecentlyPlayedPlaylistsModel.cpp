@@ -72,7 +72,13 @@ RecentlyPlayedPlaylistsModel::loadFromSettings()
             if( !m_cached.contains( playlist_guids[i] ) )
             {
                 if ( pl.dynamicCast< DynamicPlaylist >().isNull() )
+                {
                     connect( pl.data(), SIGNAL(revisionLoaded(Tomahawk::PlaylistRevision)), this, SLOT(playlistRevisionLoaded()) );
+
+                    // a peer's playlists aren't loaded until opened, but we show their tracks
+                    if ( !pl->loaded() && !pl->busy() && !pl->author()->isLocal() )
+                        pl->loadRevision();
+                }
                 else
                     connect( pl.data(), SIGNAL(dynamicRevisionLoaded(Tomahawk::DynamicPlaylistRevision)), this, SLOT(playlistRevisionLoaded()) );
                 m_cached[playlist_guids[i]] = pl;
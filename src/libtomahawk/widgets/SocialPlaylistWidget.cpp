@@ -26,13 +26,13 @@
 #include "dynamic/database/DatabaseGenerator.h"
 #include "utils/logger.h"
 #include "database/databasecommand_genericselect.h"
+#include "database/databasecommand_playbackcharts.h"
 #include "widgets/overlaywidget.h"
 
 using namespace Tomahawk;
 
 QString SocialPlaylistWidget::s_popularAlbumsQuery = "SELECT * from album";
 QString SocialPlaylistWidget::s_mostPlayedPlaylistsQuery = "asd";
-QString SocialPlaylistWidget::s_topForeignTracksQuery = "select track.name, artist.name, count(*) as counter from (select track from playback_log group by track, source), track, artist where track not in (select track from playback_log where source is null group by track) and track.id = track and artist.id = track.artist group by track order by counter desc";
 
 SocialPlaylistWidget::SocialPlaylistWidget ( QWidget* parent )
     : QWidget ( parent )
@@ -109,8 +109,10 @@ SocialPlaylistWidget::fetchFromDB()
 //     connect( albumsCmd.data(), SIGNAL( albums( QList<Tomahawk::album_ptr> ) ), this, SLOT( popularAlbumsFetched( QList<Tomahawk::album_ptr> ) ) );
 //     Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( albumsCmd ) );
 
-    QSharedPointer<DatabaseCommand_GenericSelect> trackCmd = QSharedPointer<DatabaseCommand_GenericSelect>( new DatabaseCommand_GenericSelect( s_topForeignTracksQuery, DatabaseCommand_GenericSelect::Track, 50, 0 ) );
-    connect( trackCmd.data(), SIGNAL( tracks( QList<Tomahawk::query_ptr> ) ), this, SLOT( topForeignTracksFetched( QList<Tomahawk::query_ptr> ) ) );
+    DatabaseCommand_PlaybackCharts* trackCmd = new DatabaseCommand_PlaybackCharts( source_ptr() );
+    trackCmd->setForeignOnly( true );
+    trackCmd->setLimit( 50 );
+    connect( trackCmd, SIGNAL( tracks( QList<Tomahawk::query_ptr> ) ), this, SLOT( topForeignTracksFetched( QList<Tomahawk::query_ptr> ) ) );
     Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( trackCmd ) );
 }
 
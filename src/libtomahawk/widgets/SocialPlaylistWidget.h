@@ -89,7 +89,6 @@ private:
 
     static QString s_popularAlbumsQuery;
     static QString s_mostPlayedPlaylistsQuery;
-    static QString s_topForeignTracksQuery;
 };
 
 }
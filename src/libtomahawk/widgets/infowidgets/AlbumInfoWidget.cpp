@@ -93,6 +93,7 @@ AlbumInfoWidget::AlbumInfoWidget( const Tomahawk::album_ptr& album, ModelMode st
 
 AlbumInfoWidget::~AlbumInfoWidget()
 {
+    Tomahawk::InfoSystem::InfoSystem::instance()->cancelRequests( m_infoId );
     delete ui;
 }
 
@@ -101,6 +101,7 @@ ArtistInfoWidget::ArtistInfoWidget( const Tomahawk::artist_ptr& artist, QWidget*
 
 ArtistInfoWidget::~ArtistInfoWidget()
 {
+    Tomahawk::InfoSystem::InfoSystem::instance()->cancelRequests( m_infoId );
     delete ui;
 }
 
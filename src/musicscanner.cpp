@@ -19,6 +19,9 @@
 #include "musicscanner.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 
 #include "utils/tomahawkutils.h"
 #include "tomahawksettings.h"
@@ -35,6 +38,47 @@
 
 using namespace Tomahawk;
 
+// bytes read at a time while hashing a file
+#define HASH_CHUNKSIZE 65536
+
+
+/**
+ * Hashes one scanned file in place. Streams are served block-wise from byte
+ * offsets, so only byte-identical files may share a hash: the whole file is
+ * hashed, tags included.
+ */
+class FileHashJob : public QRunnable
+{
+public:
+    explicit FileHashJob( QVariant* file )
+        : m_file( file )
+    {}
+
+    void run()
+    {
+        QVariantMap m = m_file->toMap();
+        QFile f( m.value( "url" ).toString().mid( QString( "file://" ).length() ) );
+        if ( !f.open( QIODevice::ReadOnly ) )
+            return;
+
+        QCryptographicHash hash( QCryptographicHash::Md5 );
+        while ( !f.atEnd() )
+        {
+            const QByteArray chunk = f.read( HASH_CHUNKSIZE );
+            if ( chunk.isEmpty() )
+                return; // read error, leave the hash empty rather than storing a wrong one
+
+            hash.addData( chunk );
+        }
+
+        m["hash"] = QString( hash.result().toHex() );
+        *m_file = m;
+    }
+
+private:
+    QVariant* m_file;
+};
+
 
 void
 DirLister::go()
@@ -203,6 +247,7 @@ MusicScanner::listerFinished()
 
     if ( m_filesToDelete.length() || m_scannedfiles.length() )
     {
+        hashFiles( m_scannedfiles );
         commitBatch( m_scannedfiles, m_filesToDelete );
         m_scannedfiles.clear();
         m_filesToDelete.clear();
@@ -252,6 +297,22 @@ MusicScanner::commitBatch( const QVariantList& tracks, const QVariantList& delet
 }
 
 
+void
+MusicScanner::hashFiles( QVariantList& files )
+{
+    // unchanged files were skipped by their mtime already, so this only touches new or modified ones
+    QTime t;
+    t.start();
+
+    QVariantList::iterator it;
+    for ( it = files.begin(); it != files.end(); ++it )
+        m_hashPool.start( new FileHashJob( &(*it) ) );
+    m_hashPool.waitForDone();
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Hashed" << files.count() << "files in" << t.elapsed() << "ms";
+}
+
+
 void
 MusicScanner::executeCommand( QSharedPointer< DatabaseCommand > cmd )
 {
@@ -295,6 +356,7 @@ MusicScanner::scanFile( const QFileInfo& fi )
     m_scannedfiles << m;
     if ( m_batchsize != 0 && (quint32)m_scannedfiles.length() >= m_batchsize )
     {
+        hashFiles( m_scannedfiles );
         emit batchReady( m_scannedfiles, m_filesToDelete );
         m_scannedfiles.clear();
         m_filesToDelete.clear();
@@ -374,7 +436,7 @@ MusicScanner::readFile( const QFileInfo& fi )
     m["albumartist"]  = tag->albumArtist();
     m["composer"]     = tag->composer();
     m["discnumber"]   = tag->discNumber();
-    m["hash"]         = ""; // TODO
+    m["hash"]         = ""; // filled in by hashFiles(), in parallel for the whole batch
 
     m_scanned++;
     return m;
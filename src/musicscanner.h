@@ -34,6 +34,7 @@
 #include <QtCore/QTimer>
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QThreadPool>
 #include <QtCore/QWeakPointer>
 #include <database/database.h>
 
@@ -92,6 +93,7 @@ signals:
 
 private:
     QVariant readFile( const QFileInfo& fi );
+    void hashFiles( QVariantList& files );
     void executeCommand( QSharedPointer< DatabaseCommand > cmd );
 
 private slots:
@@ -121,6 +123,9 @@ private:
 
     QWeakPointer< DirLister > m_dirLister;
     QThread* m_dirListerThreadController;
+
+    // own pool, so hashing doesn't starve the global one the network code uses
+    QThreadPool m_hashPool;
 };
 
 #endif
@@ -138,6 +138,7 @@ SettingsDialog::SettingsDialog( QWidget *parent )
     // ADVANCED
     ui->staticHostName->setText( s->externalHostname() );
     ui->staticPort->setValue( s->externalPort() );
+    ui->uploadLimitSpinBox->setValue( s->uploadLimit() / 1024 );
     ui->proxyButton->setVisible( true );
 
     ui->checkBoxWatchForChanges->setChecked( s->watchForChanges() );
@@ -196,6 +197,7 @@ SettingsDialog::~SettingsDialog()
 
         s->setExternalHostname( ui->staticHostName->text() );
         s->setExternalPort( ui->staticPort->value() );
+        s->setUploadLimit( (qint64)ui->uploadLimitSpinBox->value() * 1024 );
 
         s->setScannerPaths( ui->dirTree->getCheckedPaths() );
         s->setWatchForChanges( ui->checkBoxWatchForChanges->isChecked() );
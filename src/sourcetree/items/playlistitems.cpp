@@ -112,8 +112,9 @@ PlaylistItem::flags() const
     Qt::ItemFlags flags = SourceTreeItem::flags();
     flags |= Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
 
+    // not loaded yet, opening it loads it
     if ( !m_loaded )
-        flags &= !Qt::ItemIsEnabled;
+        flags &= ~Qt::ItemIsDropEnabled;
     if ( playlist()->author()->isLocal() )
         flags |= Qt::ItemIsEditable;
 
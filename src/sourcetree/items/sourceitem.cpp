@@ -356,7 +356,10 @@ SourceItem::onPlaylistsAdded( const QList< playlist_ptr >& playlists )
     foreach ( const playlist_ptr& p, playlists )
     {
         PlaylistItem* plItem = new PlaylistItem( model(), m_playlists, p, m_playlists->children().count() - addOffset );
-        p->loadRevision();
+
+        // we edit, drop onto and sync our own playlists right away, a peer's are only loaded when opened
+        if ( m_source->isLocal() )
+            p->loadRevision();
         items << plItem;
 
         if ( m_source->isLocal() )
@@ -359,16 +359,54 @@ SourceTreeView::addToLocal()
         PlaylistItem* item = itemFromIndex< PlaylistItem >( m_contextMenuIndex );
         playlist_ptr playlist = item->playlist();
 
-        // just create the new playlist with the same values
-        QList< query_ptr > queries;
-        foreach( const plentry_ptr& e, playlist->entries() )
-            queries << e->query();
+        // a peer's playlist that was never opened has no entries yet
+        if ( !playlist->ensureLoaded() )
+        {
+            if ( !m_playlistsToCopy.contains( playlist ) )
+                m_playlistsToCopy << playlist;
+
+            connect( playlist.data(), SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), SLOT( onCopiedPlaylistLoaded() ), Qt::UniqueConnection );
+            return;
+        }
 
-        playlist_ptr newpl = Playlist::create( SourceList::instance()->getLocal(), uuid(), playlist->title(), playlist->info(), playlist->creator(), playlist->shared(), queries );
+        copyPlaylist( playlist );
     }
 }
 
 
+void
+SourceTreeView::onCopiedPlaylistLoaded()
+{
+    Playlist* loaded = qobject_cast< Playlist* >( sender() );
+    if ( !loaded )
+        return;
+
+    disconnect( loaded, SIGNAL( revisionLoaded( Tomahawk::PlaylistRevision ) ), this, SLOT( onCopiedPlaylistLoaded() ) );
+
+    foreach ( const playlist_ptr& playlist, m_playlistsToCopy )
+    {
+        if ( playlist.data() == loaded )
+        {
+            m_playlistsToCopy.removeAll( playlist );
+            copyPlaylist( playlist );
+            break;
+        }
+    }
+}
+
+
+void
+SourceTreeView::copyPlaylist( const playlist_ptr& playlist )
+{
+    // just create the new playlist with the same values
+    QList< query_ptr > queries;
+    foreach( const plentry_ptr& e, playlist->entries() )
+        queries << e->query();
+
+    playlist_ptr newpl = Playlist::create( SourceList::instance()->getLocal(), uuid(), playlist->title(), playlist->info(), playlist->creator(), playlist->shared(), queries );
+}
+
+
 void
 SourceTreeView::latchOnOrCatchUp()
 {
@@ -71,6 +71,7 @@ private slots:
     void deletePlaylist( const QModelIndex& = QModelIndex() );
     void copyPlaylistLink();
     void addToLocal();
+    void onCopiedPlaylistLoaded();
 
     void latchOnOrCatchUp();
     void latchOff();
@@ -93,6 +94,7 @@ protected:
 
 private:
     void setupMenus();
+    void copyPlaylist( const Tomahawk::playlist_ptr& playlist );
 
     template< typename T >
     T* itemFromIndex( const QModelIndex& index ) const;
@@ -102,6 +104,8 @@ private:
     QModelIndex m_contextMenuIndex;
     SourceDelegate* m_delegate;
     Tomahawk::LatchManager* m_latchManager;
+    // peers' playlists to copy once their entries are loaded
+    QList< Tomahawk::playlist_ptr > m_playlistsToCopy;
 
     QMenu m_playlistMenu;
     QMenu m_roPlaylistMenu;
@@ -37,6 +37,7 @@
 #include "database/database.h"
 #include "database/databasecollection.h"
 #include "database/databasecommand_collectionstats.h"
+#include "database/databasecommand_compactoplog.h"
 #include "database/databaseresolver.h"
 #include "playlist/dynamic/GeneratorFactory.h"
 #include "playlist/dynamic/echonest/EchonestGenerator.h"
@@ -145,6 +146,7 @@ TomahawkApp::init()
     qsrand( QTime( 0, 0, 0 ).secsTo( QTime::currentTime() ) );
 
     tLog() << "Starting Tomahawk...";
+    m_startupTime.start();
 
 #ifdef ENABLE_HEADLESS
     m_headless = true;
@@ -180,11 +182,12 @@ TomahawkApp::init()
     connect( ActionCollection::instance()->getAction( "quit" ), SIGNAL( triggered() ), SLOT( quit() ), Qt::UniqueConnection );
 #endif
 
-    m_servent = QWeakPointer<Servent>( new Servent( this ) );
+    m_servent = QWeakPointer<Servent>( new Servent() );
     connect( m_servent.data(), SIGNAL( ready() ), SLOT( initSIP() ) );
 
     tDebug() << "Init Database.";
     initDatabase();
+    traceStartup( "database" );
 
     QByteArray magic = QByteArray::fromBase64( enApiSecret );
     QByteArray wand = QByteArray::fromBase64( QCoreApplication::applicationName().toLatin1() );
@@ -235,6 +238,7 @@ TomahawkApp::init()
     m_accountManager.data()->registerAccountFactoryForFilesystem( spotifyFactory );
 
     Tomahawk::Accounts::AccountManager::instance()->loadFromConfig();
+    traceStartup( "accounts" );
 
     Echonest::Config::instance()->setNetworkAccessManager( TomahawkUtils::nam() );
 #ifndef ENABLE_HEADLESS
@@ -250,11 +254,14 @@ TomahawkApp::init()
         {
             m_mainwindow->show();
         }
+        traceStartup( "main window" );
     }
 #endif
 
+    // the servent doesn't need our sources, so it starts listening while they are loaded
     tDebug() << "Init Local Collection.";
     initLocalCollection();
+    initServent();
     tDebug() << "Init Pipeline.";
     initPipeline();
 
@@ -301,6 +308,8 @@ TomahawkApp::init()
     // Make sure to do this after main window is inited
     Tomahawk::enableFullscreen();
 #endif
+
+    traceStartup( "init" );
 }
 
 
@@ -311,7 +320,10 @@ TomahawkApp::~TomahawkApp()
     Pipeline::instance()->stop();
 
     if ( !m_servent.isNull() )
+    {
+        m_servent.data()->stop();
         delete m_servent.data();
+    }
     if ( !m_scanManager.isNull() )
         delete m_scanManager.data();
 
@@ -383,6 +395,7 @@ void
 TomahawkApp::registerMetaTypes()
 {
     qRegisterMetaType< QSharedPointer<DatabaseCommand> >("QSharedPointer<DatabaseCommand>");
+    qRegisterMetaType< QList< QSharedPointer<DatabaseCommand> > >("QList<QSharedPointer<DatabaseCommand> >");
     qRegisterMetaType< DBSyncConnection::State >("DBSyncConnection::State");
     qRegisterMetaType< msg_ptr >("msg_ptr");
     qRegisterMetaType< QList<dbop_ptr> >("QList<dbop_ptr>");
@@ -390,6 +403,7 @@ TomahawkApp::registerMetaTypes()
     qRegisterMetaType< QList<QString> >("QList<QString>");
     qRegisterMetaType< QList<uint> >("QList<uint>");
     qRegisterMetaType< Connection* >("Connection*");
+    qRegisterMetaType< StreamConnection* >("StreamConnection*");
     qRegisterMetaType< QAbstractSocket::SocketError >("QAbstractSocket::SocketError");
     qRegisterMetaType< QTcpSocket* >("QTcpSocket*");
     qRegisterMetaType< QSharedPointer<QIODevice> >("QSharedPointer<QIODevice>");
@@ -447,6 +461,13 @@ TomahawkApp::registerMetaTypes()
 }
 
 
+void
+TomahawkApp::traceStartup( const char* step )
+{
+    tLog() << "Startup:" << step << "done after" << m_startupTime.elapsed() << "ms";
+}
+
+
 void
 TomahawkApp::initDatabase()
 {
@@ -492,7 +513,7 @@ TomahawkApp::initPipeline()
 void
 TomahawkApp::initLocalCollection()
 {
-    connect( SourceList::instance(), SIGNAL( ready() ), SLOT( initServent() ) );
+    connect( SourceList::instance(), SIGNAL( ready() ), SLOT( initSIP() ) );
 
     source_ptr src( new Source( 0, tr( "My Collection" ) ) );
     collection_ptr coll( new LocalCollection( src ) );
@@ -507,6 +528,14 @@ TomahawkApp::initLocalCollection()
     connect( cmd,       SIGNAL( done( const QVariantMap& ) ),
              src.data(),  SLOT( setStats( const QVariantMap& ) ), Qt::QueuedConnection );
     Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+
+    // fold the part of our oplog all peers have already seen, once a week is plenty
+    const QDateTime lastCompaction = TomahawkSettings::instance()->lastOplogCompaction();
+    if ( !lastCompaction.isValid() || lastCompaction.daysTo( QDateTime::currentDateTime() ) >= 7 )
+    {
+        Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( new DatabaseCommand_CompactOplog() ) );
+        TomahawkSettings::instance()->setLastOplogCompaction( QDateTime::currentDateTime() );
+    }
 }
 
 
@@ -522,13 +551,19 @@ TomahawkApp::initServent()
         tLog() << "Failed to start listening with servent";
         exit( 1 );
     }
+
+    traceStartup( "servent" );
 }
 
 
-// Called after Servent emits ready()
+// Called when Servent emits ready() and when SourceList is ready, goes ahead once both are
 void
 TomahawkApp::initSIP()
 {
+    if ( m_loaded || !Servent::instance()->isReady() || !SourceList::instance()->isReady() )
+        return;
+
+    traceStartup( "servent and sources" );
     tDebug() << Q_FUNC_INFO;
     //FIXME: jabber autoconnect is really more, now that there is sip -- should be renamed and/or split out of jabber-specific settings
     if ( !arguments().contains( "--nosip" ) )
@@ -542,6 +577,7 @@ TomahawkApp::initSIP()
     }
 
     m_loaded = true;
+    traceStartup( "sip" );
     emit tomahawkLoaded();
 }
 
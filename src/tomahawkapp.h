@@ -29,6 +29,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QSettings>
 #include <QtCore/QDir>
+#include <QtCore/QTime>
 #include <QtCore/QPersistentModelIndex>
 
 #include "QxtHttpServerConnector"
@@ -114,8 +115,11 @@ private:
     void registerMetaTypes();
 
     void printHelp();
+    // logs how long into the start-up step was reached
+    void traceStartup( const char* step );
 
-    // Start-up order: database, collection, pipeline, servent, http
+    // Start-up order: database, collection and servent side by side, pipeline, http.
+    // SIP follows once both the servent and the sources are ready.
     void initDatabase();
     void initLocalCollection();
     void initPipeline();
@@ -141,6 +145,7 @@ private:
 #endif
 
     bool m_headless, m_loaded;
+    QTime m_startupTime;
 
     QxtHttpServerConnector m_connector;
     QxtHttpSessionManager m_session;
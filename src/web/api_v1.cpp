@@ -26,8 +26,10 @@
 #include "database/database.h"
 #include "database/databasecommand_addclientauth.h"
 #include "database/databasecommand_clientauthvalid.h"
+#include "database/tomahawksqlquery.h"
 #include "network/servent.h"
 #include "pipeline.h"
+#include "utils/metrics.h"
 
 using namespace Tomahawk;
 
@@ -192,6 +194,32 @@ Api_v1::sid( QxtWebRequestEvent* event, QString unused )
 }
 
 
+void
+Api_v1::stats( QxtWebRequestEvent* event, QString unused )
+{
+    Q_UNUSED( unused );
+
+    QVariantMap m = Metrics::instance()->snapshot();
+
+    QVariantMap sql;
+    const QHash< QString, TomahawkSqlQuery::Statistics > statements = TomahawkSqlQuery::statistics();
+    foreach ( const QString& statement, statements.keys() )
+    {
+        const TomahawkSqlQuery::Statistics& s = statements[ statement ];
+
+        QVariantMap stat;
+        stat[ "count" ] = s.count;
+        stat[ "slow" ] = s.slow;
+        stat[ "sum" ] = s.totalTime;
+        stat[ "max" ] = s.maxTime;
+        sql[ statement ] = stat;
+    }
+    m[ "sql" ] = sql;
+
+    sendJSON( m, event );
+}
+
+
 void
 Api_v1::send404( QxtWebRequestEvent* event )
 {
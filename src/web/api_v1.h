@@ -57,6 +57,9 @@ public slots:
 
     // request for stream: /sid/<id>
     void sid( QxtWebRequestEvent* event, QString unused = QString() );
+
+    // runtime metrics as JSON: /stats
+    void stats( QxtWebRequestEvent* event, QString unused = QString() );
     void send404( QxtWebRequestEvent* event );
     void stat( QxtWebRequestEvent* event );
     void statResult( const QString& clientToken, const QString& name, bool valid );